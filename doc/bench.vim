@@ -0,0 +1,62 @@
+" Example workload for vimpc --bench, only available when built with --enable-test
+"
+" Besides vimpc commands a script may contain
+"   songs <count>            size of the stand-in mpd's library
+"   size <rows> <columns>    size of the headless screen
+"   repeat <count> <command> run a command several times
+"
+" Each command is timed from its first key until the client has finished
+" what it queued and the screen has been repainted
+
+songs 1000000
+size 50 200
+
+" Scroll through the browse window
+browse
+repeat 200 normal <C-F>
+repeat 20 normal G
+repeat 20 normal gg
+
+" Expand and collapse artists in the library
+library
+normal gg
+repeat 500 normal zozcj
+
+" Select 50000 songs and add them to the playlist
+browse
+normal gg
+normal V49999ja
+playlist
+deleteall
+
+" Add whole artists and directories, after the current song and at the end
+play
+set add next
+library
+normal gg
+repeat 20 normal ja
+set add end
+directory
+normal gg
+repeat 20 normal ja
+
+" Remove the artists from the playlist again through the library
+library
+normal gg
+normal V19jd
+playlist
+deleteall
+
+" Sort a large playlist back and forth
+browse
+normal gg
+normal V19999ja
+repeat 5 sort title
+repeat 5 sort artist album disc track
+playlist
+deleteall
+
+" Searches
+find Artist 001000
+filter Track 07
+repeat 10 findartist Artist 00999
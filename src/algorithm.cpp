@@ -113,4 +113,164 @@ bool Algorithm::isNumeric(std::string const & s1)
 	return true;
 }
 
+Algorithm::Ranges Algorithm::MergeRanges(std::vector<uint32_t> positions)
+{
+   Ranges result;
+
+   std::sort(positions.begin(), positions.end());
+
+   for (auto position : positions)
+   {
+      if ((result.empty() == false) && (position <= result.back().second))
+      {
+         result.back().second = std::max(result.back().second, position + 1);
+      }
+      else
+      {
+         result.push_back(std::make_pair(position, position + 1));
+      }
+   }
+
+   return result;
+}
+
+Algorithm::Moves Algorithm::OrderMoves(std::vector<uint32_t> const & order)
+{
+   uint32_t const size = order.size();
+
+   // The rank of the entry at each current position
+   std::vector<uint32_t> rank(size);
+
+   for (uint32_t i = 0; i < size; ++i)
+   {
+      rank[order[i]] = i;
+   }
+
+   // Longest increasing subsequence of the ranks, tails[l] is the position
+   // ending the best subsequence of length l + 1 found so far
+   std::vector<uint32_t> tails;
+   std::vector<int32_t>  previous(size, -1);
+
+   for (uint32_t i = 0; i < size; ++i)
+   {
+      auto const tail = std::lower_bound(tails.begin(), tails.end(), rank[i],
+                                         [&rank] (uint32_t position, uint32_t value) { return rank[position] < value; });
+
+      if (tail != tails.begin())
+      {
+         previous[i] = *(tail - 1);
+      }
+
+      if (tail == tails.end())
+      {
+         tails.push_back(i);
+      }
+      else
+      {
+         *tail = i;
+      }
+   }
+
+   std::vector<bool> stays(size, false);
+
+   for (int32_t i = (tails.empty() == false) ? tails.back() : -1; (i != -1); i = previous[i])
+   {
+      stays[rank[i]] = true;
+   }
+
+   // Each entry that moves is put directly after the entry ranked before it,
+   // so every entry has a slot where it is now and, if it moves, a slot after
+   // the last entry that stays ranked before it. The position of a slot is
+   // the number of filled slots before it.
+   std::vector<uint32_t> current(size);
+   std::vector<uint32_t> moved(size);
+   uint32_t              slots = 0;
+
+   for (uint32_t r = 0; (r < size) && (stays[r] == false); ++r)
+   {
+      moved[r] = slots++;
+   }
+
+   for (uint32_t i = 0; i < size; ++i)
+   {
+      current[i] = slots++;
+
+      if (stays[rank[i]] == true)
+      {
+         for (uint32_t r = rank[i] + 1; (r < size) && (stays[r] == false); ++r)
+         {
+            moved[r] = slots++;
+         }
+      }
+   }
+
+   std::vector<int32_t> filled(slots + 1, 0);
+
+   auto const Fill = [&filled] (uint32_t slot, int32_t value)
+   {
+      for (++slot; slot < filled.size(); slot += (slot & -slot))
+      {
+         filled[slot] += value;
+      }
+   };
+
+   auto const Before = [&filled] (uint32_t slot)
+   {
+      int32_t count = 0;
+
+      for (; slot > 0; slot -= (slot & -slot))
+      {
+         count += filled[slot];
+      }
+
+      return static_cast<uint32_t>(count);
+   };
+
+   for (uint32_t i = 0; i < size; ++i)
+   {
+      Fill(current[i], 1);
+   }
+
+   Moves result;
+
+   for (uint32_t r = 0; r < size; )
+   {
+      if (stays[r] == true)
+      {
+         ++r;
+         continue;
+      }
+
+      // Entries that are next to each other now and afterwards move together
+      uint32_t count = 1;
+
+      for (; (r + count < size) && (stays[r + count] == false) && (order[r + count] == order[r] + count); ++count) { }
+
+      Move move;
+      move.start = Before(current[order[r]]);
+      move.end   = move.start + count;
+
+      for (uint32_t i = 0; i < count; ++i)
+      {
+         Fill(current[order[r + i]], -1);
+      }
+
+      move.to = Before(moved[r]);
+
+      for (uint32_t i = 0; i < count; ++i)
+      {
+         Fill(moved[r + i], 1);
+      }
+
+      if (move.to != move.start)
+      {
+         result.push_back(move);
+      }
+
+      r += count;
+   }
+
+   return result;
+}
+
 /* vim: set sw=3 ts=3: */
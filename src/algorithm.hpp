@@ -23,7 +23,10 @@
 
 #include <algorithm>
 
+#include <stdint.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "regex.hpp"
 
@@ -39,6 +42,27 @@ namespace Algorithm
    bool iequals(std::string const & s1, std::string const & s2, bool ignoreLeadingThe, bool caseInsensitive);
 
    bool isNumeric(std::string const & s1);
+
+   //! Each range is from its first position up to but not including its second
+   typedef std::vector<std::pair<uint32_t, uint32_t> > Ranges;
+
+   //! Sorts the positions and merges them into the fewest ranges, in ascending order
+   Ranges MergeRanges(std::vector<uint32_t> positions);
+
+   //! Moves the range [start, end) so that its first entry ends up at to
+   struct Move
+   {
+      uint32_t start;
+      uint32_t end;
+      uint32_t to;
+   };
+
+   typedef std::vector<Move> Moves;
+
+   //! The moves, applied in turn, that put a list into a new order where
+   //! order[i] is the current position of the entry that should be at i,
+   //! the longest run of entries already in order is never moved
+   Moves OrderMoves(std::vector<uint32_t> const & order);
 }
 
 
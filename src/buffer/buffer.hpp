@@ -46,17 +46,44 @@ namespace Main
    {
       Buffer_Add,
       Buffer_Remove,
-      Buffer_Replace
+      Buffer_Replace,
+      Buffer_Reorder,
+      Buffer_Reset,
+      Buffer_Destroy
    } BufferCallbackEvent;
 
+   //! Passed to position callbacks, count entries from position have been
+   //! added, removed or replaced. When several ranges of [first, second) are
+   //! removed at once they are given in ranges, and a reordering gives order,
+   //! where order[i] was the position of the entry now at i
+   class BufferChange
+   {
+   public:
+      BufferChange(BufferCallbackEvent event, uint32_t position, uint32_t count = 1) :
+         event_(event), position_(position), count_(count), ranges_(NULL), order_(NULL) { }
+
+      BufferCallbackEvent const                           event_;
+      uint32_t const                                      position_;
+      uint32_t const                                      count_;
+      std::vector<std::pair<uint32_t, uint32_t> > const * ranges_;
+      std::vector<uint32_t> const *                       order_;
+   };
+
 
    class WindowBuffer
    {
    public:
+      WindowBuffer() : generation_(0) { }
       virtual ~WindowBuffer() { }
       virtual size_t Size() const = 0;
       virtual std::string String(uint32_t position) const { return ""; }
       virtual std::string PrintString(uint32_t position) const { return ""; }
+
+      //! Changes every time the contents or order of the buffer changes
+      uint32_t Generation() const { return generation_; }
+
+   protected:
+      uint32_t generation_;
    };
 
    //! Window buffer
@@ -68,12 +95,21 @@ namespace Main
       typedef std::vector<CallbackFunction>   CallbackList;
       typedef std::map<BufferCallbackEvent, CallbackList> CallbackMap;
 
+   public:
+      //! Called after entries are added, removed, replaced or reordered,
+      //! with Buffer_Reset after the whole buffer is assigned or cleared and
+      //! with Buffer_Destroy when the buffer is about to be destroyed
+      typedef FUNCTION<void (BufferChange const &)> PositionCallbackFunction;
+
+   private:
+      typedef std::map<uint32_t, PositionCallbackFunction> PositionCallbackMap;
+
    public:
       typedef T BufferType;
 
    public:
-      BufferImpl<T>() { }
-      virtual ~BufferImpl<T>() { }
+      BufferImpl<T>() : positionCallbackId_(0) { }
+      virtual ~BufferImpl<T>() { PositionCallback(BufferChange(Buffer_Destroy, 0)); }
 
    private:
       BufferImpl<T>(BufferImpl<T> const & buffer);
@@ -89,7 +125,9 @@ namespace Main
       void Add(T entry)
       {
          BufferImpl<T>::push_back(entry);
+         ++generation_;
          Callback(Buffer_Add, entry);
+         PositionCallback(BufferChange(Buffer_Add, Size() - 1));
       }
 
       void Replace(uint32_t index, T entry)
@@ -98,7 +136,9 @@ namespace Main
          {
             Callback(Buffer_Replace, BufferImpl<T>::at(index));
             BufferImpl<T>::at(index) = entry;
+            ++generation_;
             Callback(Buffer_Add, entry);
+            PositionCallback(BufferChange(Buffer_Replace, index));
          }
          else
          {
@@ -137,8 +177,27 @@ namespace Main
             for (it = BufferImpl<T>::begin(); ((pos != position) && (it != BufferImpl<T>::end())); ++it, ++pos) { }
 
             BufferImpl<T>::insert(it, entry);
+            ++generation_;
 
             Callback(Buffer_Add, entry);
+            PositionCallback(BufferChange(Buffer_Add, position));
+         }
+      }
+
+      //! Inserts all of the entries with one change rather than one for each
+      void Add(std::vector<T> const & entries, uint32_t position)
+      {
+         if ((position <= Size()) && (entries.empty() == false))
+         {
+            BufferImpl<T>::insert(BufferImpl<T>::begin() + position, entries.begin(), entries.end());
+            ++generation_;
+
+            for (auto entry : entries)
+            {
+               Callback(Buffer_Add, entry);
+            }
+
+            PositionCallback(BufferChange(Buffer_Add, position, entries.size()));
          }
       }
 
@@ -148,7 +207,9 @@ namespace Main
          {
             T entry = BufferImpl<T>::back();
             BufferImpl<T>::pop_back();
+            ++generation_;
             Callback(Buffer_Remove, entry);
+            PositionCallback(BufferChange(Buffer_Remove, Size()));
          }
       }
 
@@ -176,14 +237,120 @@ namespace Main
          {
             T entry = *it;
             it = BufferImpl<T>::erase(it);
+            ++generation_;
             Callback(Buffer_Remove, entry);
+            PositionCallback(BufferChange(Buffer_Remove, position));
+         }
+      }
+
+      //! Removes ascending ranges of [first, second) in one pass over the buffer
+      void Remove(std::vector<std::pair<uint32_t, uint32_t> > const & ranges)
+      {
+         std::vector<T> removed;
+         std::vector<std::pair<uint32_t, uint32_t> > clamped;
+         uint32_t const size = BufferImpl<T>::size();
+         uint32_t       kept = 0;
+         uint32_t       pos  = 0;
+
+         for (auto const & range : ranges)
+         {
+            uint32_t const first = std::max(std::min(range.first, size), pos);
+            uint32_t const last  = std::max(std::min(range.second, size), first);
+
+            std::copy(BufferImpl<T>::begin() + pos, BufferImpl<T>::begin() + first, BufferImpl<T>::begin() + kept);
+            removed.insert(removed.end(), BufferImpl<T>::begin() + first, BufferImpl<T>::begin() + last);
+
+            if (last > first)
+            {
+               clamped.push_back(std::make_pair(first, last));
+            }
+
+            kept += first - pos;
+            pos   = last;
+         }
+
+         if (removed.empty() == false)
+         {
+            std::copy(BufferImpl<T>::begin() + pos, BufferImpl<T>::end(), BufferImpl<T>::begin() + kept);
+            BufferImpl<T>::erase(BufferImpl<T>::begin() + kept + (size - pos), BufferImpl<T>::end());
+            ++generation_;
+
+            for (auto entry : removed)
+            {
+               Callback(Buffer_Remove, entry);
+            }
+
+            BufferChange change(Buffer_Remove, 0, removed.size());
+            change.ranges_ = &clamped;
+            PositionCallback(change);
+         }
+      }
+
+      //! Puts the entries in a new order, where order[i] is the current position of the new i'th entry
+      void Reorder(std::vector<uint32_t> const & order)
+      {
+         if (order.size() == Size())
+         {
+            std::vector<T> entries;
+            entries.reserve(order.size());
+
+            for (auto position : order)
+            {
+               entries.push_back(BufferImpl<T>::at(position));
+            }
+
+            std::copy(entries.begin(), entries.end(), BufferImpl<T>::begin());
+            ++generation_;
+
+            BufferChange change(Buffer_Reorder, 0, order.size());
+            change.order_ = &order;
+            PositionCallback(change);
          }
       }
 
       template <class V>
       void Sort(V comparator)
       {
-         std::sort(BufferImpl<T>::begin(), BufferImpl<T>::end(), comparator);
+         if (positionCallback_.empty() == true)
+         {
+            std::sort(BufferImpl<T>::begin(), BufferImpl<T>::end(), comparator);
+            ++generation_;
+         }
+         else
+         {
+            // Anything following the positions is told where each entry went
+            std::vector<uint32_t> order(Size());
+
+            for (uint32_t i = 0; i < order.size(); ++i)
+            {
+               order[i] = i;
+            }
+
+            std::sort(order.begin(), order.end(), [this, &comparator] (uint32_t a, uint32_t b)
+               { return comparator(BufferImpl<T>::at(a), BufferImpl<T>::at(b)); });
+
+            Reorder(order);
+         }
+      }
+
+      //! Replaces the whole buffer, positions are only reset once rather
+      //! than for every entry removed and added
+      void Assign(std::vector<T> const & entries)
+      {
+         for (auto it = BufferImpl<T>::begin(); (it != BufferImpl<T>::end()); ++it)
+         {
+            Callback(Buffer_Remove, *it);
+         }
+
+         BufferImpl<T>::assign(entries.begin(), entries.end());
+
+         for (auto it = BufferImpl<T>::begin(); (it != BufferImpl<T>::end()); ++it)
+         {
+            Callback(Buffer_Add, *it);
+         }
+
+         ++generation_;
+         PositionCallback(BufferChange(Buffer_Reset, 0));
       }
 
       void Clear()
@@ -196,6 +363,8 @@ namespace Main
          }
 
          BufferImpl<T>::clear();
+         ++generation_;
+         PositionCallback(BufferChange(Buffer_Reset, 0));
 
          ENSURE(Size() == 0);
       }
@@ -211,6 +380,18 @@ namespace Main
          callback_[event].push_back(callback);
       }
 
+      //! Returns an id that must be used to remove the callback
+      uint32_t AddPositionCallback(PositionCallbackFunction callback)
+      {
+         positionCallback_[++positionCallbackId_] = callback;
+         return positionCallbackId_;
+      }
+
+      void RemovePositionCallback(uint32_t id)
+      {
+         positionCallback_.erase(id);
+      }
+
    private:
       void Callback(BufferCallbackEvent event, T & param) const
       {
@@ -225,8 +406,18 @@ namespace Main
          }
       }
 
+      void PositionCallback(BufferChange const & change) const
+      {
+         FOREACH(auto func, positionCallback_)
+         {
+            (func.second)(change);
+         }
+      }
+
    private:
-      CallbackMap callback_;
+      CallbackMap         callback_;
+      PositionCallbackMap positionCallback_;
+      uint32_t            positionCallbackId_;
    };
 
    template <typename T>
@@ -32,13 +32,18 @@
 using namespace Mpc;
 
 Directory::Directory() :
-   directory_("")
+   names_    (),
+   root_     (NULL),
+   directory_(""),
+   databaseGeneration_(0)
 {
+   root_ = new DirectoryNode(&*names_.insert("").first, NULL);
 }
 
 Directory::~Directory()
 {
    Clear();
+   delete root_;
 }
 
 std::string Directory::CurrentDirectory()
@@ -48,179 +53,211 @@ std::string Directory::CurrentDirectory()
 
 void Directory::ChangeDirectory(std::string New)
 {
-   Clear();
-
-   bool found = false;
+   DirectoryNode * node = Find(New);
 
-   for (auto path : paths_)
+   if (node == NULL)
    {
-      if (path == New)
-      {
-         found = true;
-      }
+      node = root_;
+      New  = "";
    }
 
-   if (found == false)
-   {
-      New = "";
-   }
+   directory_ = New;
 
-   if (New != "")
-   {
-      if (New.find("/") != std::string::npos)
-      {
-         directory_ = New.substr(0, New.find_last_of("/"));
-      }
-      else
-      {
-         directory_ = "";
-      }
+   Assign(Listing(node, New));
+   DeleteStale();
+}
 
-      AddEntry(directory_);
-   }
+void Directory::ChangeDirectory(DirectoryEntry & New)
+{
+   ChangeDirectory(New.path_);
+}
 
-   directory_ = New;
+void Directory::Clear(bool fullClear)
+{
+   // The entries belong to the listings, so they must be out of the buffer first
+   Main::Buffer<DirectoryEntry *>::Clear();
+   DeleteStale();
 
-   for (auto path : paths_)
+   if (fullClear == true)
    {
-      if (path != New)
-      {
-         AddEntry(path);
-      }
+      delete root_;
+      names_.clear();
+      root_ = new DirectoryNode(&*names_.insert("").first, NULL);
+      ++databaseGeneration_;
    }
+}
 
-   std::vector<Mpc::Song *> const & songs = songs_[directory_];
+void Directory::Add(std::string directory)
+{
+   Invalidate(Insert(directory)->parent_);
+}
 
-   for (auto song : songs)
-   {
-      Mpc::DirectoryEntry * const entry =
-         new Mpc::DirectoryEntry(Mpc::SongType, FileFromURI(song->URI()), directory_, song);
-      Add(entry);
-   }
+void Directory::Add(Mpc::Song * song)
+{
+   DirectoryNode * node = Insert(DirectoryFromURI(song->URI()));
+   node->songs_.push_back(song);
+   song->SetDirectoryHandle(node, databaseGeneration_);
+   Invalidate(node);
 
-   if ((Main::Settings::Instance().Get(Setting::ShowLists) == true))
+   for (; (node != NULL); node = node->parent_)
    {
-      std::vector<std::string> const & playlists = playlists_[directory_];
-
-      for (auto playlist : playlists)
-      {
-         Mpc::DirectoryEntry * const entry =
-            new Mpc::DirectoryEntry(Mpc::PlaylistType, FileFromURI(playlist), directory_);
-         Add(entry);
-      }
+      ++node->songCount_;
    }
+}
 
-   Sort();
+void Directory::AddPlaylist(Mpc::List playlist)
+{
+   DirectoryNode * node = Insert(DirectoryFromURI(playlist.path_));
+   node->playlists_.push_back(playlist.path_);
+   Invalidate(node);
 }
 
-void Directory::ChangeDirectory(DirectoryEntry & New)
+std::vector<std::string> Directory::Paths() const
 {
-   ChangeDirectory(New.path_);
+   std::vector<std::string> Result;
+   Paths(root_, "", Result);
+   return Result;
 }
 
-void Directory::Clear(bool fullClear)
+
+void Directory::AddReferences(DirectoryNode * Node, int32_t Count)
 {
-   if (fullClear == true)
+   for (DirectoryNode * node = Node; (node != NULL) && (Count != 0); node = node->parent_)
    {
-      paths_.clear();
-      songs_.clear();
-      children_.clear();
-      playlists_.clear();
+      // Never below zero, a song may have been in the playlist before its directory was added
+      node->references_ = ((Count < 0) && (node->references_ < static_cast<uint32_t>(-Count))) ? 0 : (node->references_ + Count);
    }
+}
+
+DirectoryNode * Directory::Find(std::string const & Path) const
+{
+   DirectoryNode * node = root_;
 
-   while (Size() > 0)
+   for (size_t start = 0; (node != NULL) && (Path.empty() == false) && (start <= Path.size()); )
    {
-      DirectoryEntry * entry = Get(0);
-      Remove(0, 1);
-      delete entry;
+      size_t const      end   = std::min(Path.find('/', start), Path.size());
+      std::string const name  = Path.substr(start, end - start);
+      auto const        child = node->children_.find(&name);
+
+      node  = (child != node->children_.end()) ? child->second : NULL;
+      start = end + 1;
    }
-}
 
-void Directory::Add(std::string directory)
-{
-   AddEntry(directory);
-   paths_.push_back(directory);
-   AddChild(directory);
+   return node;
 }
 
-void Directory::AddChild(std::string directory)
+DirectoryNode * Directory::Insert(std::string const & Path)
 {
-   std::string Parent = "";
-   std::string Path = directory;
+   DirectoryNode * node = root_;
 
-   size_t i = 0;
-
-   while (i != std::string::npos)
+   for (size_t start = 0; (Path.empty() == false) && (start <= Path.size()); )
    {
-      i = Path.find("/", i);
+      size_t const        end  = std::min(Path.find('/', start), Path.size());
+      std::string const * name = &*names_.insert(Path.substr(start, end - start)).first;
+
+      DirectoryNode * & child = node->children_[name];
 
-      if (i != std::string::npos)
+      if (child == NULL)
       {
-         Parent = Path.substr(0, i);
-         children_[Parent].push_back(directory);
-         ++i;
+         child = new DirectoryNode(name, node);
       }
+
+      node  = child;
+      start = end + 1;
    }
+
+   return node;
 }
 
-void Directory::Add(Mpc::Song * song)
+DirectoryEntryVector const & Directory::Listing(DirectoryNode * Node, std::string const & Path)
 {
-   std::string Path = song->URI();
+   bool const withLists = Main::Settings::Instance().Get(Setting::ShowLists);
 
-   if (Path.find("/") != std::string::npos)
+   if ((Node->listing_ != NULL) && (Node->withLists_ != withLists))
    {
-      Path = Path.substr(0, Path.find_last_of("/"));
+      Invalidate(Node);
    }
-   else
+
+   if (Node->listing_ == NULL)
    {
-      Path = "";
+      DirectoryEntryVector * const listing = new DirectoryEntryVector();
+
+      if (Node != root_)
+      {
+         listing->push_back(new Mpc::DirectoryEntry(Mpc::PathType, "..", ParentPath(Path)));
+      }
+
+      for (auto child : Node->children_)
+      {
+         std::string const & name = *(child.first);
+
+         // Hidden directories are not shown
+         if ((name.empty() == false) && ((name[0] != '.') || ((name.size() >= 2) && (name[1] == '.'))))
+         {
+            listing->push_back(new Mpc::DirectoryEntry(Mpc::PathType, name, (Path == "") ? name : (Path + "/" + name)));
+         }
+      }
+
+      for (auto song : Node->songs_)
+      {
+         listing->push_back(new Mpc::DirectoryEntry(Mpc::SongType, FileFromURI(song->URI()), Path, song));
+      }
+
+      if (withLists == true)
+      {
+         for (auto playlist : Node->playlists_)
+         {
+            listing->push_back(new Mpc::DirectoryEntry(Mpc::PlaylistType, FileFromURI(playlist), Path));
+         }
+      }
+
+      DirectoryComparator sorter;
+      std::sort(listing->begin(), listing->end(), sorter);
+
+      Node->listing_   = listing;
+      Node->withLists_ = withLists;
    }
 
-   songs_[Path].push_back(song);
+   return *(Node->listing_);
 }
 
-void Directory::AddPlaylist(Mpc::List playlist)
+void Directory::Invalidate(DirectoryNode * Node)
 {
-   std::string Path = playlist.path_;
-
-   if (Path.find("/") != std::string::npos)
+   if ((Node != NULL) && (Node->listing_ != NULL))
    {
-      Path = Path.substr(0, Path.find_last_of("/"));
+      stale_.push_back(Node->listing_);
+      Node->listing_ = NULL;
    }
-   else
+}
+
+void Directory::DeleteStale()
+{
+   for (auto listing : stale_)
    {
-      Path = "";
+      DirectoryNode::DeleteListing(listing);
    }
 
-   playlists_[Path].push_back(playlist.path_);
+   stale_.clear();
 }
 
-
-void Directory::AddEntry(std::string fullPath)
+void Directory::AllChildSongs(DirectoryNode const * Node, std::vector<Mpc::Song *> & Result) const
 {
-   std::string directory = fullPath;
-
-   if (fullPath == directory_)
-   {
-      directory = "..";
-   }
-   else if (fullPath.find("/") != std::string::npos)
+   for (auto child : Node->children_)
    {
-      directory = fullPath.substr(fullPath.find_last_of("/") + 1);
+      AllChildSongs(child.second, Result);
    }
 
-   if (((directory.size() >= 1) && (directory[0] != '.')) ||
-         ((directory.size() >= 2) && directory[1] == '.'))
+   Result.insert(Result.end(), Node->songs_.begin(), Node->songs_.end());
+}
+
+void Directory::Paths(DirectoryNode const * Node, std::string const & Path, std::vector<std::string> & Result) const
+{
+   for (auto child : Node->children_)
    {
-      if (((directory_ != "") &&
-               (fullPath.find(directory_ + "/") == 0) &&
-               (fullPath.find(directory_ + "/") + directory_.size() == fullPath.find_last_of("/"))) ||
-            ((directory_ == "") && (fullPath.find('/') == std::string::npos)) ||
-            (directory == ".."))
-      {
-         Mpc::DirectoryEntry * entry = new Mpc::DirectoryEntry(Mpc::PathType, directory, fullPath);
-         Add(entry);
-      }
+      std::string const ChildPath = (Path == "") ? *(child.first) : (Path + "/" + *(child.first));
+
+      Result.push_back(ChildPath);
+      Paths(child.second, ChildPath, Result);
    }
 }
 
@@ -229,19 +266,19 @@ void Directory::AddToPlaylist(Mpc::Song::SongCollection Collection, Mpc::Client
 {
    if (position < Size())
    {
-      if (Collection == Mpc::Song::Single)
-      {
-         AddToPlaylist(client, clientState, Get(position));
-      }
-      else
+      std::vector<uint32_t> Positions(1, position);
+
+      if (Collection != Mpc::Song::Single)
       {
-         Mpc::CommandList list(client);
+         Positions.resize(Size());
 
          for (uint32_t i = 0; i < Size(); ++i)
          {
-            AddToPlaylist(client, clientState, Get(i));
+            Positions[i] = i;
          }
       }
+
+      AddToPlaylist(Positions, client, clientState);
    }
 }
 
@@ -249,86 +286,110 @@ void Directory::RemoveFromPlaylist(Mpc::Song::SongCollection Collection, Mpc::Cl
 {
    if (position < Size())
    {
-      if (Collection == Mpc::Song::Single)
-      {
-         RemoveFromPlaylist(client, clientState, Get(position));
-      }
-      else
+      std::vector<uint32_t> Positions(1, position);
+
+      if (Collection != Mpc::Song::Single)
       {
-         Mpc::CommandList list(client);
+         Positions.resize(Size());
 
          for (uint32_t i = 0; i < Size(); ++i)
          {
-            RemoveFromPlaylist(client, clientState, Get(i));
+            Positions[i] = i;
          }
       }
+
+      RemoveFromPlaylist(Positions, client);
    }
 }
 
-void Directory::AddToPlaylist(Mpc::Client & client, Mpc::ClientState & clientState, Mpc::DirectoryEntry const * const entry, int32_t position)
+void Directory::AddToPlaylist(std::vector<uint32_t> const & Positions, Mpc::Client & client, Mpc::ClientState & clientState)
 {
-   if ((entry->type_ == Mpc::SongType) && (entry->song_ != NULL))
+   std::vector<Mpc::Song *> Songs;
+
+   int32_t position = -1;
+
+   if ((Main::Settings::Instance().Get(Setting::AddPosition) == Setting::AddNext) &&
+       (clientState.GetCurrentSongPos() != -1))
+   {
+      position = clientState.GetCurrentSongPos() + 1;
+   }
+
+   for (auto line : Positions)
    {
-      if (position != -1)
+      DirectoryEntry const * const entry = (line < Size()) ? Get(line) : NULL;
+
+      if (entry == NULL)
       {
-         client.Add(*(entry->song_), position);
+         continue;
       }
-      else if ((Main::Settings::Instance().Get(Setting::AddPosition) == Setting::AddEnd) ||
-               (clientState.GetCurrentSongPos() == -1))
+
+      if ((entry->type_ == Mpc::SongType) && (entry->song_ != NULL))
       {
-         client.Add(*(entry->song_));
+         Songs.push_back(entry->song_);
       }
-      else
+      else if (entry->type_ == Mpc::PathType)
       {
-         client.Add(*(entry->song_), clientState.GetCurrentSongPos() + 1);
+         DirectoryNode const * const Node = Find(entry->path_);
+
+         if (Node != NULL)
+         {
+            AllChildSongs(Node, Songs);
+         }
+      }
+      else if (entry->type_ == Mpc::PlaylistType)
+      {
+         // The songs so far go first so that the order is kept when adding to the end
+         client.Add(Songs, position);
+
+         if (position != -1)
+         {
+            position += Songs.size();
+         }
+
+         Songs.clear();
+
+         std::string const path((entry->path_ == "") ? "" : entry->path_ + "/");
+         client.AppendPlaylist(path + entry->name_);
       }
    }
-   else if (entry->type_ == Mpc::PlaylistType)
-   {
-      std::string const path((entry->path_ == "") ? "" : entry->path_ + "/");
-      client.AppendPlaylist(path + entry->name_);
-   }
-   else if (entry->type_ == Mpc::PathType)
-   {
-      client.Add(entry->path_);
-   }
+
+   client.Add(Songs, position);
 }
 
-void Directory::RemoveFromPlaylist(Mpc::Client & client, Mpc::ClientState & clientState, Mpc::DirectoryEntry const * const entry)
+void Directory::RemoveFromPlaylist(std::vector<uint32_t> const & Positions, Mpc::Client & client)
 {
-   if ((entry->type_ == Mpc::SongType) && (entry->song_ != NULL))
+   std::vector<Mpc::Song *> Songs;
+
+   for (auto line : Positions)
    {
-      int32_t PlaylistIndex = Main::Playlist().Index(entry->song_);
+      DirectoryEntry const * const entry = (line < Size()) ? Get(line) : NULL;
 
-      if (PlaylistIndex >= 0)
+      if (entry == NULL)
       {
-         client.Delete(PlaylistIndex);
+         continue;
       }
-   }
-   else if (entry->type_ == Mpc::PlaylistType)
-   {
-      std::string const path((entry->path_ == "") ? "" : entry->path_ + "/");
-      client.PlaylistContentsForRemove(path + entry->name_);
-   }
-   else if (entry->type_ == Mpc::PathType)
-   {
-      std::vector<Mpc::Song *> const ChildSongs = AllChildSongs(entry->path_);
 
-      if (ChildSongs.size() > 0)
+      if ((entry->type_ == Mpc::SongType) && (entry->song_ != NULL))
+      {
+         Songs.push_back(entry->song_);
+      }
+      else if (entry->type_ == Mpc::PathType)
       {
-         Mpc::CommandList list(client, (ChildSongs.size() > 1));
+         DirectoryNode const * const Node = Find(entry->path_);
 
-         for (uint32_t i = 0; i < ChildSongs.size(); ++i)
+         if (Node != NULL)
          {
-            int32_t PlaylistIndex = Main::Playlist().Index(ChildSongs[i]);
-
-            if (PlaylistIndex >= 0)
-            {
-               client.Delete(PlaylistIndex);
-            }
+            AllChildSongs(Node, Songs);
          }
       }
+      else if (entry->type_ == Mpc::PlaylistType)
+      {
+         std::string const path((entry->path_ == "") ? "" : entry->path_ + "/");
+         client.PlaylistContentsForRemove(path + entry->name_);
+      }
    }
+
+   client.Delete(Main::Playlist().Positions(Songs));
 }
 
 /* static */ bool Directory::IsChildPath(std::string const & Parent, std::string const & Child)
@@ -30,6 +30,8 @@
 #include "buffer/library.hpp"
 #include "buffer/list.hpp"
 
+#include <map>
+#include <set>
 #include <vector>
 
 namespace Ui   { class DirectoryWindow; }
@@ -64,6 +66,77 @@ namespace Mpc
       Mpc::Song *        song_;
    };
 
+   //! A directory in the tree of paths. Each node only holds its own
+   //! component of the path, the names are shared between every directory
+   //! with the same name
+   class DirectoryNode
+   {
+   public:
+      struct NameLess
+      {
+         bool operator() (std::string const * i, std::string const * j) const { return (*i < *j); }
+      };
+
+      typedef std::map<std::string const *, DirectoryNode *, NameLess> ChildMap;
+
+   public:
+      DirectoryNode(std::string const * Name, DirectoryNode * Parent) :
+         name_      (Name),
+         parent_    (Parent),
+         references_(0),
+         songCount_ (0),
+         listing_   (NULL),
+         withLists_ (false)
+      { }
+
+      ~DirectoryNode()
+      {
+         for (auto child : children_)
+         {
+            delete child.second;
+         }
+
+         DeleteListing(listing_);
+      }
+
+      static void DeleteListing(DirectoryEntryVector * Listing)
+      {
+         if (Listing != NULL)
+         {
+            for (auto entry : *Listing)
+            {
+               delete entry;
+            }
+
+            delete Listing;
+         }
+      }
+
+   private:
+      DirectoryNode(DirectoryNode & node);
+      DirectoryNode & operator=(DirectoryNode & node);
+
+   public:
+      std::string Path() const
+      {
+         return ((parent_ == NULL) || (parent_->parent_ == NULL)) ? *name_ : (parent_->Path() + "/" + *name_);
+      }
+
+   public:
+      std::string const *      name_;
+      DirectoryNode *          parent_;
+      ChildMap                 children_;
+      std::vector<Mpc::Song *> songs_;
+      std::vector<std::string> playlists_;
+      uint32_t                 references_; // Includes the subdirectories
+      uint32_t                 songCount_;  // Includes the subdirectories
+
+      // The sorted entries shown for the directory, built when it is first
+      // shown and kept until something is added to the directory
+      DirectoryEntryVector *   listing_;
+      bool                     withLists_;
+   };
+
    class DirectoryComparator
    {
       public:
@@ -121,37 +194,41 @@ namespace Mpc
 
       void Clear(bool fullClear = false);
       void Add(std::string directory);
-      void AddChild(std::string directory);
       void Add(Mpc::Song * song);
       void AddPlaylist(Mpc::List playlist);
       void AddToPlaylist(Mpc::Song::SongCollection Collection, Mpc::Client & client, Mpc::ClientState & clientState, uint32_t position);
       void RemoveFromPlaylist(Mpc::Song::SongCollection Collection, Mpc::Client & client, Mpc::ClientState & clientState, uint32_t position);
 
+      //! Adds the songs of each line, in order, with a single add
+      void AddToPlaylist(std::vector<uint32_t> const & Positions, Mpc::Client & client, Mpc::ClientState & clientState);
+
+      //! Deletes every occurrence of the songs of each line with a single delete
+      void RemoveFromPlaylist(std::vector<uint32_t> const & Positions, Mpc::Client & client);
+
+      //! Songs in the playlist from the directory and its subdirectories
       uint32_t TotalReferences(std::string const & Path) const
       {
-         uint32_t Result = References(Path);
-         std::vector<std::string> const CPaths = ChildPaths(Path);
+         DirectoryNode const * const Node = Find(Path);
+         return (Node != NULL) ? Node->references_ : 0;
+      }
 
-         FOREACH(auto CPath, CPaths)
-         {
-            Result += References(CPath);
-         }
-         return Result;
+      //! Songs in the directory and its subdirectories
+      uint32_t TotalSongs(std::string const & Path) const
+      {
+         DirectoryNode const * const Node = Find(Path);
+         return (Node != NULL) ? Node->songCount_ : 0;
       }
 
       std::vector<Mpc::Song *> AllChildSongs(std::string const & Path) const
       {
          std::vector<Mpc::Song *> Result;
-         std::vector<std::string> const CPaths = ChildPaths(Path);
-         std::vector<Mpc::Song *> const OwnSongs = Songs(Path);
+         DirectoryNode const * const Node = Find(Path);
 
-         FOREACH(auto CPath, CPaths)
+         if (Node != NULL)
          {
-            std::vector<Mpc::Song *> Children = Songs(CPath);
-            Result.insert(Result.end(), Children.begin(), Children.end());
+            AllChildSongs(Node, Result);
          }
 
-         Result.insert(Result.end(), OwnSongs.begin(), OwnSongs.end());
          return Result;
       }
 
@@ -161,47 +238,35 @@ namespace Mpc
          Main::Buffer<DirectoryEntry *>::Sort(sorter);
       }
 
-      std::vector<std::string> const & Paths() { return paths_; }
+      //! Every directory in the database
+      std::vector<std::string> Paths() const;
+
+      //! Changes each time the database is cleared, songs only use their
+      //! directory handle if it was set in the current generation
+      uint32_t DatabaseGeneration() const { return databaseGeneration_; }
+
+      //! Adds songs in the playlist to a directory and its parents
+      void AddReferences(DirectoryNode * Node, int32_t Count);
 
    private:
-      void AddEntry(std::string fullPath);
-      void AddToPlaylist(Mpc::Client & client, Mpc::ClientState & clientState, Mpc::DirectoryEntry const * const entry, int32_t position = -1);
-      void RemoveFromPlaylist(Mpc::Client & client, Mpc::ClientState & clientState, Mpc::DirectoryEntry const * const entry);
       void DeleteEntry(DirectoryEntry * const entry);
 
-      void AddedToPlaylist(std::string URI)
-      {
-         ++references_[DirectoryFromURI(URI)];
-      }
-      void RemovedFromPlaylist(std::string URI)
-      {
-         --references_[DirectoryFromURI(URI)];
-      }
-      uint32_t References(std::string const & Path) const
-      {
-         std::map<std::string, int>::const_iterator it = references_.find(Path);
-         return (it != references_.end()) ? it->second : 0;
-      }
-      std::vector<Mpc::Song *> Songs(std::string const & Path) const
-      {
-         static std::vector<Mpc::Song *> emptyvector;
-         auto const it = songs_.find(Path);
-         return (it != songs_.end()) ? it->second : emptyvector;
-      }
-      std::vector<std::string> ChildPaths(std::string const & Path) const
-      {
-         static std::vector<std::string> emptyvector;
-         auto const it = children_.find(Path);
-         return (it != children_.end()) ? it->second : emptyvector;
-      }
+      DirectoryNode * Find(std::string const & Path) const;
+      DirectoryNode * Insert(std::string const & Path);
+      DirectoryEntryVector const & Listing(DirectoryNode * Node, std::string const & Path);
+      void Invalidate(DirectoryNode * Node);
+      void DeleteStale();
+      void AllChildSongs(DirectoryNode const * Node, std::vector<Mpc::Song *> & Result) const;
+      void Paths(DirectoryNode const * Node, std::string const & Path, std::vector<std::string> & Result) const;
 
    private:
-      std::vector<std::string>                         paths_;
-      std::map<std::string, int >                      references_;
-      std::map<std::string, std::vector<Mpc::Song *> > songs_;
-      std::map<std::string, std::vector<std::string> > playlists_;
-      std::map<std::string, std::vector<std::string> > children_;
-      std::string directory_;
+      std::set<std::string> names_;
+      DirectoryNode *       root_;
+      std::string           directory_;
+      uint32_t              databaseGeneration_;
+
+      // Listings that were invalidated while they may still be in the buffer
+      std::vector<DirectoryEntryVector *> stale_;
    };
 }
 
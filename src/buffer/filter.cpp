@@ -0,0 +1,526 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   filter.cpp - a live view of the songs in another buffer that match a pattern
+   */
+
+// Includes
+#include "buffer/filter.hpp"
+
+#include <algorithm>
+#include <ctype.h>
+#include <string.h>
+
+// Filter
+using namespace Mpc;
+
+Filter::Filter(SourceBuffer & source) :
+   settings_   (Main::Settings::Instance()),
+   source_     (&source),
+   callbackId_ (0),
+   pattern_    (""),
+   expression_ (NULL),
+   literal_    (""),
+   literalOnly_(false),
+   format_     (""),
+   rows_       (),
+   arena_      (),
+   text_       (),
+   garbage_    (0)
+{
+   callbackId_ = source_->AddPositionCallback([this] (Main::BufferChange const & change) { OnSourceChanged(change); });
+   Rebuild();
+}
+
+Filter::~Filter()
+{
+   if (source_ != NULL)
+   {
+      source_->RemovePositionCallback(callbackId_);
+   }
+
+   delete expression_;
+}
+
+void Filter::SetPattern(std::string const & pattern, Regex::Options options)
+{
+   delete expression_;
+
+   pattern_    = pattern;
+   expression_ = new Regex::RE(pattern, options);
+
+   bool literalOnly = false;
+   literal_     = RequiredLiteral(pattern, literalOnly);
+   literalOnly_ = (literalOnly == true) && ((options & Regex::CaseInsensitive) != 0);
+
+   Refilter();
+}
+
+void Filter::Validate()
+{
+   if ((source_ != NULL) && (settings_.Get(Setting::SongFormat) != format_))
+   {
+      Rebuild();
+   }
+}
+
+
+Mpc::Song * Filter::Get(uint32_t position) const
+{
+   return source_->Get(rows_.at(position));
+}
+
+int32_t Filter::Index(Mpc::Song * song) const
+{
+   int32_t const index = (source_ != NULL) ? source_->Index(song) : -1;
+
+   if (index >= 0)
+   {
+      auto const it = std::lower_bound(rows_.begin(), rows_.end(), static_cast<uint32_t>(index));
+
+      if ((it != rows_.end()) && (*it == static_cast<uint32_t>(index)))
+      {
+         return static_cast<int32_t>(it - rows_.begin());
+      }
+   }
+
+   return -1;
+}
+
+std::string Filter::String(uint32_t position) const
+{
+   return source_->String(rows_.at(position));
+}
+
+std::string Filter::PrintString(uint32_t position) const
+{
+   return source_->PrintString(rows_.at(position));
+}
+
+
+void Filter::OnSourceChanged(Main::BufferChange const & change)
+{
+   if (change.event_ == Main::Buffer_Destroy)
+   {
+      source_ = NULL;
+      rows_.clear();
+      text_.clear();
+      arena_.clear();
+      ++generation_;
+   }
+   else if (change.event_ == Main::Buffer_Reset)
+   {
+      // Only an assigned or cleared buffer has a different set of songs
+      Rebuild();
+   }
+   else
+   {
+      if (change.event_ == Main::Buffer_Add)
+      {
+         AddRows(change.position_, change.count_);
+      }
+      else if (change.event_ == Main::Buffer_Remove)
+      {
+         if (change.ranges_ != NULL)
+         {
+            RemoveRows(*change.ranges_);
+         }
+         else
+         {
+            RemoveRows(Ranges(1, Range(change.position_, change.position_ + change.count_)));
+         }
+      }
+      else if (change.event_ == Main::Buffer_Replace)
+      {
+         uint32_t const position = change.position_;
+         auto const     it       = std::lower_bound(rows_.begin(), rows_.end(), position);
+
+         ReplaceText(position);
+
+         bool const found = ((it != rows_.end()) && (*it == position));
+         bool const match = Test(position);
+
+         if ((found == true) && (match == false))
+         {
+            rows_.erase(it);
+         }
+         else if ((found == false) && (match == true))
+         {
+            rows_.insert(it, position);
+         }
+      }
+      else if (change.event_ == Main::Buffer_Reorder)
+      {
+         ReorderRows(*change.order_);
+      }
+
+      ++generation_;
+   }
+}
+
+void Filter::AddRows(uint32_t position, uint32_t count)
+{
+   std::vector<TextRange> text;
+   std::vector<uint32_t>  matches;
+
+   text.reserve(count);
+
+   for (uint32_t i = 0; i < count; ++i)
+   {
+      text.push_back(Append(position + i));
+   }
+
+   text_.insert(text_.begin() + position, text.begin(), text.end());
+
+   for (uint32_t i = 0; i < count; ++i)
+   {
+      if (Test(position + i) == true)
+      {
+         matches.push_back(position + i);
+      }
+   }
+
+   auto const it = std::lower_bound(rows_.begin(), rows_.end(), position);
+
+   for (auto jt = it; (jt != rows_.end()); ++jt)
+   {
+      *jt += count;
+   }
+
+   rows_.insert(it, matches.begin(), matches.end());
+}
+
+void Filter::RemoveRows(Ranges const & ranges)
+{
+   // The ranges are ascending, so the text and rows are compacted in one pass each
+   uint32_t kept = 0;
+   uint32_t pos  = 0;
+
+   for (auto const & range : ranges)
+   {
+      std::copy(text_.begin() + pos, text_.begin() + range.first, text_.begin() + kept);
+
+      for (uint32_t i = range.first; i < range.second; ++i)
+      {
+         garbage_ += text_[i].second;
+      }
+
+      kept += range.first - pos;
+      pos   = range.second;
+   }
+
+   std::copy(text_.begin() + pos, text_.end(), text_.begin() + kept);
+   text_.resize(kept + (text_.size() - pos));
+
+   uint32_t removed = 0;
+   auto     range   = ranges.begin();
+
+   kept = 0;
+
+   for (auto const row : rows_)
+   {
+      for (; (range != ranges.end()) && (range->second <= row); ++range)
+      {
+         removed += range->second - range->first;
+      }
+
+      if ((range == ranges.end()) || (row < range->first))
+      {
+         rows_[kept++] = row - removed;
+      }
+   }
+
+   rows_.resize(kept);
+   Compact();
+}
+
+void Filter::ReorderRows(std::vector<uint32_t> const & order)
+{
+   // The same songs match, they have only moved
+   std::vector<bool>      matched(text_.size(), false);
+   std::vector<TextRange> text;
+
+   for (auto const row : rows_)
+   {
+      matched[row] = true;
+   }
+
+   text.reserve(order.size());
+   rows_.clear();
+
+   for (uint32_t i = 0; i < order.size(); ++i)
+   {
+      text.push_back(text_[order[i]]);
+
+      if (matched[order[i]] == true)
+      {
+         rows_.push_back(i);
+      }
+   }
+
+   text_.swap(text);
+}
+
+void Filter::Rebuild()
+{
+   format_  = settings_.Get(Setting::SongFormat);
+   garbage_ = 0;
+   arena_.clear();
+   text_.clear();
+   text_.reserve(source_->Size());
+
+   for (uint32_t i = 0; i < source_->Size(); ++i)
+   {
+      text_.push_back(Append(i));
+   }
+
+   Refilter();
+}
+
+void Filter::Refilter()
+{
+   rows_.clear();
+
+   for (uint32_t i = 0; (source_ != NULL) && (i < source_->Size()); ++i)
+   {
+      if (Test(i) == true)
+      {
+         rows_.push_back(i);
+      }
+   }
+
+   ++generation_;
+}
+
+
+Filter::TextRange Filter::Append(uint32_t row)
+{
+   std::string const text = Fold(source_->Get(row)->FormatString(format_));
+   TextRange const range(static_cast<uint32_t>(arena_.size()), static_cast<uint32_t>(text.size()));
+
+   arena_.insert(arena_.end(), text.begin(), text.end());
+   return range;
+}
+
+void Filter::ReplaceText(uint32_t row)
+{
+   garbage_   += text_[row].second;
+   text_[row]  = Append(row);
+
+   Compact();
+}
+
+void Filter::Compact()
+{
+   // Text for removed or replaced songs is left in place until
+   // it makes up more than half of the arena
+   if (garbage_ > (arena_.size() / 2))
+   {
+      std::vector<char> arena;
+      arena.reserve(arena_.size() - garbage_);
+
+      for (auto it = text_.begin(); (it != text_.end()); ++it)
+      {
+         uint32_t const start = static_cast<uint32_t>(arena.size());
+         arena.insert(arena.end(), arena_.begin() + it->first, arena_.begin() + it->first + it->second);
+         it->first = start;
+      }
+
+      arena_.swap(arena);
+      garbage_ = 0;
+   }
+}
+
+
+bool Filter::Test(uint32_t row) const
+{
+   if (pattern_ == "")
+   {
+      return true;
+   }
+   else if ((literal_ != "") && (Contains(row) == false))
+   {
+      return false;
+   }
+   else if (literalOnly_ == true)
+   {
+      return true;
+   }
+
+   return expression_->Matches(source_->Get(row)->FormatString(format_));
+}
+
+bool Filter::Contains(uint32_t row) const
+{
+   // memchr and memcmp are vectorised by the C library, so scan for
+   // the first character of the literal and only then compare the rest
+   size_t const length  = literal_.size();
+   char const * current = arena_.data() + text_[row].first;
+   char const * end     = current + text_[row].second;
+
+   while (static_cast<size_t>(end - current) >= length)
+   {
+      current = static_cast<char const *>(memchr(current, literal_[0], (end - current) - length + 1));
+
+      if (current == NULL)
+      {
+         return false;
+      }
+      else if (memcmp(current + 1, literal_.data() + 1, length - 1) == 0)
+      {
+         return true;
+      }
+
+      ++current;
+   }
+
+   return false;
+}
+
+
+std::string Filter::Fold(std::string const & text)
+{
+   std::string Result(text);
+
+   for (auto it = Result.begin(); (it != Result.end()); ++it)
+   {
+      if ((static_cast<unsigned char>(*it) < 0x80) && (isupper(*it) != 0))
+      {
+         *it = static_cast<char>(tolower(*it));
+      }
+   }
+
+   return Result;
+}
+
+std::string Filter::RequiredLiteral(std::string const & pattern, bool & literalOnly)
+{
+   // Find the longest run of characters that every match must contain,
+   // this is conservative and gives up on anything it does not understand
+   std::string Result, run;
+
+   literalOnly = true;
+
+   // Alternatives may not need the literal and \Q...\E can hide the end of a group
+   if ((pattern.find('|') != std::string::npos) || (pattern.find("\\Q") != std::string::npos))
+   {
+      literalOnly = false;
+      return "";
+   }
+
+   for (size_t i = 0; i < pattern.size(); ++i)
+   {
+      char const c = pattern[i];
+
+      if ((c == '\\') && (i + 1 < pattern.size()) && (isalnum(pattern[i + 1]) == 0))
+      {
+         run += pattern[++i];
+         continue;
+      }
+      else if ((c != '\\') && (strchr(".^$?*+{}()[]", c) == NULL))
+      {
+         run += c;
+         continue;
+      }
+
+      literalOnly = false;
+
+      if ((c == '?') || (c == '*') || (c == '{'))
+      {
+         // The previous character is optional
+         if (run != "")
+         {
+            run.erase(run.size() - 1);
+         }
+
+         for (; (c == '{') && (i < pattern.size()) && (pattern[i] != '}'); ++i) { }
+      }
+      else if ((c == '(') || (c == '['))
+      {
+         char const close = (c == '(') ? ')' : ']';
+         uint32_t   depth = 0;
+
+         // Skip the whole group or class, a ] straight after the [ is literal
+         size_t j = i + 1;
+
+         for (; (j < pattern.size()); ++j)
+         {
+            bool const literal = (c == '[') && ((j == i + 1) || ((j == i + 2) && (pattern[i + 1] == '^')));
+
+            if (pattern[j] == '\\')
+            {
+               ++j;
+            }
+            else if ((c == '(') && (pattern[j] == '('))
+            {
+               ++depth;
+            }
+            else if ((pattern[j] == close) && (literal == false))
+            {
+               if (depth == 0)
+               {
+                  break;
+               }
+
+               --depth;
+            }
+         }
+
+         i = j;
+      }
+      else if (c == '\\')
+      {
+         // Character classes and assertions such as \d and \b end the run, other
+         // escapes such as \x41, \101 or \p{L} are followed by text that is not literal
+         if ((i + 1 < pattern.size()) && (strchr("dDwWsShHvVRXbBAzZGKC", pattern[i + 1]) != NULL))
+         {
+            ++i;
+         }
+         else
+         {
+            literalOnly = false;
+            return "";
+         }
+      }
+
+      if (run.size() > Result.size())
+      {
+         Result = run;
+      }
+
+      run = "";
+   }
+
+   if (run.size() > Result.size())
+   {
+      Result = run;
+   }
+
+   // Only ascii is folded, so multibyte characters cannot be compared caselessly
+   for (auto it = Result.begin(); (it != Result.end()); ++it)
+   {
+      if (static_cast<unsigned char>(*it) >= 0x80)
+      {
+         literalOnly = false;
+         return "";
+      }
+   }
+
+   return Fold(Result);
+}
+
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,116 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   filter.hpp - a live view of the songs in another buffer that match a pattern
+   */
+
+#ifndef __MPC__FILTER
+#define __MPC__FILTER
+
+// Includes
+#include <string>
+#include <vector>
+
+#include "regex.hpp"
+#include "settings.hpp"
+#include "song.hpp"
+
+#include "buffer/buffer.hpp"
+
+// Filter
+namespace Mpc
+{
+   //! Only the positions of the matching songs in the source buffer are
+   //! stored, these are kept up to date as the source buffer changes
+   class Filter : public Main::WindowBuffer
+   {
+   public:
+      typedef Main::Buffer<Mpc::Song *> SourceBuffer;
+
+   public:
+      Filter(SourceBuffer & source);
+      ~Filter();
+
+   private:
+      Filter(Filter const & filter);
+      Filter & operator=(Filter const & filter);
+
+   public:
+      void SetPattern(std::string const & pattern, Regex::Options options);
+      std::string const & Pattern() const { return pattern_; }
+
+      //! Rebuilds the searchable text for every song if the
+      //! format used to display the songs has changed
+      void Validate();
+
+      //! The source buffer, or NULL if it has been destroyed
+      SourceBuffer * Source() const { return source_; }
+
+   public:
+      Mpc::Song * Get(uint32_t position) const;
+      uint32_t Row(uint32_t position) const { return rows_.at(position); }
+      int32_t Index(Mpc::Song * song) const;
+
+   public: // Main::WindowBuffer
+      size_t Size() const { return rows_.size(); }
+      std::string String(uint32_t position) const;
+      std::string PrintString(uint32_t position) const;
+
+   private:
+      typedef std::pair<uint32_t, uint32_t> TextRange;
+      typedef std::pair<uint32_t, uint32_t> Range;
+      typedef std::vector<Range>            Ranges;
+
+      //! Songs that are added, removed or moved only update their own text
+      void OnSourceChanged(Main::BufferChange const & change);
+      void AddRows(uint32_t position, uint32_t count);
+      void RemoveRows(Ranges const & ranges);
+      void ReorderRows(std::vector<uint32_t> const & order);
+      void Rebuild();
+      void Refilter();
+
+      TextRange Append(uint32_t row);
+      void ReplaceText(uint32_t row);
+      void Compact();
+
+      bool Test(uint32_t row) const;
+      bool Contains(uint32_t row) const;
+
+      static std::string Fold(std::string const & text);
+      static std::string RequiredLiteral(std::string const & pattern, bool & literalOnly);
+
+   private:
+      Main::Settings const & settings_;
+      SourceBuffer *         source_;
+      uint32_t               callbackId_;
+      std::string            pattern_;
+      Regex::RE *            expression_;
+      std::string            literal_;
+      bool                   literalOnly_;
+      std::string            format_;
+      std::vector<uint32_t>  rows_;
+
+      // The lower cased text of every source song is kept in a single
+      // arena so that changing the pattern does not format any songs
+      std::vector<char>      arena_;
+      std::vector<TextRange> text_;
+      uint32_t               garbage_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
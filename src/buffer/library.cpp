@@ -302,19 +302,19 @@ void Library::AddToPlaylist(Mpc::Song::SongCollection Collection, Mpc::Client &
 {
    if (position < Size())
    {
-      if (Collection == Mpc::Song::Single)
-      {
-         AddToPlaylist(client, clientState, Get(position));
-      }
-      else
+      std::vector<uint32_t> Positions(1, position);
+
+      if (Collection != Mpc::Song::Single)
       {
-         Mpc::CommandList list(client);
+         Positions.resize(Size());
 
          for (uint32_t i = 0; i < Size(); ++i)
          {
-            AddToPlaylist(client, clientState, Get(i));
+            Positions[i] = i;
          }
       }
+
+      AddToPlaylist(Positions, client, clientState);
    }
 }
 
@@ -322,82 +322,75 @@ void Library::RemoveFromPlaylist(Mpc::Song::SongCollection Collection, Mpc::Clie
 {
    if (position < Size())
    {
-      if (Collection == Mpc::Song::Single)
-      {
-         RemoveFromPlaylist(client, Get(position));
-      }
-      else
+      std::vector<uint32_t> Positions(1, position);
+
+      if (Collection != Mpc::Song::Single)
       {
-         Mpc::CommandList list(client);
+         Positions.resize(Size());
 
          for (uint32_t i = 0; i < Size(); ++i)
          {
-            RemoveFromPlaylist(client, Get(i));
+            Positions[i] = i;
          }
       }
+
+      RemoveFromPlaylist(Positions, client);
    }
 }
 
-void Library::AddToPlaylist(Mpc::Client & client, Mpc::ClientState & clientState, Mpc::LibraryEntry const * const entry, int32_t position)
+void Library::AddToPlaylist(std::vector<uint32_t> const & Positions, Mpc::Client & client, Mpc::ClientState & clientState)
 {
-   if ((entry->type_ == Mpc::SongType) && (entry->song_ != NULL))
+   std::vector<Mpc::Song *> Songs;
+
+   for (auto position : Positions)
    {
-      if (position != -1)
+      if (position < Size())
       {
-         client.Add(*(entry->song_), position);
-      }
-      else if ((Main::Settings::Instance().Get(Setting::AddPosition) == Setting::AddEnd) ||
-               (clientState.GetCurrentSongPos() == -1))
-      {
-         client.Add(*(entry->song_));
-      }
-      else
-      {
-         client.Add(*(entry->song_), clientState.GetCurrentSongPos() + 1);
+         ChildSongs(Get(position), Songs);
       }
    }
-   else
-   {
-      int current = -1;
-
-      if ((Main::Settings::Instance().Get(Setting::AddPosition) == Setting::AddNext) &&
-          (clientState.GetCurrentSongPos() != -1))
-      {
-         current = clientState.GetCurrentSongPos() + 1;
-      }
 
-      for (auto child : entry->children_)
-      {
-         AddToPlaylist(client, clientState, child, current);
+   int32_t position = -1;
 
-         if (current != -1)
-         {
-            current++;
-         }
-      }
+   if ((Main::Settings::Instance().Get(Setting::AddPosition) == Setting::AddNext) &&
+       (clientState.GetCurrentSongPos() != -1))
+   {
+      position = clientState.GetCurrentSongPos() + 1;
    }
+
+   client.Add(Songs, position);
 }
 
-void Library::RemoveFromPlaylist(Mpc::Client & client, Mpc::LibraryEntry const * const entry)
+void Library::ChildSongs(Mpc::LibraryEntry const * const entry, std::vector<Mpc::Song *> & Result) const
 {
    if ((entry->type_ == Mpc::SongType) && (entry->song_ != NULL))
    {
-      int32_t PlaylistIndex = Main::Playlist().Index(entry->song_);
-
-      if (PlaylistIndex >= 0)
-      {
-         client.Delete(PlaylistIndex);
-      }
+      Result.push_back(entry->song_);
    }
    else
    {
       for (auto child : entry->children_)
       {
-         RemoveFromPlaylist(client, child);
+         ChildSongs(child, Result);
       }
    }
 }
 
+void Library::RemoveFromPlaylist(std::vector<uint32_t> const & Positions, Mpc::Client & client)
+{
+   std::vector<Mpc::Song *> Songs;
+
+   for (auto position : Positions)
+   {
+      if (position < Size())
+      {
+         ChildSongs(Get(position), Songs);
+      }
+   }
+
+   client.Delete(Main::Playlist().Positions(Songs));
+}
+
 void Library::ForEachChild(uint32_t index, FUNCTION<void (Mpc::Song *)> callback) const
 {
    for (auto child : Get(index)->children_)
@@ -226,6 +226,12 @@ namespace Mpc
       void AddToPlaylist(Mpc::Song::SongCollection Collection, Mpc::Client & client, Mpc::ClientState & clientState, uint32_t position);
       void RemoveFromPlaylist(Mpc::Song::SongCollection Collection, Mpc::Client & client, Mpc::ClientState & clientState, uint32_t position);
 
+      //! Adds the songs of each line, in order, with a single add
+      void AddToPlaylist(std::vector<uint32_t> const & Positions, Mpc::Client & client, Mpc::ClientState & clientState);
+
+      //! Deletes every occurrence of the songs of each line with a single delete
+      void RemoveFromPlaylist(std::vector<uint32_t> const & Positions, Mpc::Client & client);
+
       void CreateVariousArtist();
       Mpc::LibraryEntry * CreateArtistEntry(std::string artist);
       Mpc::LibraryEntry * CreateAlbumEntry(Mpc::Song * song);
@@ -245,8 +251,7 @@ namespace Mpc
    private:
       void RecreateLibraryFromURIs();
 
-      void AddToPlaylist(Mpc::Client & client, Mpc::ClientState & clientState, Mpc::LibraryEntry const * const entry, int32_t position = -1);
-      void RemoveFromPlaylist(Mpc::Client & client, Mpc::LibraryEntry const * const entry);
+      void ChildSongs(Mpc::LibraryEntry const * const entry, std::vector<Mpc::Song *> & Result) const;
       void DeleteEntry(LibraryEntry * const entry);
       void CheckIfVariousRemoved(LibraryEntry * const entry);
       void RemoveAndUnexpand(LibraryEntry * const entry);
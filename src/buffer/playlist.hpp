@@ -52,12 +52,30 @@ namespace Mpc
 
       void DeleteSong(Mpc::Song * song)
       {
-         if (Main::Library().Song(song->URI()) == NULL)
+         // Songs in the library have an entry there and belong to it
+         if (song->Entry() == NULL)
          {
             delete song;
          }
       }
 
+      //! Every position at which one of the songs is in the playlist
+      std::vector<uint32_t> Positions(std::vector<Mpc::Song *> songs) const
+      {
+         std::vector<uint32_t> Result;
+         std::sort(songs.begin(), songs.end());
+
+         for (uint32_t i = 0; i < Size(); ++i)
+         {
+            if (std::binary_search(songs.begin(), songs.end(), Get(i)) == true)
+            {
+               Result.push_back(i);
+            }
+         }
+
+         return Result;
+      }
+
       std::string String(uint32_t position) const      { return Get(position)->FormatString(settings_.Get(Setting::SongFormat)); }
       std::string PrintString(uint32_t position) const
       {
@@ -19,6 +19,7 @@
    */
 
 #include "buffers.hpp"
+#include "stats.hpp"
 #include "vimpc.hpp"
 
 #include "buffer/browse.hpp"
@@ -44,6 +45,20 @@ static Ui::Console *    d_buffer    = NULL;
 static Ui::Console *    x_buffer    = NULL;
 static Main::Lyrics *   y_buffer    = NULL;
 
+static uint32_t const   DebugConsoleLines = 2000;
+
+static uint64_t TextMemory(Main::Buffer<std::string> const & buffer)
+{
+   uint64_t Result = 0;
+
+   for (uint32_t i = 0; i < buffer.Size(); ++i)
+   {
+      Result += sizeof(std::string) + buffer.Get(i).capacity();
+   }
+
+   return Result;
+}
+
 void Main::Delete()
 {
    delete l_buffer;
@@ -67,18 +82,22 @@ Mpc::Playlist & Main::Playlist()
    if (p_buffer == NULL)
    {
       p_buffer = new Mpc::Playlist(true);
+      Main::Stats::Instance().RegisterMemory("playlist", [] () { return Main::Playlist().Size() * sizeof(Mpc::Song *); });
       Main::Vimpc::EventHandler(Event::ClearDatabase, [] (EventData const & Data)
-         { Main::Playlist().Clear(); });
+         {
+            Mpc::Song::ReferenceBatch batch;
+            Main::Playlist().Clear();
+         });
 
       //
       Main::Vimpc::EventHandler(Event::PlaylistAdd, [] (EventData const & Data)
          {
-            Mpc::Song * song = (Data.song != NULL) ? Data.song : Main::Library().Song(Data.uri);
+            Mpc::Song * song = (Data.song != NULL) ? Data.song : Main::Library().Song(Data.Uri());
 
             if (song == NULL)
             {
                song = new Mpc::Song();
-               song->SetURI(Data.uri.c_str());
+               song->SetURI(Data.Uri().c_str());
             }
 
             if (Data.pos1 == -1)
@@ -91,9 +110,37 @@ Mpc::Playlist & Main::Playlist()
             }
          });
 
+      Main::Vimpc::EventHandler(Event::PlaylistAddSongs, [] (EventData const & Data)
+         {
+            std::vector<Mpc::Song *> songs;
+            songs.reserve(Data.Uris().size());
+
+            for (auto const & uri : Data.Uris())
+            {
+               Mpc::Song * song = Main::Library().Song(uri);
+
+               if (song == NULL)
+               {
+                  song = new Mpc::Song();
+                  song->SetURI(uri.c_str());
+               }
+
+               songs.push_back(song);
+            }
+
+            uint32_t const size = Main::Playlist().Size();
+            uint32_t const position = ((Data.pos1 == -1) || (static_cast<uint32_t>(Data.pos1) > size)) ? size : Data.pos1;
+
+            Mpc::Song::ReferenceBatch batch;
+            Main::Playlist().Add(songs, position);
+         });
+
       Main::Vimpc::EventHandler(Event::PlaylistQueueReplace, [] (EventData const & Data)
          {
-            for (auto pair : Data.posuri)
+            // Songs that only move are not taken out of the library and directories
+            Mpc::Song::ReferenceBatch batch;
+
+            for (auto pair : Data.PosUri())
             {
                Mpc::Song * song = (pair.second.first != NULL) ? pair.second.first : Main::Library().Song(pair.second.second);
 
@@ -148,9 +195,15 @@ Mpc::Library & Main::Library()
    {
       l_buffer = new Mpc::Library();
       Main::Vimpc::EventHandler(Event::ClearDatabase, [] (EventData const & Data)
-         { Main::Library().Clear(); });
+         { Main::Library().Clear(); Main::Stats::Instance().IngestReset(); });
       Main::Vimpc::EventHandler(Event::DatabaseSong,  [] (EventData const & Data)
-         { Main::Library().Add(Data.song); });
+         { Main::Library().Add(Data.song); Main::Stats::Instance().Ingest(); });
+      Main::Stats::Instance().RegisterMemory("library", [] ()
+         {
+            uint64_t Result = 0;
+            Main::Library().ForEachSong([&Result] (Mpc::Song * song) { Result += song->Memory(); });
+            return Result;
+         });
    }
    return *l_buffer;
 }
@@ -165,9 +218,9 @@ Mpc::Directory & Main::Directory()
       Main::Vimpc::EventHandler(Event::DatabaseSong,  [] (EventData const & Data)
          { Main::Directory().Add(Data.song); });
       Main::Vimpc::EventHandler(Event::DatabasePath, [] (EventData const & Data)
-         { Main::Directory().Add(Data.uri); });
+         { Main::Directory().Add(Data.Uri()); });
       Main::Vimpc::EventHandler(Event::DatabaseListFile, [] (EventData const & Data)
-         { Mpc::List const list(Data.uri, Data.name); Main::Directory().AddPlaylist(list); });
+         { Mpc::List const list(Data.Uri(), Data.name); Main::Directory().AddPlaylist(list); });
    }
    return *dir_buffer;
 }
@@ -180,7 +233,7 @@ Mpc::Lists & Main::FileLists()
       Main::Vimpc::EventHandler(Event::ClearDatabase, [] (EventData const & Data)
          { Main::FileLists().Clear(); });
       Main::Vimpc::EventHandler(Event::DatabaseListFile, [] (EventData const & Data)
-         { Mpc::List const list(Data.uri, Data.name); Main::FileLists().Add(list); });
+         { Mpc::List const list(Data.Uri(), Data.name); Main::FileLists().Add(list); });
    }
    return *f_buffer;
 }
@@ -214,7 +267,7 @@ Mpc::Lists & Main::AllLists()
       Main::Vimpc::EventHandler(Event::ClearDatabase, [] (EventData const & Data)
          { Main::AllLists().Clear(); });
       Main::Vimpc::EventHandler(Event::DatabaseListFile, [] (EventData const & Data)
-         { Mpc::List const list(Data.uri, Data.name); Main::AllLists().Add(list); });
+         { Mpc::List const list(Data.Uri(), Data.name); Main::AllLists().Add(list); });
       Main::Vimpc::EventHandler(Event::DatabaseList, [] (EventData const & Data)
          { Mpc::List const list(Data.name); Main::AllLists().Add(list); });
       Main::Vimpc::EventHandler(Event::NewPlaylist, [] (EventData const & Data)
@@ -245,6 +298,7 @@ Ui::Console & Main::Console()
    if (c_buffer == NULL)
    {
       c_buffer = new Ui::Console();
+      Main::Stats::Instance().RegisterMemory("console", [] () { return TextMemory(Main::Console()); });
    }
    return *c_buffer;
 }
@@ -254,6 +308,24 @@ Ui::Console & Main::DebugConsole()
    if (d_buffer == NULL)
    {
       d_buffer = new Ui::Console();
+      Main::Stats::Instance().RegisterMemory("debug console", [] () { return TextMemory(Main::DebugConsole()); });
+
+      // Only keep the most recent messages, the log file has the rest
+      Main::Vimpc::EventHandler(Event::LogMessages, [] (EventData const & Data)
+      {
+         for (auto const & line : Data.Uris())
+         {
+            Main::DebugConsole().Add(line);
+         }
+
+         if (Main::DebugConsole().Size() > DebugConsoleLines)
+         {
+            // Trim in one pass rather than shuffling the whole buffer per line
+            std::vector<std::pair<uint32_t, uint32_t> > ranges;
+            ranges.push_back(std::make_pair(0, Main::DebugConsole().Size() - DebugConsoleLines));
+            Main::DebugConsole().Remove(ranges);
+         }
+      });
    }
    return *d_buffer;
 }
@@ -274,6 +346,7 @@ Main::Lyrics & Main::LyricsBuffer()
    if (y_buffer == NULL)
    {
       y_buffer = new Main::Lyrics();
+      Main::Stats::Instance().RegisterMemory("lyrics", [] () { return TextMemory(Main::LyricsBuffer()); });
    }
    return *y_buffer;
 }
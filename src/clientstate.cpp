@@ -61,6 +61,7 @@ ClientState::ClientState(Main::Vimpc * vimpc, Main::Settings & settings, Ui::Scr
 
    currentSong_          (NULL),
    currentSongId_        (-1),
+   nextSongPos_          (-1),
    totalNumberOfSongs_   (0),
    currentState_         ("Disconnected"),
    lastTitleStr_         ("")
@@ -84,6 +85,7 @@ ClientState::ClientState(Main::Vimpc * vimpc, Main::Settings & settings, Ui::Scr
       this->crossfade_          = false;
       this->crossfadeTime_      = 0;
       this->currentSongId_      = -1;
+      this->nextSongPos_        = -1;
       this->currentSongURI_     = "";
       this->totalNumberOfSongs_ = 0;
 
@@ -94,8 +96,7 @@ ClientState::ClientState(Main::Vimpc * vimpc, Main::Settings & settings, Ui::Scr
       }
 
       DisplaySongInformation();
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::ClearDatabase, [this] (EventData const & Data)
@@ -110,7 +111,7 @@ ClientState::ClientState(Main::Vimpc * vimpc, Main::Settings & settings, Ui::Scr
 
    Main::Vimpc::EventHandler(Event::ChangeHost, [this] (EventData const & Data)
    {
-      this->hostname_ = Data.hostname;
+      this->hostname_ = Data.name;
       this->port_     = Data.port;
    });
 
@@ -119,7 +120,12 @@ ClientState::ClientState(Main::Vimpc * vimpc, Main::Settings & settings, Ui::Scr
       this->currentSongId_ = Data.id;
       DisplaySongInformation();
 
-      Main::Vimpc::CreateEvent(Event::Repaint, Data);
+      Main::Vimpc::CreateEvent(Event::Repaint);
+   });
+
+   Main::Vimpc::EventHandler(Event::NextSongPos, [this] (EventData const & Data)
+   {
+      this->nextSongPos_ = Data.value;
    });
 
    Main::Vimpc::EventHandler(Event::Elapsed, [this] (EventData const & Data)
@@ -140,49 +146,43 @@ ClientState::ClientState(Main::Vimpc * vimpc, Main::Settings & settings, Ui::Scr
       currentSongURI_ = (currentSong_ != NULL) ? mpd_song_get_uri(currentSong_) : "";
       DisplaySongInformation();
 
-      Main::Vimpc::CreateEvent(Event::Repaint, Data);
+      Main::Vimpc::CreateEvent(Event::Repaint);
    });
 
    Main::Vimpc::EventHandler(Event::Random, [this] (EventData const & Data)
    {
       this->random_ = Data.state;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::Consume, [this] (EventData const & Data)
    {
       this->consume_ = Data.state;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::Repeat, [this] (EventData const & Data)
    {
       this->repeat_ = Data.state;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::Single, [this] (EventData const & Data)
    {
       this->single_ = Data.state;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::Mute, [this] (EventData const & Data)
    {
       this->mute_ = Data.state;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::Crossfade, [this] (EventData const & Data)
    {
       this->crossfade_ = Data.state;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::CrossfadeTime, [this] (EventData const & Data)
@@ -191,36 +191,31 @@ ClientState::ClientState(Main::Vimpc * vimpc, Main::Settings & settings, Ui::Scr
    Main::Vimpc::EventHandler(Event::TotalSongCount, [this] (EventData const & Data)
    {
       this->totalNumberOfSongs_ = Data.count;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::Update, [this] (EventData const & Data)
    {
       this->updating_ = true;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::UpdateComplete, [this] (EventData const & Data)
    {
       this->updating_ = false;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::Volume, [this] (EventData const & Data)
    {
       this->volume_ = Data.value;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    Main::Vimpc::EventHandler(Event::CurrentState, [this] (EventData const & Data)
    {
-      this->currentState_ = Data.clientstate;
-      EventData EData;
-      Main::Vimpc::CreateEvent(Event::StatusUpdate, EData);
+      this->currentState_ = Data.name;
+      Main::Vimpc::CreateEvent(Event::StatusUpdate);
    });
 
    updateThread_ = std::thread([this]() {
@@ -244,8 +239,7 @@ ClientState::ClientState(Main::Vimpc * vimpc, Main::Settings & settings, Ui::Scr
             if (this->scrollingStatus_ == true)
             {
                this->titlePos_++;
-               EventData EData;
-               Main::Vimpc::CreateEvent(Event::DisplaySongInfo, EData);
+               Main::Vimpc::CreateEvent(Event::DisplaySongInfo);
             }
             this->waitTime_ = 150;
          } 
@@ -353,6 +347,11 @@ int32_t ClientState::GetCurrentSongPos()
    }
 }
 
+int32_t ClientState::GetNextSongPos() const
+{
+   return nextSongPos_;
+}
+
 uint32_t ClientState::TotalNumberOfSongs()
 {
    return totalNumberOfSongs_;
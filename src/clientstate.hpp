@@ -80,6 +80,7 @@ namespace Mpc
 
       uint32_t TotalNumberOfSongs();
       int32_t  GetCurrentSongPos();
+      int32_t  GetNextSongPos() const;
 
 
    public:
@@ -118,6 +119,7 @@ namespace Mpc
 
       mpd_song *              currentSong_;
       int32_t                 currentSongId_;
+      int32_t                 nextSongPos_;
       uint32_t                totalNumberOfSongs_;
       std::string             currentSongURI_;
       std::string             currentState_;
@@ -48,6 +48,7 @@ typedef boost::recursive_mutex    RecursiveMutex;
 typedef boost::condition_variable ConditionVariable;
 #define Atomic(X) X
 #define UniqueLock boost::unique_lock
+#define ThisThread boost::this_thread
 
 template <typename T>
 bool ConditionWait(ConditionVariable & Condition, UniqueLock<T> & Lock, int TimeoutMs)
@@ -61,6 +62,7 @@ typedef std::recursive_mutex      RecursiveMutex;
 typedef std::condition_variable   ConditionVariable;
 #define Atomic(X) std::atomic<X>
 #define UniqueLock std::unique_lock
+#define ThisThread std::this_thread
 
 template <typename T>
 bool ConditionWait(ConditionVariable & Condition, UniqueLock<T> & Lock, int TimeoutMs)
@@ -53,6 +53,7 @@
    X(NoRangeAllowed,        "No range allowed for command") \
    X(ErrorClear,            "Clear all other errors") \
    X(WindowDisabled,        "Window not supported and is disabled") \
+   X(FilterNotSupported,    "Window cannot be filtered") \
    X(Unknown,               "Unknown")
 
 namespace ErrorNumber
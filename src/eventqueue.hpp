@@ -0,0 +1,226 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   eventqueue.hpp - bounded queue of events from any thread to the main loop
+   */
+
+#ifndef __MAIN__EVENTQUEUE
+#define __MAIN__EVENTQUEUE
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "compiler.hpp"
+
+namespace Main
+{
+   //! Producers claim a slot by advancing the head and publish it through the
+   //! slot's sequence number, so pushing and popping never take a lock. The
+   //! gcc atomic builtins are used so that this also works with boost threads.
+   //!
+   //! Only a single thread may pop, a producer only makes a system call to wake
+   //! it up when it is asleep in Wait()
+   template <typename T>
+   class EventQueue
+   {
+      public:
+         //! The capacity is rounded up to a power of two
+         EventQueue(uint32_t capacity) :
+            slots_   (),
+            mask_    (0),
+            head_    (0),
+            tail_    (0),
+            sleeping_(0)
+         {
+            uint32_t size = 2;
+
+            for (; (size < capacity); size <<= 1) { }
+
+            slots_.resize(size);
+            mask_ = size - 1;
+
+            for (uint32_t i = 0; i < size; ++i)
+            {
+               slots_[i].sequence = i;
+            }
+         }
+
+      private:
+         EventQueue(EventQueue const &);
+         EventQueue & operator=(EventQueue const &);
+
+      public:
+         //! Returns false, leaving the value alone, if the queue is full
+         bool TryPush(T && value)
+         {
+            uint64_t position = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+            Slot *   slot     = NULL;
+
+            for (;;)
+            {
+               slot = &slots_[position & mask_];
+
+               int64_t const difference = static_cast<int64_t>(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - position);
+
+               if (difference == 0)
+               {
+                  if (__atomic_compare_exchange_n(&head_, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == true)
+                  {
+                     break;
+                  }
+               }
+               else if (difference < 0)
+               {
+                  return false;
+               }
+               else
+               {
+                  position = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+               }
+            }
+
+            slot->value = std::move(value);
+            __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+
+            // Pairs with the fence in Wait(), either the consumer sees the
+            // new event before it sleeps or we see that it is sleeping
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+            if ((__atomic_load_n(&sleeping_, __ATOMIC_RELAXED) != 0) &&
+                (__atomic_exchange_n(&sleeping_, 0, __ATOMIC_SEQ_CST) != 0))
+            {
+               Wake();
+            }
+
+            return true;
+         }
+
+         //! Must only be called by the consumer
+         bool TryPop(T & value)
+         {
+            Slot & slot = slots_[tail_ & mask_];
+
+            if (__atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE) != tail_ + 1)
+            {
+               return false;
+            }
+
+            value = std::move(slot.value);
+            slot.value = T();
+            __atomic_store_n(&slot.sequence, tail_ + mask_ + 1, __ATOMIC_RELEASE);
+            ++tail_;
+            return true;
+         }
+
+         //! Must only be called by the consumer, returns early if there is
+         //! an event, otherwise sleeps until one is pushed or for the timeout
+         void Wait(int timeoutMs)
+         {
+            // Events tend to come in bursts, so look again for a moment
+            // before paying for the system calls to sleep and be woken
+            for (uint32_t spin = 0; (spin < SpinCount); ++spin)
+            {
+               if (Empty() == false)
+               {
+                  return;
+               }
+            }
+
+#ifndef __linux__
+            UniqueLock<Mutex> Lock(mutex_);
+#endif
+            __atomic_store_n(&sleeping_, 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+            if (Empty() == true)
+            {
+#ifdef __linux__
+               struct timespec timeout;
+               timeout.tv_sec  = timeoutMs / 1000;
+               timeout.tv_nsec = (timeoutMs % 1000) * 1000000;
+
+               // Returns straight away if a producer has already cleared the flag
+               syscall(SYS_futex, &sleeping_, FUTEX_WAIT_PRIVATE, 1, &timeout, NULL, 0);
+#else
+               if (__atomic_load_n(&sleeping_, __ATOMIC_SEQ_CST) != 0)
+               {
+                  ConditionWait(condition_, Lock, timeoutMs);
+               }
+#endif
+            }
+
+            __atomic_store_n(&sleeping_, 0, __ATOMIC_RELAXED);
+         }
+
+         //! Must only be called by the consumer
+         bool Empty() const
+         {
+            return (__atomic_load_n(&slots_[tail_ & mask_].sequence, __ATOMIC_ACQUIRE) != tail_ + 1);
+         }
+
+         //! Must only be called by the consumer, includes events still being pushed
+         uint32_t Size() const { return static_cast<uint32_t>(__atomic_load_n(&head_, __ATOMIC_RELAXED) - tail_); }
+
+         uint32_t Capacity() const { return static_cast<uint32_t>(slots_.size()); }
+
+      private:
+         void Wake()
+         {
+#ifdef __linux__
+            syscall(SYS_futex, &sleeping_, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+            // The consumer holds the mutex from setting the flag until it
+            // waits, so taking it here means the notify cannot be missed
+            UniqueLock<Mutex> Lock(mutex_);
+            condition_.notify_one();
+#endif
+         }
+
+      private:
+         static uint32_t const SpinCount = 1024;
+
+         struct Slot
+         {
+            uint64_t sequence;
+            T        value;
+         };
+
+         std::vector<Slot> slots_;
+         uint64_t          mask_;
+
+         // Keep the producers' and the consumer's positions on separate cache lines
+         alignas(64) uint64_t head_;
+         alignas(64) uint64_t tail_;
+         alignas(64) int32_t  sleeping_;
+
+#ifndef __linux__
+         Mutex             mutex_;
+         ConditionVariable condition_;
+#endif
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
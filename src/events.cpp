@@ -21,6 +21,8 @@
 
 #include "events.hpp"
 
+#include <new>
+
 std::string EventStrings::Default[] =
 {
 #define X(Number, String) String,
@@ -28,3 +30,99 @@ std::string EventStrings::Default[] =
 #undef X
       "EventCount"
 };
+
+EventPayload::EventPayload() :
+   type_(None)
+{
+}
+
+EventPayload::EventPayload(EventPayload && payload) :
+   type_(None)
+{
+   *this = std::move(payload);
+}
+
+EventPayload & EventPayload::operator=(EventPayload && payload)
+{
+   if (this != &payload)
+   {
+      Reset(payload.type_);
+
+      switch (type_)
+      {
+         case UriType:   uri_.swap(payload.uri_);     break;
+         case UrisType:  uris_.swap(payload.uris_);   break;
+         case SongsType: songs_.swap(payload.songs_); break;
+         default:    break;
+      }
+
+      payload.Reset(None);
+   }
+
+   return *this;
+}
+
+EventPayload::~EventPayload()
+{
+   Reset(None);
+}
+
+std::string const & EventPayload::Uri() const
+{
+   static std::string const Empty;
+   return (type_ == UriType) ? uri_ : Empty;
+}
+
+EventPayload::UriList const & EventPayload::Uris() const
+{
+   static UriList const Empty;
+   return (type_ == UrisType) ? uris_ : Empty;
+}
+
+EventPayload::SongList const & EventPayload::PosUri() const
+{
+   static SongList const Empty;
+   return (type_ == SongsType) ? songs_ : Empty;
+}
+
+std::string & EventPayload::Uri()
+{
+   Reset(UriType);
+   return uri_;
+}
+
+EventPayload::UriList & EventPayload::Uris()
+{
+   Reset(UrisType);
+   return uris_;
+}
+
+EventPayload::SongList & EventPayload::PosUri()
+{
+   Reset(SongsType);
+   return songs_;
+}
+
+void EventPayload::Reset(Type type)
+{
+   if (type != type_)
+   {
+      switch (type_)
+      {
+         case UriType:   uri_.~basic_string(); break;
+         case UrisType:  uris_.~UriList();     break;
+         case SongsType: songs_.~SongList();   break;
+         default:    break;
+      }
+
+      type_ = type;
+
+      switch (type_)
+      {
+         case UriType:   new (&uri_) std::string(); break;
+         case UrisType:  new (&uris_) UriList();    break;
+         case SongsType: new (&songs_) SongList();  break;
+         default:    break;
+      }
+   }
+}
@@ -22,7 +22,10 @@
 #ifndef __EVENTS
 #define __EVENTS
 
+#include <stdint.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "song.hpp"
 
@@ -38,6 +41,7 @@
    X(Repaint, "Repaint") \
    X(CurrentSongId, "CurrentSongId") \
    X(CurrentSong, "CurrentSong") \
+   X(NextSongPos, "NextSongPos") \
    X(QueueUpdate, "QueueUpdate") \
    X(QueueChangesStart, "QueueChangesStart") \
    X(ClearDatabase, "ClearDatabase") \
@@ -48,6 +52,7 @@
    X(AllMetaDataReady, "AllMetaDataReady") \
    X(NewPlaylist, "NewPlaylist") \
    X(PlaylistAdd, "PlaylistAdd") \
+   X(PlaylistAddSongs, "PlaylistAddSongs") \
    X(PlaylistQueueReplace, "PlaylistQueueReplace") \
    X(Output, "Output") \
    X(OutputEnabled, "OutputEnabled") \
@@ -73,9 +78,11 @@
    X(IdleMode, "IdleMode") \
    X(StopIdleMode, "StopIdleMode") \
    X(LyricsLoaded, "LyricsLoaded") \
-   X(LyricsPercent, "LyricsPercent") \
+   X(LyricsLine, "LyricsLine") \
    X(DisplaySongInfo, "DisplaySongInfo") \
    X(DatabaseEnabled, "DatabaseEnabled") \
+   X(LogMessages, "LogMessages") \
+   X(Bench, "Bench") \
    X(Unknown, "Unknown")
 
 namespace Mpc
@@ -101,15 +108,95 @@ public:
    static std::string Default[];
 };
 
+//! The strings and lists that only some types of event carry, only
+//! one of them is held so that the events that carry none stay small
+class EventPayload
+{
+public:
+   typedef std::vector<std::string> UriList;
+   typedef std::vector<std::pair<int32_t, std::pair<Mpc::Song *, std::string> > > SongList;
+
+   typedef enum
+   {
+      None,
+      UriType,
+      UrisType,
+      SongsType
+   } Type;
+
+public:
+   EventPayload();
+   EventPayload(EventPayload && payload);
+   EventPayload & operator=(EventPayload && payload);
+   ~EventPayload();
+
+private:
+   EventPayload(EventPayload const &);
+   EventPayload & operator=(EventPayload const &);
+
+public:
+   Type GetType() const { return type_; }
+
+   //! These return an empty value if the payload is of a different type
+   std::string const & Uri() const;
+   UriList const &     Uris() const;
+   SongList const &    PosUri() const;
+
+   //! These replace the payload if it is of a different type
+   std::string & Uri();
+   UriList &     Uris();
+   SongList &    PosUri();
+
+private:
+   void Reset(Type type);
+
+private:
+   Type type_;
+
+   union
+   {
+      std::string uri_;
+      UriList     uris_;
+      SongList    songs_;
+   };
+};
+
+//! Events are moved, never copied, from the thread that creates them
+//! to the main loop and are then passed to each handler by reference
 struct EventData
 {
    EventData() :
+      input (0),
+      count (0),
+      value (0),
+      pos1  (0),
+      pos2  (0),
+      id    (0),
+      port  (0),
+      state (false),
       user  (false),
+      time  (0),
       song  (NULL),
       output(NULL),
       currentSong(NULL)
          { }
 
+   EventData(EventData && data) = default;
+   EventData & operator=(EventData && data) = default;
+
+private:
+   EventData(EventData const &);
+   EventData & operator=(EventData const &);
+
+public:
+   std::string const & Uri() const                  { return payload.Uri(); }
+   std::string & Uri()                              { return payload.Uri(); }
+   EventPayload::UriList const & Uris() const       { return payload.Uris(); }
+   EventPayload::UriList & Uris()                   { return payload.Uris(); }
+   EventPayload::SongList const & PosUri() const    { return payload.PosUri(); }
+   EventPayload::SongList & PosUri()                { return payload.PosUri(); }
+
+public:
    int32_t  input;
    int32_t  count;
    int32_t  value;
@@ -119,16 +206,12 @@ struct EventData
    uint32_t port;
    bool     state;
    bool     user;
-   std::string uri;
-   std::string name;
-   std::string hostname;
-   std::string clientstate;
+   uint64_t time;  // When the event was created, for the stats window
+   std::string name;  // Also the host for ChangeHost and the state for CurrentState
    Mpc::Song * song;
    Mpc::Output * output;
    mpd_song *  currentSong;
-
-   std::vector<std::string> uris;
-   std::vector<std::pair<int32_t, std::pair<Mpc::Song *, std::string> > > posuri;
+   EventPayload payload;
 };
 
 #endif
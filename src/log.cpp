@@ -0,0 +1,348 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   log.cpp - leveled logging, formatted on a thread of its own
+   */
+
+#include "log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "events.hpp"
+#include "trace.hpp"
+#include "vimpc.hpp"
+
+using namespace Main;
+
+#ifdef __DEBUG_PRINTS
+int Log::level_ = LogLevel::Debug;
+#else
+int Log::level_ = LogLevel::Info;
+#endif
+
+namespace
+{
+   // Messages written faster than the log thread can keep up with are counted and dropped
+   uint32_t const QueueSize = 1024;
+
+   char const * const LevelNames[LogLevel::LevelCount] = { "error", "warning", "info", "debug" };
+
+   bool IsConversion(char c)
+   {
+      return (strchr("diouxXeEfFgGaAcsp", c) != NULL);
+   }
+}
+
+
+Log & Log::Instance()
+{
+   static Log log;
+   return log;
+}
+
+Log::Log() :
+   queue_       (QueueSize),
+   dropped_     (0),
+   running_     (true),
+   thread_      (),
+   fileBytes_   (0),
+   fileMaxBytes_(0)
+{
+   thread_ = Thread(&Log::Run, this);
+}
+
+Log::~Log()
+{
+   Stop();
+}
+
+void Log::SetLevel(std::string const & level)
+{
+   for (int i = 0; i < LogLevel::LevelCount; ++i)
+   {
+      if (level == LevelNames[i])
+      {
+         __atomic_store_n(&level_, i, __ATOMIC_RELAXED);
+      }
+   }
+}
+
+void Log::SetFile(std::string const & file, uint64_t maxBytes)
+{
+   UniqueLock<Mutex> Lock(fileMutex_);
+
+   fileMaxBytes_ = maxBytes;
+
+   if (file != fileName_)
+   {
+      if (file_.is_open() == true)
+      {
+         file_.close();
+      }
+
+      fileName_  = file;
+      fileBytes_ = 0;
+
+      if (fileName_ != "")
+      {
+         file_.open(fileName_.c_str(), std::ios::out | std::ios::app);
+         file_.seekp(0, std::ios::end);
+         fileBytes_ = static_cast<uint64_t>(file_.tellp());
+      }
+   }
+}
+
+void Log::Stop()
+{
+   if (__atomic_exchange_n(&running_, false, __ATOMIC_SEQ_CST) == true)
+   {
+      thread_.join();
+   }
+}
+
+
+std::string Log::Format(Record const & record)
+{
+   std::string result;
+   uint32_t    argument = 0;
+
+   for (char const * c = record.format; (*c != '\0'); ++c)
+   {
+      if (*c != '%')
+      {
+         result += *c;
+         continue;
+      }
+
+      if (*(c + 1) == '%')
+      {
+         result += '%';
+         ++c;
+         continue;
+      }
+
+      // Keep the flags, width and precision, the length and conversion
+      // come from the type of the argument instead
+      char const * const start = c++;
+
+      for (; (*c != '\0') && (strchr("-+ #0123456789.", *c) != NULL); ++c) { }
+      for (; (*c != '\0') && (strchr("hlLqjzt", *c) != NULL); ++c) { }
+
+      if ((IsConversion(*c) == false) || (argument >= record.count))
+      {
+         result.append(start, (*c != '\0') ? (c - start + 1) : (c - start));
+
+         if (*c == '\0')
+         {
+            break;
+         }
+
+         continue;
+      }
+
+      std::string spec(start, c - start);
+      spec.erase(spec.find_last_not_of("hlLqjzt") + 1);
+
+      Argument const & value = record.arguments[argument++];
+      char             buffer[TextSize];
+
+      switch (value.type)
+      {
+         case Argument::Signed:
+            if (*c == 'c')
+            {
+               snprintf(buffer, sizeof(buffer), (spec + "c").c_str(), static_cast<int>(value.i));
+            }
+            else if (strchr("ouxX", *c) != NULL)
+            {
+               snprintf(buffer, sizeof(buffer), (spec + "ll" + *c).c_str(), static_cast<unsigned long long>(value.i));
+            }
+            else
+            {
+               snprintf(buffer, sizeof(buffer), (spec + "lld").c_str(), static_cast<long long>(value.i));
+            }
+            break;
+
+         case Argument::Unsigned:
+            if (*c == 'c')
+            {
+               snprintf(buffer, sizeof(buffer), (spec + "c").c_str(), static_cast<int>(value.u));
+            }
+            else
+            {
+               snprintf(buffer, sizeof(buffer), (spec + "ll" + ((strchr("oxX", *c) != NULL) ? *c : 'u')).c_str(),
+                        static_cast<unsigned long long>(value.u));
+            }
+            break;
+
+         case Argument::Float:
+            snprintf(buffer, sizeof(buffer), (spec + ((strchr("eEfFgGaA", *c) != NULL) ? *c : 'g')).c_str(), value.d);
+            break;
+
+         case Argument::String:
+            snprintf(buffer, sizeof(buffer), (spec + "s").c_str(), &record.text[value.offset]);
+            break;
+
+         case Argument::Pointer:
+            snprintf(buffer, sizeof(buffer), "%p", value.p);
+            break;
+      }
+
+      result += buffer;
+   }
+
+   // Some of the older prints end with a newline of their own
+   if ((result.empty() == false) && (result[result.size() - 1] == '\n'))
+   {
+      result.erase(result.size() - 1);
+   }
+
+   return result;
+}
+
+
+uint64_t Log::Now()
+{
+   return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Log::Add(Record & record, double value)
+{
+   Slot(record, Argument::Float).d = value;
+}
+
+void Log::Add(Record & record, char const * value)
+{
+   Argument & argument = Slot(record, Argument::String);
+
+   if (value == NULL)
+   {
+      value = "(null)";
+   }
+
+   // Long strings are cut short rather than dropping the message
+   uint32_t const offset = std::min(record.used, TextSize - 1);
+   size_t   const length = std::min<size_t>(strlen(value), TextSize - 1 - offset);
+
+   argument.offset = offset;
+   memcpy(&record.text[offset], value, length);
+   record.text[offset + length] = '\0';
+   record.used = offset + length + 1;
+}
+
+void Log::Add(Record & record, void const * value)
+{
+   Slot(record, Argument::Pointer).p = value;
+}
+
+Log::Argument & Log::Slot(Record & record, Argument::Type type)
+{
+   Argument & argument = record.arguments[record.count];
+   argument.type = type;
+
+   if (record.count < MaxArguments)
+   {
+      ++record.count;
+   }
+
+   return argument;
+}
+
+
+void Log::Run()
+{
+   Main::Trace::NameThread("log");
+
+   for (bool running = true; (running == true); )
+   {
+      running = __atomic_load_n(&running_, __ATOMIC_SEQ_CST);
+
+      EventData Data;
+      Record    record;
+
+      while (queue_.TryPop(record) == true)
+      {
+         std::string const line = Format(record);
+
+         WriteFile(record, line);
+         Data.Uris().push_back((record.level == LogLevel::Debug) ? line : (std::string(LevelNames[record.level]) + ": " + line));
+      }
+
+      uint32_t const dropped = __atomic_exchange_n(&dropped_, 0, __ATOMIC_RELAXED);
+
+      if (dropped > 0)
+      {
+         Record missed;
+         missed.level = LogLevel::Warning;
+         missed.time  = Now();
+
+         std::string const line = std::to_string(dropped) + " log messages dropped";
+
+         WriteFile(missed, line);
+         Data.Uris().push_back(line);
+      }
+
+      // Once stopping there may be nothing left to take events from the queue
+      if ((running == true) && (Data.Uris().empty() == false))
+      {
+         Main::Vimpc::CreateEvent(Event::LogMessages, std::move(Data));
+      }
+
+      if (running == true)
+      {
+         queue_.Wait(100);
+      }
+   }
+}
+
+void Log::WriteFile(Record const & record, std::string const & line)
+{
+   UniqueLock<Mutex> Lock(fileMutex_);
+
+   if (file_.is_open() == false)
+   {
+      return;
+   }
+
+   time_t const seconds = static_cast<time_t>(record.time / (1000 * 1000));
+   struct tm    local;
+   char         stamp[32];
+
+   localtime_r(&seconds, &local);
+   size_t const length = strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+   snprintf(stamp + length, sizeof(stamp) - length, ".%03u", static_cast<uint32_t>((record.time / 1000) % 1000));
+
+   file_ << stamp << " " << LevelNames[record.level] << " " << line << "\n";
+   file_.flush();
+
+   fileBytes_ += strlen(stamp) + strlen(LevelNames[record.level]) + line.size() + 3;
+
+   // Keep one old log next to the current one
+   if ((fileMaxBytes_ > 0) && (fileBytes_ >= fileMaxBytes_))
+   {
+      file_.close();
+      rename(fileName_.c_str(), (fileName_ + ".1").c_str());
+      file_.open(fileName_.c_str(), std::ios::out | std::ios::trunc);
+      fileBytes_ = 0;
+   }
+}
+
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,190 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   log.hpp - leveled logging, formatted on a thread of its own
+   */
+
+#ifndef __MAIN__LOG
+#define __MAIN__LOG
+
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+#include "compiler.hpp"
+#include "eventqueue.hpp"
+
+namespace LogLevel
+{
+   enum Level
+   {
+      Error,
+      Warning,
+      Info,
+      Debug,
+      LevelCount
+   };
+}
+
+namespace Main
+{
+   //! Writing a message copies the format and its arguments into a lock free
+   //! queue, they are only formatted on the log thread. The formatted lines are
+   //! sent to the debug console and, if the logfile setting is set, to a file
+   //! which is rotated once it reaches logfilesize megabytes.
+   //!
+   //! The argument types are kept, so a format does not have to match them,
+   //! %d with a size_t or %s with a number both print what was passed
+   class Log
+   {
+      public:
+         static uint32_t const MaxArguments = 8;
+         static uint32_t const TextSize     = 256;
+
+         struct Argument
+         {
+            enum Type { Signed, Unsigned, Float, String, Pointer };
+
+            Type type;
+
+            union
+            {
+               int64_t      i;
+               uint64_t     u;
+               double       d;
+               uint32_t     offset;
+               void const * p;
+            };
+         };
+
+         //! Strings passed as arguments are copied into the text of the record
+         struct Record
+         {
+            Record() : level(LogLevel::Debug), time(0), format(""), count(0), used(0) { }
+
+            int          level;
+            uint64_t     time;
+            char const * format;
+            uint32_t     count;
+            uint32_t     used;
+            Argument     arguments[MaxArguments + 1]; // The last one takes any extra arguments
+            char         text[TextSize];
+         };
+
+      public:
+         static Log & Instance();
+
+         static bool Enabled(int level) { return (level <= __atomic_load_n(&level_, __ATOMIC_RELAXED)); }
+
+      protected:
+         Log();
+         ~Log();
+
+      private:
+         Log(Log const &);
+         Log & operator=(Log const &);
+
+      public:
+         //! The format must be a string literal
+         template <typename... Args>
+         void Write(int level, char const * format, Args const &... args)
+         {
+            // Never block the caller, just count what could not be kept
+            if (queue_.TryPush(Prepare(level, format, args...)) == false)
+            {
+               __atomic_add_fetch(&dropped_, 1, __ATOMIC_RELAXED);
+            }
+         }
+
+         //! Copies the arguments into a record ready to be formatted
+         template <typename... Args>
+         static Record Prepare(int level, char const * format, Args const &... args)
+         {
+            Record record;
+            record.level  = level;
+            record.time   = Now();
+            record.format = format;
+            Capture(record, args...);
+            return record;
+         }
+
+         //! One of error, warning, info or debug
+         void SetLevel(std::string const & level);
+
+         //! An empty file stops logging to a file
+         void SetFile(std::string const & file, uint64_t maxBytes);
+
+         //! Writes out anything still queued and stops the log thread
+         void Stop();
+
+         //! The message of a record without its time or level
+         static std::string Format(Record const & record);
+
+      private:
+         static uint64_t Now();
+
+         static void Capture(Record &) { }
+
+         template <typename T, typename... Rest>
+         static void Capture(Record & record, T const & value, Rest const &... rest)
+         {
+            Add(record, value);
+            Capture(record, rest...);
+         }
+
+         template <typename T>
+         static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+         Add(Record & record, T value)
+         {
+            if ((std::is_enum<T>::value == true) || (std::is_signed<T>::value == true))
+            {
+               Slot(record, Argument::Signed).i = static_cast<int64_t>(value);
+            }
+            else
+            {
+               Slot(record, Argument::Unsigned).u = static_cast<uint64_t>(value);
+            }
+         }
+
+         static void Add(Record & record, double value);
+         static void Add(Record & record, char const * value);
+         static void Add(Record & record, std::string const & value) { Add(record, value.c_str()); }
+         static void Add(Record & record, void const * value);
+         static Argument & Slot(Record & record, Argument::Type type);
+
+         void Run();
+         void WriteFile(Record const & record, std::string const & line);
+
+      private:
+         static int        level_;
+
+         EventQueue<Record> queue_;
+         uint32_t           dropped_;
+         bool               running_;
+         Thread             thread_;
+
+         Mutex              fileMutex_;
+         std::string        fileName_;
+         std::ofstream      file_;
+         uint64_t           fileBytes_;
+         uint64_t           fileMaxBytes_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,373 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   lyricscache.cpp - on disk cache of previously fetched lyrics
+   */
+
+#include "lyricscache.hpp"
+
+#include <algorithm>
+#include <ctype.h>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+#include <vector>
+
+#include "settings.hpp"
+#include "window/debug.hpp"
+
+static char const * const CacheHeader = "vimpc-lyrics";
+static char const * const CacheSuffix = ".lyrics";
+static char const * const StatusFound = "found";
+static char const * const StatusMissing = "missing";
+
+using namespace Main;
+
+LyricsCache::LyricsCache() :
+   opened_   (false),
+   directory_(""),
+   entries_  (),
+   size_     (0)
+{
+}
+
+LyricsCache::~LyricsCache()
+{
+}
+
+LyricsCache::Status LyricsCache::Lookup(std::string const & artist, std::string const & title, std::string & lyrics)
+{
+   UniqueLock<Mutex> Lock(mutex_);
+
+   if ((Enabled() == false) || (Open() == false))
+   {
+      return Unknown;
+   }
+
+   std::string const key  = Key(artist, title);
+   std::string const file = File(key);
+
+   // Only entries known to exist are read, so a miss never touches the disk
+   EntryMap::iterator const it = entries_.find(file);
+
+   if (it == entries_.end())
+   {
+      return Unknown;
+   }
+
+   std::string const path = directory_ + "/" + file;
+   std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+
+   std::string header, status, artistKey, titleKey;
+   time_t      stored = 0;
+
+   stream >> header >> status >> stored;
+   stream.ignore(1);
+   std::getline(stream, artistKey);
+   std::getline(stream, titleKey);
+
+   // A different song with the same hash, leave it for the other song
+   if ((stream.fail() == true) || (header != CacheHeader) || ((artistKey + "\n" + titleKey) != key))
+   {
+      return Unknown;
+   }
+
+   time_t const now = time(NULL);
+
+   if (status == StatusMissing)
+   {
+      time_t const ttl = static_cast<time_t>(atoi(Main::Settings::Instance().Get(Setting::LyricsMissTTL).c_str())) * 60 * 60;
+
+      if (now - stored >= ttl)
+      {
+         Remove(file);
+         return Unknown;
+      }
+
+      return Missing;
+   }
+
+   lyrics.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+   // Keep the modification time as the last use so that it survives restarts
+   utime(path.c_str(), NULL);
+   it->second.second = now;
+
+   Debug("Lyrics cache hit for %s", file.c_str());
+   return Found;
+}
+
+bool LyricsCache::Contains(std::string const & artist, std::string const & title)
+{
+   UniqueLock<Mutex> Lock(mutex_);
+
+   if ((Enabled() == false) || (Open() == false))
+   {
+      return false;
+   }
+
+   return (entries_.find(File(Key(artist, title))) != entries_.end());
+}
+
+void LyricsCache::Store(std::string const & artist, std::string const & title, std::string const & lyrics)
+{
+   Write(artist, title, StatusFound, lyrics);
+}
+
+void LyricsCache::StoreMissing(std::string const & artist, std::string const & title)
+{
+   Write(artist, title, StatusMissing, "");
+}
+
+std::string LyricsCache::Normalise(std::string const & value)
+{
+   // Case, punctuation and spacing differences between tags should not
+   // prevent a match, multibyte characters are kept as they are
+   std::string Result;
+   bool separator = false;
+
+   for (auto it = value.begin(); (it != value.end()); ++it)
+   {
+      unsigned char const c = static_cast<unsigned char>(*it);
+
+      if ((c >= 0x80) || (isalnum(c) != 0))
+      {
+         if ((separator == true) && (Result != ""))
+         {
+            Result += ' ';
+         }
+
+         Result   += static_cast<char>((c < 0x80) ? tolower(c) : c);
+         separator = false;
+      }
+      else
+      {
+         separator = true;
+      }
+   }
+
+   return Result;
+}
+
+
+bool LyricsCache::Enabled() const
+{
+   return (Main::Settings::Instance().Get(Setting::LyricsCache) == true);
+}
+
+bool LyricsCache::Open()
+{
+   std::string const directory = Directory();
+
+   if ((opened_ == true) && (directory == directory_))
+   {
+      return true;
+   }
+
+   opened_    = false;
+   directory_ = directory;
+   size_      = 0;
+   entries_.clear();
+
+   if (directory_ == "")
+   {
+      return false;
+   }
+
+   // Create each missing component of the path
+   for (size_t pos = directory_.find('/', 1); ; pos = directory_.find('/', pos + 1))
+   {
+      mkdir(directory_.substr(0, pos).c_str(), 0755);
+
+      if (pos == std::string::npos)
+      {
+         break;
+      }
+   }
+
+   DIR * dir = opendir(directory_.c_str());
+
+   if (dir == NULL)
+   {
+      Debug("Unable to open lyrics cache %s", directory_.c_str());
+      return false;
+   }
+
+   size_t const suffixLength = strlen(CacheSuffix);
+
+   for (struct dirent * entry = readdir(dir); (entry != NULL); entry = readdir(dir))
+   {
+      std::string const file(entry->d_name);
+      struct stat info;
+
+      if ((file.size() > suffixLength) && (file.compare(file.size() - suffixLength, suffixLength, CacheSuffix) == 0) &&
+          (stat((directory_ + "/" + file).c_str(), &info) == 0))
+      {
+         entries_[file] = Entry(info.st_size, info.st_mtime);
+         size_         += info.st_size;
+      }
+   }
+
+   closedir(dir);
+
+   Debug("Lyrics cache %s has %u entries", directory_.c_str(), static_cast<uint32_t>(entries_.size()));
+
+   opened_ = true;
+   return true;
+}
+
+void LyricsCache::Write(std::string const & artist, std::string const & title, std::string const & status, std::string const & lyrics)
+{
+   UniqueLock<Mutex> Lock(mutex_);
+
+   if ((Enabled() == false) || (Open() == false))
+   {
+      return;
+   }
+
+   std::string const key  = Key(artist, title);
+   std::string const file = File(key);
+   std::string const path = directory_ + "/" + file;
+   std::string const temp = path + ".tmp";
+   time_t      const now  = time(NULL);
+
+   {
+      std::ofstream stream(temp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+      stream << CacheHeader << " " << status << " " << now << "\n" << key << "\n" << lyrics;
+
+      if (stream.fail() == true)
+      {
+         Debug("Unable to write lyrics cache entry %s", temp.c_str());
+         return;
+      }
+   }
+
+   // Renaming means that a reader never sees a partially written entry
+   if (rename(temp.c_str(), path.c_str()) == 0)
+   {
+      struct stat info;
+
+      if (stat(path.c_str(), &info) == 0)
+      {
+         EntryMap::iterator const it = entries_.find(file);
+
+         if (it != entries_.end())
+         {
+            size_ -= it->second.first;
+         }
+
+         entries_[file] = Entry(info.st_size, now);
+         size_         += info.st_size;
+      }
+
+      Evict();
+   }
+   else
+   {
+      unlink(temp.c_str());
+   }
+}
+
+void LyricsCache::Remove(std::string const & file)
+{
+   EntryMap::iterator const it = entries_.find(file);
+
+   if (it != entries_.end())
+   {
+      unlink((directory_ + "/" + file).c_str());
+      size_ -= it->second.first;
+      entries_.erase(it);
+   }
+}
+
+void LyricsCache::Evict()
+{
+   uint64_t const limit = static_cast<uint64_t>(atoi(Main::Settings::Instance().Get(Setting::LyricsCacheSize).c_str())) * 1024 * 1024;
+
+   if (size_ > limit)
+   {
+      typedef std::pair<time_t, std::string> Use;
+      std::vector<Use> uses;
+
+      for (auto it = entries_.begin(); (it != entries_.end()); ++it)
+      {
+         uses.push_back(Use(it->second.second, it->first));
+      }
+
+      std::sort(uses.begin(), uses.end());
+
+      for (auto it = uses.begin(); ((it != uses.end()) && (size_ > limit)); ++it)
+      {
+         Debug("Evicting lyrics cache entry %s", it->second.c_str());
+         Remove(it->second);
+      }
+   }
+}
+
+
+std::string LyricsCache::Key(std::string const & artist, std::string const & title) const
+{
+   return Normalise(artist) + "\n" + Normalise(title);
+}
+
+std::string LyricsCache::File(std::string const & key) const
+{
+   // 64 bit FNV-1a
+   uint64_t hash = 14695981039346656037ULL;
+
+   for (auto it = key.begin(); (it != key.end()); ++it)
+   {
+      hash ^= static_cast<unsigned char>(*it);
+      hash *= 1099511628211ULL;
+   }
+
+   char name[32];
+   snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+
+   return std::string(name) + CacheSuffix;
+}
+
+std::string LyricsCache::Directory() const
+{
+   std::string directory = Main::Settings::Instance().Get(Setting::LyricsCacheDir);
+
+   if (directory == "")
+   {
+      char const * const cache = getenv("XDG_CACHE_HOME");
+      char const * const home  = getenv("HOME");
+
+      if ((cache != NULL) && (*cache != '\0'))
+      {
+         directory = std::string(cache) + "/vimpc/lyrics";
+      }
+      else if (home != NULL)
+      {
+         directory = std::string(home) + "/.cache/vimpc/lyrics";
+      }
+   }
+
+   return directory;
+}
+
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,86 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   lyricscache.hpp - on disk cache of previously fetched lyrics
+   */
+
+#ifndef __MAIN__LYRICSCACHE
+#define __MAIN__LYRICSCACHE
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+
+#include "compiler.hpp"
+
+namespace Main
+{
+   //! Each entry is a file named by a hash of the normalised artist and title,
+   //! songs for which no lyrics could be found are remembered for a limited time
+   class LyricsCache
+   {
+      public:
+         typedef enum
+         {
+            Unknown,  // Not in the cache, the lyrics need to be fetched
+            Found,
+            Missing   // Recently looked for and not found
+         } Status;
+
+      public:
+         LyricsCache();
+         ~LyricsCache();
+
+      private:
+         LyricsCache(LyricsCache const &);
+         LyricsCache & operator=(LyricsCache const &);
+
+      public:
+         Status Lookup(std::string const & artist, std::string const & title, std::string & lyrics);
+         bool Contains(std::string const & artist, std::string const & title);
+         void Store(std::string const & artist, std::string const & title, std::string const & lyrics);
+         void StoreMissing(std::string const & artist, std::string const & title);
+
+      public:
+         static std::string Normalise(std::string const & value);
+
+      private:
+         typedef std::pair<uint64_t, time_t> Entry; // size, last used
+         typedef std::map<std::string, Entry> EntryMap;
+
+         bool Enabled() const;
+         bool Open();
+         void Write(std::string const & artist, std::string const & title, std::string const & status, std::string const & lyrics);
+         void Remove(std::string const & file);
+         void Evict();
+
+         std::string Key(std::string const & artist, std::string const & title) const;
+         std::string File(std::string const & key) const;
+         std::string Directory() const;
+
+      private:
+         Mutex       mutex_;
+         bool        opened_;
+         std::string directory_;
+         EntryMap    entries_;
+         uint64_t    size_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
@@ -19,16 +19,36 @@
  ***************************************************************************/
 
 #include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <strings.h>
+#include <sys/time.h>
 #include <vector>
 
 #include "project.hpp"
 #include "lyricsfetcher.hpp"
 #include "regex.hpp"
+#include "window/debug.hpp"
 
 namespace Curl
 {
+	static unsigned long max_speed = 0;
+
+	void setMaxSpeed(unsigned long bytes_per_second)
+	{
+		max_speed = bytes_per_second;
+	}
+
+	static Mutex proxy_mutex;
+	static std::string proxy;
+
+	void setProxy(const std::string &url)
+	{
+		UniqueLock<Mutex> Lock(proxy_mutex);
+		proxy = url;
+	}
+
 	size_t write_data(char *buffer, size_t size, size_t nmemb, void *data)
 	{
 		size_t result = size*nmemb;
@@ -36,13 +56,110 @@ namespace Curl
 		return result;
 	}
 
-	CURLcode perform(std::string &data, const std::string &URL, const std::string &referer, bool follow_redirect, unsigned timeout)
+	size_t write_extract(char *buffer, size_t size, size_t nmemb, void *extractor)
 	{
-		CURLcode result;
-		CURL *c = curl_easy_init();
+		size_t result = size*nmemb;
+		// writing less than was given stops the transfer
+		if (static_cast<HtmlExtractor *>(extractor)->feed(buffer, result))
+			return 0;
+		return result;
+	}
+
+	Pool &Pool::instance()
+	{
+		static Pool pool;
+		return pool;
+	}
+
+	Pool::Pool() : m_share(curl_share_init()), m_transfers(0), m_reused(0)
+	{
+		curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, &Pool::lock);
+		curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, &Pool::unlock);
+		curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+		curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+		curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+	}
+
+	Pool::~Pool()
+	{
+		for (auto it = m_idle.begin(); it != m_idle.end(); ++it)
+			curl_easy_cleanup(*it);
+		curl_share_cleanup(m_share);
+	}
+
+	CURL *Pool::acquire()
+	{
+		UniqueLock<Mutex> Lock(m_mutex);
+
+		if (m_idle.empty())
+		{
+			CURL *c = curl_easy_init();
+			curl_easy_setopt(c, CURLOPT_SHARE, m_share);
+			return c;
+		}
+
+		CURL *c = m_idle.back();
+		m_idle.pop_back();
+		return c;
+	}
+
+	void Pool::release(CURL *c)
+	{
+		// each handle also keeps its own connections open, so only a few are kept
+		static const size_t max_idle = 8;
+
+		UniqueLock<Mutex> Lock(m_mutex);
+
+		if (m_idle.size() < max_idle)
+			m_idle.push_back(c);
+		else
+			curl_easy_cleanup(c);
+	}
+
+	void Pool::reset(CURL *c)
+	{
+		curl_easy_reset(c);
+		curl_easy_setopt(c, CURLOPT_SHARE, m_share);
+	}
+
+	void Pool::record(CURL *c)
+	{
+		long connects = 0;
+		curl_easy_getinfo(c, CURLINFO_NUM_CONNECTS, &connects);
+
+		UniqueLock<Mutex> Lock(m_mutex);
+		++m_transfers;
+		if (connects == 0)
+			++m_reused;
+	}
+
+	void Pool::lock(CURL *, curl_lock_data data, curl_lock_access, void *pool)
+	{
+		static_cast<Pool *>(pool)->m_locks[data].lock();
+	}
+
+	void Pool::unlock(CURL *, curl_lock_data data, void *pool)
+	{
+		static_cast<Pool *>(pool)->m_locks[data].unlock();
+	}
+
+	void prepare(CURL *c, std::string &data, const std::string &URL, const std::string &referer, bool follow_redirect, unsigned timeout, HtmlExtractor *extractor)
+	{
+		Pool::instance().reset(c);
 		curl_easy_setopt(c, CURLOPT_URL, URL.c_str());
-		curl_easy_setopt(c, CURLOPT_WRITEFUNCTION, write_data);
-		curl_easy_setopt(c, CURLOPT_WRITEDATA, &data);
+		if (extractor && extractor->enabled())
+		{
+			curl_easy_setopt(c, CURLOPT_WRITEFUNCTION, write_extract);
+			curl_easy_setopt(c, CURLOPT_WRITEDATA, extractor);
+		}
+		else
+		{
+			curl_easy_setopt(c, CURLOPT_WRITEFUNCTION, write_data);
+			curl_easy_setopt(c, CURLOPT_WRITEDATA, &data);
+		}
 		curl_easy_setopt(c, CURLOPT_CONNECTTIMEOUT, timeout);
 		curl_easy_setopt(c, CURLOPT_NOSIGNAL, 1);
 		curl_easy_setopt(c, CURLOPT_USERAGENT, "vimpc");
@@ -50,11 +167,37 @@ namespace Curl
 		curl_easy_setopt(c, CURLOPT_FOLLOWLOCATION, 1L);
 		if (!referer.empty())
 			curl_easy_setopt(c, CURLOPT_REFERER, referer.c_str());
+		if (max_speed > 0)
+			curl_easy_setopt(c, CURLOPT_MAX_RECV_SPEED_LARGE, static_cast<curl_off_t>(max_speed));
+
+		UniqueLock<Mutex> Lock(proxy_mutex);
+		if (!proxy.empty())
+		{
+			curl_easy_setopt(c, CURLOPT_PROXY, proxy.c_str());
+			curl_easy_setopt(c, CURLOPT_NOPROXY, "");
+		}
+	}
+
+	CURLcode perform(std::string &data, const std::string &URL, const std::string &referer, bool follow_redirect, unsigned timeout, HtmlExtractor *extractor)
+	{
+		CURLcode result;
+		CURL *c = Pool::instance().acquire();
+		prepare(c, data, URL, referer, follow_redirect, timeout, extractor);
 		result = curl_easy_perform(c);
-		curl_easy_cleanup(c);
+		if (succeeded(result, extractor))
+		{
+			Pool::instance().record(c);
+			result = CURLE_OK;
+		}
+		Pool::instance().release(c);
 		return result;
 	}
 
+	bool succeeded(CURLcode code, const HtmlExtractor *extractor)
+	{
+		return (code == CURLE_OK) || (code == CURLE_WRITE_ERROR && extractor && extractor->complete());
+	}
+
 	std::string escape(const std::string &s)
 	{
 		char *cs = curl_easy_escape(0, s.c_str(), s.length());
@@ -66,6 +209,7 @@ namespace Curl
 
 LyricsFetcher *lyricsPlugins[] =
 {
+	new LrclibFetcher(),
 	new LyricwikiFetcher(),
 	new AzLyricsFetcher(),
 	new Sing365Fetcher(),
@@ -78,37 +222,187 @@ LyricsFetcher *lyricsPlugins[] =
 
 const char LyricsFetcher::msgNotFound[] = "Not found";
 
+HtmlExtractor::HtmlExtractor(const std::vector<std::string> &start, const std::string &end)
+	: m_start(start), m_end(end), m_marker(0), m_searched(0), m_complete(false)
+{
+}
+
+bool HtmlExtractor::feed(const char *data, size_t length)
+{
+	if (m_complete)
+		return true;
+
+	m_buffer.append(data, length);
+
+	for (; m_marker < m_start.size(); ++m_marker)
+	{
+		const std::string &marker = m_start[m_marker];
+		size_t i = m_buffer.find(marker);
+
+		if (i == std::string::npos)
+		{
+			// only keep enough to find a marker split between two writes
+			if (m_buffer.size() >= marker.size())
+				m_buffer.erase(0, m_buffer.size() - marker.size() + 1);
+			return false;
+		}
+
+		m_buffer.erase(0, i + marker.size());
+		m_searched = 0;
+	}
+
+	size_t from = (m_searched >= m_end.size()) ? m_searched - m_end.size() + 1 : 0;
+	size_t i = m_buffer.find(m_end, from);
+
+	if (i == std::string::npos)
+	{
+		m_searched = m_buffer.size();
+		return false;
+	}
+
+	m_buffer.resize(i);
+	m_complete = true;
+	return true;
+}
+
+namespace
+{
+	unsigned long millisecondsSince(const timeval &start)
+	{
+		timeval end;
+		gettimeofday(&end, NULL);
+		return (end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000;
+	}
+
+	void appendUtf8(std::string &s, unsigned long n)
+	{
+		if (n >= 0x10000)
+		{
+			s += (0xf0 | ((n >> 18) & 0x07));
+			s += (0x80 | ((n >> 12) & 0x3f));
+			s += (0x80 | ((n >> 6) & 0x3f));
+			s += (0x80 | (n & 0x3f));
+		}
+		else if (n >= 0x800)
+		{
+			s += (0xe0 | ((n >> 12) & 0x0f));
+			s += (0x80 | ((n >> 6) & 0x3f));
+			s += (0x80 | (n & 0x3f));
+		}
+		else if (n >= 0x80)
+		{
+			s += (0xc0 | ((n >> 6) & 0x1f));
+			s += (0x80 | (n & 0x3f));
+		}
+		else
+			s += n;
+	}
+
+	// finds "key":"value" in a json document and unescapes the value
+	bool jsonString(const std::string &data, const std::string &key, std::string &value)
+	{
+		size_t i = data.find("\"" + key + "\":\"");
+		if (i == std::string::npos)
+			return false;
+
+		value.clear();
+		for (i += key.length() + 4; i < data.length() && data[i] != '"'; ++i)
+		{
+			if (data[i] != '\\' || i + 1 >= data.length())
+			{
+				value += data[i];
+				continue;
+			}
+
+			switch (data[++i])
+			{
+				case 'n': value += '\n'; break;
+				case 'r': value += '\r'; break;
+				case 't': value += '\t'; break;
+				case 'b': value += '\b'; break;
+				case 'f': value += '\f'; break;
+				case 'u':
+				{
+					unsigned long n = strtoul(data.substr(i + 1, 4).c_str(), 0, 16);
+					i += 4;
+					// characters outside the basic plane are written as two surrogates
+					if (n >= 0xd800 && n < 0xdc00 && i + 1 < data.length() && data.compare(i + 1, 2, "\\u") == 0)
+					{
+						unsigned long low = strtoul(data.substr(i + 3, 4).c_str(), 0, 16);
+						n = 0x10000 + ((n - 0xd800) << 10) + (low - 0xdc00);
+						i += 6;
+					}
+					appendUtf8(value, n);
+					break;
+				}
+				default: value += data[i]; break;
+			}
+		}
+		return i < data.length();
+	}
+}
+
 LyricsFetcher::Result LyricsFetcher::fetch(const std::string &artist, const std::string &title)
 {
 	Result result;
-	result.first = false;
+	Request request = begin(artist, title);
+
+	timeval start;
+	gettimeofday(&start, NULL);
+
+	for (;;)
+	{
+		std::string data;
+		CURLcode code = Curl::perform(data, request.url, request.referer, request.follow_redirect, 10, &request.extractor);
+
+		if (code != CURLE_OK)
+		{
+			result.first = false;
+			result.second = curl_easy_strerror(code);
+			break;
+		}
 
+		if (next(request, data, result))
+			break;
+	}
+
+	record(result.first, millisecondsSince(start));
+	return result;
+}
+
+LyricsFetcher::Request LyricsFetcher::begin(const std::string &artist, const std::string &title)
+{
 	Regex::RE artist_exp("%artist%");
 	Regex::RE title_exp("%title%");
 
-	std::string url = urlTemplate();
+	Request request;
+	request.url = urlTemplate();
+	request.extractor = extractor();
 
-	artist_exp.ReplaceAll(artist, url);
-	title_exp.ReplaceAll(title, url);
+	artist_exp.ReplaceAll(artist, request.url);
+	title_exp.ReplaceAll(title, request.url);
+	return request;
+}
 
+bool LyricsFetcher::next(Request &request, const std::string &page, Result &result)
+{
 	std::string data;
-	CURLcode code = Curl::perform(data, url);
+	result.first = false;
 
-	if (code != CURLE_OK)
-	{
-		result.second = curl_easy_strerror(code);
-		return result;
-	}
+	std::vector<std::string> lyrics;
 
-	auto lyrics = getContent(regex(), data);
+	// a streamed page was only kept from the start to the end marker
+	if (request.extractor.complete())
+		lyrics.push_back(request.extractor.content());
+	else if (!request.extractor.enabled())
+		lyrics = getContent(regex(), page);
 
-	if (lyrics.empty() || notLyrics(data))
+	if (lyrics.empty() || notLyrics(request.extractor.enabled() ? request.extractor.content() : page))
 	{
 		result.second = msgNotFound;
-		return result;
+		return true;
 	}
 
-	data.clear();
 	for (auto it = lyrics.begin(); it != lyrics.end(); ++it)
 	{
 		postProcess(*it);
@@ -122,7 +416,15 @@ LyricsFetcher::Result LyricsFetcher::fetch(const std::string &artist, const std:
 
 	result.second = data;
 	result.first = true;
-	return result;
+	return true;
+}
+
+void LyricsFetcher::record(bool hit, unsigned long ms)
+{
+	++m_stats.attempts;
+	m_stats.total_ms += ms;
+	if (hit)
+		++m_stats.hits;
 }
 
 std::vector<std::string> LyricsFetcher::getContent(std::string regex_, const std::string &data)
@@ -130,7 +432,8 @@ std::vector<std::string> LyricsFetcher::getContent(std::string regex_, const std
 	std::string match;
 	std::string input = data.c_str();
 	std::vector<std::string> result;
-	Regex::RE regex(regex_);
+	// pages are matched as a whole, the lyrics nearly always span several lines
+	Regex::RE regex(regex_, Regex::DotAll);
 
 	while (regex.Capture(input, &match))
 	{
@@ -143,53 +446,59 @@ std::vector<std::string> LyricsFetcher::getContent(std::string regex_, const std
 
 void LyricsFetcher::postProcess(std::string &data)
 {
-	stripHtmlTags(data);
-	Regex::RE::Trim(data);
+	data = htmlToText(data.data(), data.size(), textOptions());
 }
 
 /***********************************************************************/
 
-LyricsFetcher::Result LyricwikiFetcher::fetch(const std::string &artist, const std::string &title)
+bool LyricwikiFetcher::next(Request &request, const std::string &page, Result &result)
 {
-	LyricsFetcher::Result result = LyricsFetcher::fetch(artist, title);
-	if (result.first == true)
+	if (request.step == 0)
 	{
-		Regex::RE br("<br />");
+		// the api gives the url of the page with the lyrics on it
+		LyricsFetcher::next(request, page, result);
 
-		result.first = false;
-		std::string data;
-		CURLcode code = Curl::perform(data, result.second, "", true);
-
-		if (code != CURLE_OK)
+		if (result.first == true)
 		{
-			result.second = curl_easy_strerror(code);
-			return result;
+			request.step = 1;
+			request.url = result.second;
+			request.referer = "";
+			request.follow_redirect = true;
+			request.extractor = HtmlExtractor({ "<div class='lyricbox'><script>", "</script>" }, "<!--");
+			return false;
 		}
+	}
+	else
+	{
+		std::string data;
+		result.first = false;
+
+		std::vector<std::string> lyrics;
 
-		auto lyrics = getContent("<div class='lyricbox'><script>.*?</script>(.*?)<!--", data);
+		if (request.extractor.complete())
+			lyrics.push_back(request.extractor.content());
+		else if (!request.extractor.enabled())
+			lyrics = getContent("<div class='lyricbox'><script>.*?</script>(.*?)<!--", page);
 
 		if (lyrics.empty())
 		{
 			result.second = msgNotFound;
-			return result;
+			return true;
 		}
-		std::transform(lyrics.begin(), lyrics.end(), lyrics.begin(), unescapeHtmlUtf8);
+		std::transform(lyrics.begin(), lyrics.end(), lyrics.begin(), [](const std::string &s) {
+			return htmlToText(s.data(), s.size(), HtmlBreakLines);
+		});
 		bool license_restriction = std::any_of(lyrics.begin(), lyrics.end(), [](const std::string &s) {
 			return s.find("Unfortunately, we are not licensed to display the full lyrics for this song at the moment.") != std::string::npos;
 		});
 		if (license_restriction)
 		{
 			result.second = "License restriction";
-			return result;
+			return true;
 		}
 
-		data.clear();
 		for (auto it = lyrics.begin(); it != lyrics.end(); ++it)
 		{
-			br.ReplaceAll("\n", *it);
-
-			stripHtmlTags(*it);
-			Regex::RE::Trim(*it);
 			if (!it->empty())
 			{
 				data += *it;
@@ -201,7 +510,7 @@ LyricsFetcher::Result LyricwikiFetcher::fetch(const std::string &artist, const s
 		result.second = data;
 		result.first = true;
 	}
-	return result;
+	return true;
 }
 
 bool LyricwikiFetcher::notLyrics(const std::string &data)
@@ -211,11 +520,32 @@ bool LyricwikiFetcher::notLyrics(const std::string &data)
 
 /**********************************************************************/
 
-LyricsFetcher::Result GoogleLyricsFetcher::fetch(const std::string &artist, const std::string &title)
+LyricsFetcher::Request LrclibFetcher::begin(const std::string &artist, const std::string &title)
 {
-	Result result;
-	result.first = false;
+	Request request = LyricsFetcher::begin(artist, title);
+	request.follow_redirect = true;
+	return request;
+}
+
+bool LrclibFetcher::next(Request &, const std::string &data, Result &result)
+{
+	std::string lyrics;
 
+	// only the plain lyrics are known for some songs
+	if (!jsonString(data, "syncedLyrics", lyrics) || lyrics.empty())
+		jsonString(data, "plainLyrics", lyrics);
+
+	Regex::RE::Trim(lyrics);
+
+	result.first = !lyrics.empty();
+	result.second = result.first ? lyrics : msgNotFound;
+	return true;
+}
+
+/**********************************************************************/
+
+LyricsFetcher::Request GoogleLyricsFetcher::begin(const std::string &artist, const std::string &title)
+{
 	std::string search_str = artist;
 	search_str += "+";
 	search_str += title;
@@ -226,27 +556,32 @@ LyricsFetcher::Result GoogleLyricsFetcher::fetch(const std::string &artist, cons
 	google_url += search_str;
 	google_url += "&btnI=I%27m+Feeling+Lucky";
 
-	std::string data;
-	CURLcode code = Curl::perform(data, google_url, google_url);
+	Request request;
+	request.url = google_url;
+	request.referer = google_url;
+	return request;
+}
 
-	if (code != CURLE_OK)
-	{
-		result.second = curl_easy_strerror(code);
-		return result;
-	}
+bool GoogleLyricsFetcher::next(Request &request, const std::string &page, Result &result)
+{
+	if (request.step > 0)
+		return LyricsFetcher::next(request, page, result);
 
-	auto urls = getContent("<A HREF=\"(.*?)\">here</A>", data);
+	result.first = false;
+
+	auto urls = getContent("<A HREF=\"(.*?)\">here</A>", page);
 
 	if (urls.empty() || !isURLOk(urls[0]))
 	{
 		result.second = msgNotFound;
-		return result;
+		return true;
 	}
 
-	data = unescapeHtmlUtf8(urls[0]);
+	URL = unescapeHtmlUtf8(urls[0]);
 
-	URL = data.c_str();
-	return LyricsFetcher::fetch("", "");
+	request = LyricsFetcher::begin("", "");
+	request.step = 1;
+	return false;
 }
 
 bool GoogleLyricsFetcher::isURLOk(const std::string &url)
@@ -256,34 +591,6 @@ bool GoogleLyricsFetcher::isURLOk(const std::string &url)
 
 /**********************************************************************/
 
-void Sing365Fetcher::postProcess(std::string &data)
-{
-	// throw away ad
-	Regex::RE regex("<div.*</div>");
-	while (regex.Matches(data))
-	{
-		regex.Replace("", data);
-	}
-	LyricsFetcher::postProcess(data);
-}
-
-/**********************************************************************/
-
-void MetrolyricsFetcher::postProcess(std::string &data)
-{
-	// some of lyrics have both \n chars and <br />, html tags
-	// are always present whereas \n chars are not, so we need to
-	// throw them away to avoid having line breaks doubled.
-	Regex::RE end("&#10;");
-	Regex::RE br("<br />");
-
-	end.ReplaceAll("", data);
-	br.ReplaceAll("\n", data);
-
-	data = unescapeHtmlUtf8(data);
-	LyricsFetcher::postProcess(data);
-}
-
 bool MetrolyricsFetcher::isURLOk(const std::string &url)
 {
 	// it sometimes return link to sitemap.xml, which is huge so we need to discard it
@@ -292,14 +599,13 @@ bool MetrolyricsFetcher::isURLOk(const std::string &url)
 
 /**********************************************************************/
 
-LyricsFetcher::Result InternetLyricsFetcher::fetch(const std::string &artist, const std::string &title)
+bool InternetLyricsFetcher::next(Request &request, const std::string &page, Result &result)
 {
-	GoogleLyricsFetcher::fetch(artist, title);
-	LyricsFetcher::Result result;
+	GoogleLyricsFetcher::next(request, page, result);
 	result.first = false;
 	result.second = "The following site may contain lyrics for this song: ";
 	result.second += URL;
-	return result;
+	return true;
 }
 
 bool InternetLyricsFetcher::isURLOk(const std::string &url)
@@ -308,6 +614,164 @@ bool InternetLyricsFetcher::isURLOk(const std::string &url)
 	return false;
 }
 
+/**********************************************************************/
+
+namespace
+{
+	struct Transfer
+	{
+		Transfer() : fetcher(0), handle(0), done(false) { }
+
+		LyricsFetcher *fetcher;
+		LyricsFetcher::Request request;
+		LyricsFetcher::Result result;
+		std::string data;
+		CURL *handle;
+		bool done;
+		timeval start;
+	};
+
+	void startTransfer(CURLM *multi, Transfer &transfer)
+	{
+		transfer.data.clear();
+		Curl::prepare(transfer.handle, transfer.data, transfer.request.url, transfer.request.referer, transfer.request.follow_redirect, 10, &transfer.request.extractor);
+		curl_easy_setopt(transfer.handle, CURLOPT_PRIVATE, &transfer);
+		curl_multi_add_handle(multi, transfer.handle);
+	}
+
+	void finishTransfer(CURLM *multi, Transfer &transfer, CURLcode code)
+	{
+		curl_multi_remove_handle(multi, transfer.handle);
+
+		if (Curl::succeeded(code, &transfer.request.extractor))
+		{
+			Curl::Pool::instance().record(transfer.handle);
+			code = CURLE_OK;
+		}
+
+		if (code != CURLE_OK)
+		{
+			transfer.result.first = false;
+			transfer.result.second = curl_easy_strerror(code);
+			transfer.done = true;
+		}
+		else
+		{
+			transfer.done = transfer.fetcher->next(transfer.request, transfer.data, transfer.result);
+		}
+
+		if (transfer.done)
+			transfer.fetcher->record(transfer.result.first, millisecondsSince(transfer.start));
+		else
+			startTransfer(multi, transfer);
+	}
+}
+
+LyricsFetcher::Result fetchLyricsConcurrently(const std::string &artist, const std::string &title, bool &missing)
+{
+	std::vector<Transfer> transfers;
+	LyricsFetcher::Result result(false, LyricsFetcher::msgNotFound);
+	CURLM *multi = curl_multi_init();
+
+	for (LyricsFetcher **plugin = lyricsPlugins; *plugin != 0; ++plugin)
+		transfers.push_back(Transfer());
+
+	// transfers must not move once their buffers are handed to curl
+	size_t i = 0;
+	for (LyricsFetcher **plugin = lyricsPlugins; *plugin != 0; ++plugin, ++i)
+	{
+		Transfer &transfer = transfers[i];
+		transfer.fetcher = *plugin;
+		transfer.request = (*plugin)->begin(artist, title);
+		transfer.handle = Curl::Pool::instance().acquire();
+		gettimeofday(&transfer.start, NULL);
+		startTransfer(multi, transfer);
+	}
+
+	int winner = -1;
+	bool finished = transfers.empty();
+
+	while (!finished)
+	{
+		int running = 0;
+		curl_multi_perform(multi, &running);
+
+		CURLMsg *message;
+		int queued;
+		while ((message = curl_multi_info_read(multi, &queued)) != 0)
+		{
+			if (message->msg == CURLMSG_DONE)
+			{
+				Transfer *transfer = 0;
+				curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+				finishTransfer(multi, *transfer, message->data.result);
+			}
+		}
+
+		// take the first plugin with lyrics, but only once every plugin before it has failed
+		finished = true;
+		for (i = 0; i < transfers.size(); ++i)
+		{
+			if (!transfers[i].done)
+			{
+				finished = false;
+				break;
+			}
+			else if (transfers[i].result.first)
+			{
+				winner = i;
+				break;
+			}
+		}
+
+		if (!finished && winner < 0)
+			curl_multi_wait(multi, 0, 0, 100, 0);
+		else
+			finished = true;
+	}
+
+	missing = false;
+
+	for (i = 0; i < transfers.size(); ++i)
+	{
+		Transfer &transfer = transfers[i];
+
+		if (!transfer.done)
+		{
+			curl_multi_remove_handle(multi, transfer.handle);
+			transfer.fetcher->recordCancelled();
+		}
+
+		Curl::Pool::instance().release(transfer.handle);
+
+		missing = missing || (transfer.done && transfer.result.second == LyricsFetcher::msgNotFound);
+	}
+
+	curl_multi_cleanup(multi);
+
+	if (winner >= 0)
+		result = transfers[winner].result;
+	else if (!transfers.empty())
+		result = transfers.back().result;
+
+	return result;
+}
+
+void debugLyricsStats()
+{
+	const Curl::Pool &pool = Curl::Pool::instance();
+	Debug("Lyrics connections: %u of %u transfers reused a connection (%u%%)",
+		pool.reused(), pool.transfers(), (pool.transfers() > 0) ? (100 * pool.reused()) / pool.transfers() : 0);
+
+	for (LyricsFetcher **plugin = lyricsPlugins; *plugin != 0; ++plugin)
+	{
+		const LyricsFetcher::Stats &stats = (*plugin)->stats();
+		Debug("Lyrics from %s: %u of %u found, %lums average, %u cancelled",
+			(*plugin)->name().c_str(), stats.hits, stats.attempts,
+			(stats.attempts > 0) ? stats.total_ms / stats.attempts : 0, stats.cancelled);
+	}
+}
+
 std::string unescapeHtmlUtf8(const std::string &data)
 {
 	std::string result;
@@ -372,3 +836,111 @@ void stripHtmlTags(std::string &s)
 			s[i] = ' ';
 	}
 }
+
+namespace
+{
+	bool tagIs(const char *tag, size_t length, const char *name)
+	{
+		size_t n = strlen(name);
+		return length > n && strncasecmp(tag, name, n) == 0 && !isalnum(static_cast<unsigned char>(tag[n]));
+	}
+}
+
+std::string htmlToText(const char *html, size_t length, unsigned options)
+{
+	struct Entity { const char *name; char value; };
+	static const Entity entities[] =
+	{
+		{ "amp", '&' }, { "quot", '"' }, { "apos", '\'' }, { "nbsp", ' ' }, { "lt", '<' }, { "gt", '>' }, { 0, 0 }
+	};
+
+	std::string result;
+	result.reserve(length);
+	unsigned divs = 0;
+
+	for (size_t i = 0; i < length; )
+	{
+		char c = html[i];
+
+		if (c == '<')
+		{
+			const char *close = static_cast<const char *>(memchr(html + i, '>', length - i));
+			size_t end = close ? (close - html) + 1 : length;
+			const char *tag = html + i + 1;
+			size_t tag_length = end - i - 1;
+
+			if ((options & HtmlSkipDivs) && tagIs(tag, tag_length, "div"))
+				++divs;
+			else if ((options & HtmlSkipDivs) && divs > 0 && tagIs(tag, tag_length, "/div"))
+				--divs;
+			else if ((options & HtmlBreakLines) && divs == 0 && tagIs(tag, tag_length, "br"))
+				result += '\n';
+
+			i = end;
+			continue;
+		}
+
+		if (divs > 0)
+		{
+			++i;
+			continue;
+		}
+
+		if (c == '&')
+		{
+			const char *semicolon = static_cast<const char *>(memchr(html + i, ';', std::min<size_t>(length - i, 12)));
+
+			if (semicolon && i + 1 < length && html[i+1] == '#')
+			{
+				char *end;
+				bool hex = (i + 2 < length) && (html[i+2] == 'x' || html[i+2] == 'X');
+				unsigned long n = strtoul(html + i + (hex ? 3 : 2), &end, hex ? 16 : 10);
+
+				if (end == semicolon)
+				{
+					if (n != '\n' || !(options & HtmlSkipEncodedNewlines))
+						appendUtf8(result, n);
+					i = semicolon - html + 1;
+					continue;
+				}
+			}
+			else if (semicolon)
+			{
+				const Entity *entity = entities;
+				size_t name_length = semicolon - html - i - 1;
+
+				for (; entity->name; ++entity)
+					if (strlen(entity->name) == name_length && strncmp(entity->name, html + i + 1, name_length) == 0)
+						break;
+
+				if (entity->name)
+				{
+					result += entity->value;
+					i = semicolon - html + 1;
+					continue;
+				}
+			}
+		}
+
+		if (c == '\r')
+		{
+			// windows line endings
+			result += '\n';
+			if (i + 1 < length && html[i+1] == '\n')
+				++i;
+		}
+		else if (c == '\t')
+			result += ' ';
+		else
+			result += c;
+
+		++i;
+	}
+
+	size_t first = result.find_first_not_of(" \n\r\t\f\v");
+	if (first == std::string::npos)
+		return std::string();
+	result.erase(result.find_last_not_of(" \n\r\t\f\v") + 1);
+	result.erase(0, first);
+	return result;
+}
@@ -23,50 +23,197 @@
 
 #include <curl/curl.h>
 #include <string>
+#include <vector>
+
+#include "compiler.hpp"
+
+// finds the lyrics in a page while it is still being downloaded, each start
+// marker is looked for after the previous one and the lyrics run up to the end marker
+class HtmlExtractor
+{
+public:
+	HtmlExtractor() : m_marker(0), m_searched(0), m_complete(false) { }
+	HtmlExtractor(const std::vector<std::string> &start, const std::string &end);
+
+	bool enabled() const { return !m_end.empty(); }
+
+	// returns true once the end marker has been found, nothing more needs to be read
+	bool feed(const char *data, size_t length);
+
+	bool complete() const { return m_complete; }
+	const std::string &content() const { return m_buffer; }
+
+private:
+	std::vector<std::string> m_start;
+	std::string m_end;
+	std::string m_buffer;
+	size_t m_marker;
+	size_t m_searched;
+	bool m_complete;
+};
+
+enum HtmlTextOptions
+{
+	HtmlBreakLines = 1,          // <br> tags become new lines
+	HtmlSkipEncodedNewlines = 2, // &#10; is dropped rather than becoming a new line
+	HtmlSkipDivs = 4             // everything inside a <div> is dropped
+};
+
+// strips tags, decodes entities, fixes line endings and trims the result in one pass
+std::string htmlToText(const char *html, size_t length, unsigned options = 0);
 
 namespace Curl
 {
-	CURLcode perform(std::string &data, const std::string &URL, const std::string &referer = "", bool follow_redirect = false, unsigned timeout = 10);
+	// easy handles are kept between transfers, along with a share handle for dns,
+	// connections and tls sessions, so fetches do not have to set up connections again
+	class Pool
+	{
+	public:
+		static Pool &instance();
+
+		CURL *acquire();
+		void release(CURL *c);
+
+		// puts the handle back to its default options, but still using the share
+		void reset(CURL *c);
+
+		// called after each completed transfer to count connection reuse
+		void record(CURL *c);
+		unsigned transfers() const { return m_transfers; }
+		unsigned reused() const { return m_reused; }
+
+	private:
+		Pool();
+		~Pool();
+
+		static void lock(CURL *, curl_lock_data data, curl_lock_access, void *pool);
+		static void unlock(CURL *, curl_lock_data data, void *pool);
+
+		CURLSH *m_share;
+		std::vector<CURL *> m_idle;
+		unsigned m_transfers;
+		unsigned m_reused;
+		Mutex m_mutex;
+		Mutex m_locks[CURL_LOCK_DATA_LAST];
+	};
+
+	// with an extractor the page is not kept, the transfer stops once the extractor is complete
+	CURLcode perform(std::string &data, const std::string &URL, const std::string &referer = "", bool follow_redirect = false, unsigned timeout = 10, HtmlExtractor *extractor = 0);
+
+	// sets up an easy handle that appends the page to data, or feeds it to the extractor
+	void prepare(CURL *c, std::string &data, const std::string &URL, const std::string &referer = "", bool follow_redirect = false, unsigned timeout = 10, HtmlExtractor *extractor = 0);
+
+	// whether a transfer was successful, or was stopped because the extractor had everything
+	bool succeeded(CURLcode code, const HtmlExtractor *extractor);
 
 	std::string escape(const std::string &s);
+
+	// limits the download rate of every transfer that is started, 0 is unlimited
+	void setMaxSpeed(unsigned long bytes_per_second);
+
+	// sends every request through an http proxy, used to replay recorded pages in
+	// the tests, an empty url goes back to connecting to the sites directly
+	void setProxy(const std::string &url);
 }
 
 struct LyricsFetcher
 {
 	typedef std::pair<bool, std::string> Result;
 
+	// a page that has to be downloaded, step counts the pages of a fetch
+	struct Request
+	{
+		Request() : step(0), follow_redirect(false) { }
+
+		unsigned step;
+		std::string url;
+		std::string referer;
+		bool follow_redirect;
+		HtmlExtractor extractor;
+	};
+
+	// how often and how quickly each fetcher has found lyrics
+	struct Stats
+	{
+		Stats() : attempts(0), hits(0), cancelled(0), total_ms(0) { }
+
+		unsigned attempts;
+		unsigned hits;
+		unsigned cancelled;
+		unsigned long total_ms;
+	};
+
+	LyricsFetcher() { }
+	virtual ~LyricsFetcher() { }
+
 	virtual std::string name() = 0;
 	virtual Result fetch(const std::string &artist, const std::string &title);
 
+	// fetch is split into these so that several fetchers can share one curl multi handle,
+	// next returns true once result is final, otherwise request is set to the next page
+	virtual Request begin(const std::string &artist, const std::string &title);
+	virtual bool next(Request &request, const std::string &data, Result &result);
+
+	void record(bool hit, unsigned long ms);
+	void recordCancelled() { ++m_stats.cancelled; }
+	const Stats &stats() const { return m_stats; }
+
 protected:
 	virtual std::string urlTemplate() = 0;
 	virtual std::string regex() = 0;
 
+	// the markers around the part of the page that regex captures, so that the
+	// page can be streamed rather than downloaded and searched as a whole
+	virtual HtmlExtractor extractor() { return HtmlExtractor(); }
+
+	// options for htmlToText when turning the captured html into lyrics
+	virtual unsigned textOptions() { return 0; }
+
 	virtual bool notLyrics(const std::string &) { return false; }
 	virtual void postProcess(std::string &data);
 
 	std::vector<std::string> getContent(std::string regex, const std::string &data);
 
+public:
 	static const char msgNotFound[];
+
+private:
+	Stats m_stats;
 };
 
 struct LyricwikiFetcher : public LyricsFetcher
 {
 	virtual std::string name() { return "lyricwiki.com"; }
-	virtual Result fetch(const std::string &artist, const std::string &title);
+	virtual bool next(Request &request, const std::string &data, Result &result);
 
 protected:
 	virtual std::string urlTemplate() { return "http://lyrics.wikia.com/api.php?action=lyrics&fmt=xml&func=getSong&artist=%artist%&song=%title%"; }
 	virtual std::string regex() { return "<url>(.*?)</url>"; }
+	virtual HtmlExtractor extractor() { return HtmlExtractor({ "<url>" }, "</url>"); }
 
 	virtual bool notLyrics(const std::string &data);
 };
 
 /**********************************************************************/
 
+// gives the time each line is sung when it is known, as lrc
+struct LrclibFetcher : public LyricsFetcher
+{
+	virtual std::string name() { return "lrclib.net"; }
+	virtual Request begin(const std::string &artist, const std::string &title);
+	virtual bool next(Request &request, const std::string &data, Result &result);
+
+protected:
+	virtual std::string urlTemplate() { return "http://lrclib.net/api/get?artist_name=%artist%&track_name=%title%"; }
+	virtual std::string regex() { return ""; }
+};
+
+/**********************************************************************/
+
 struct GoogleLyricsFetcher : public LyricsFetcher
 {
-	virtual Result fetch(const std::string &artist, const std::string &title);
+	virtual Request begin(const std::string &artist, const std::string &title);
+	virtual bool next(Request &request, const std::string &data, Result &result);
 
 protected:
 	virtual std::string urlTemplate() { return URL; }
@@ -84,9 +231,12 @@ struct MetrolyricsFetcher : public GoogleLyricsFetcher
 
 protected:
 	virtual std::string regex() { return "<div id=\"lyrics-body\">(.*?)</div>"; }
+	virtual HtmlExtractor extractor() { return HtmlExtractor({ "<div id=\"lyrics-body\">" }, "</div>"); }
+
+	// some of lyrics have both &#10; and <br />, the tags are always there
+	virtual unsigned textOptions() { return HtmlBreakLines | HtmlSkipEncodedNewlines; }
 
 	virtual bool isURLOk(const std::string &url);
-	virtual void postProcess(std::string &data);
 };
 
 struct LyricsmaniaFetcher : public GoogleLyricsFetcher
@@ -95,6 +245,7 @@ struct LyricsmaniaFetcher : public GoogleLyricsFetcher
 
 protected:
 	virtual std::string regex() { return "<div class=\"lyrics-body\".*?</strong>(.*?)</div>"; }
+	virtual HtmlExtractor extractor() { return HtmlExtractor({ "<div class=\"lyrics-body\"", "</strong>" }, "</div>"); }
 };
 
 struct Sing365Fetcher : public GoogleLyricsFetcher
@@ -103,8 +254,10 @@ struct Sing365Fetcher : public GoogleLyricsFetcher
 
 protected:
 	virtual std::string regex() { return "<script src=\"//srv.tonefuse.com/showads/showad.js\"></script>(.*?)<script>\n/\\* Sing365 - Below Lyrics"; }
+	virtual HtmlExtractor extractor() { return HtmlExtractor({ "<script src=\"//srv.tonefuse.com/showads/showad.js\"></script>" }, "<script>\n/* Sing365 - Below Lyrics"); }
 
-	virtual void postProcess(std::string &data);
+	// throw away ads
+	virtual unsigned textOptions() { return HtmlSkipDivs; }
 };
 
 struct JustSomeLyricsFetcher : public GoogleLyricsFetcher
@@ -113,6 +266,7 @@ struct JustSomeLyricsFetcher : public GoogleLyricsFetcher
 
 protected:
 	virtual std::string regex() { return "<div class=\"core-left\">(.*?)</div>"; }
+	virtual HtmlExtractor extractor() { return HtmlExtractor({ "<div class=\"core-left\">" }, "</div>"); }
 };
 
 struct AzLyricsFetcher : public GoogleLyricsFetcher
@@ -121,12 +275,13 @@ struct AzLyricsFetcher : public GoogleLyricsFetcher
 
 protected:
 	virtual std::string regex() { return "<!-- start of lyrics -->(.*?)<!-- end of lyrics -->"; }
+	virtual HtmlExtractor extractor() { return HtmlExtractor({ "<!-- start of lyrics -->" }, "<!-- end of lyrics -->"); }
 };
 
 struct InternetLyricsFetcher : public GoogleLyricsFetcher
 {
 	virtual std::string name() { return "the Internet"; }
-	virtual Result fetch(const std::string &artist, const std::string &title);
+	virtual bool next(Request &request, const std::string &data, Result &result);
 
 protected:
 	virtual std::string siteKeyword() { return "lyrics"; }
@@ -140,6 +295,13 @@ private:
 
 extern LyricsFetcher *lyricsPlugins[];
 
+// requests lyrics from every plugin at once, the first plugin in the list to
+// find lyrics wins once all the plugins before it have failed, the rest are cancelled
+LyricsFetcher::Result fetchLyricsConcurrently(const std::string &artist, const std::string &title, bool &missing);
+
+// prints the latency and hit rate of each plugin to the debug console
+void debugLyricsStats();
+
 std::string unescapeHtmlUtf8(const std::string &s);
 
 void stripHtmlTags(std::string &s);
@@ -20,15 +20,25 @@
 
 #include "lyricsloader.hpp"
 
+#include <algorithm>
+#include <fstream>
 #include <list>
 #include <iostream>
 #include <sstream>
+#include <stdlib.h>
 #include <string>
 
+#include "clientstate.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
 #include "vimpc.hpp"
+#include "buffer/playlist.hpp"
 #include "window/debug.hpp"
 
+typedef std::pair<std::string, std::string> PrefetchItem;
+
 static std::list<std::string>             Queue;
+static std::list<PrefetchItem>            PrefetchQueue;
 static Mutex                              QueueMutex;
 static Atomic(bool)                       Running(true);
 static ConditionVariable                  Condition;
@@ -44,15 +54,32 @@ LyricsLoader & LyricsLoader::Instance()
 LyricsLoader::LyricsLoader() :
    loaded_            (false),
    loading_           (false),
+   line_              (-1),
+   duration_          (0),
    artist_            (""),
    title_             (""),
    uri_               (""),
    lyrics_            (Main::LyricsBuffer()),
+   cache_             (),
+   synced_            (),
+   clientState_       (NULL),
    lyricsThread_      (Thread(&LyricsLoader::LyricsQueueExecutor, this, this))
 {
    Vimpc::EventHandler(Event::CurrentSong, [this] (EventData const & Data) 
    { 
        SongChanged(Data); 
+       Prefetch();
+   });
+
+   Vimpc::EventHandler(Event::NextSongPos, [this] (EventData const & Data)
+   {
+      Prefetch();
+   });
+
+   Vimpc::EventHandler(Event::Disconnected, [this] (EventData const & Data)
+   {
+      UniqueLock<Mutex> Lock(QueueMutex);
+      PrefetchQueue.clear();
    });
 
    Vimpc::EventHandler(Event::Elapsed, [this] (EventData const & Data)
@@ -90,23 +117,40 @@ void LyricsLoader::ElapsedUpdate(uint32_t elapsed)
    if ((Main::Settings::Instance().Get(Setting::AutoLyrics) == true) &&
        (Main::Settings::Instance().Get(Setting::AutoScrollLyrics) == true))
    {
-       if (duration_ > 0) {
-           uint32_t percent = (((elapsed*100)/duration_)/10);
+      int32_t line = -1;
+
+      {
+         UniqueLock<Mutex> Lock(syncedMutex_);
 
-           percent *= 10;
+         if (synced_.Empty() == false)
+         {
+            line = synced_.Line(elapsed * 1000);
+         }
+         else if ((duration_ > 0) && (lyrics_.Size() > 0))
+         {
+            // Without times the best guess is that the lines are evenly spread
+            line = static_cast<int32_t>((static_cast<uint64_t>(elapsed) * lyrics_.Size()) / duration_);
+         }
+      }
 
-           if (percent != percent_)
-           {
-                EventData Data;
-                Data.value = percent;
-                percent_   = percent;
-                Main::Vimpc::CreateEvent(Event::LyricsPercent, Data);
-                Main::Vimpc::CreateEvent(Event::Repaint,       Data);
-           }
-       }
+      // Only repaint when the line changes, rather than on every tick
+      if (line != line_)
+      {
+         EventData Data;
+         Data.value = line;
+         line_      = line;
+         Main::Vimpc::CreateEvent(Event::LyricsLine, std::move(Data));
+         Main::Vimpc::CreateEvent(Event::Repaint);
+      }
    }
 }
 
+bool LyricsLoader::Synced()
+{
+   UniqueLock<Mutex> Lock(syncedMutex_);
+   return (synced_.Empty() == false);
+}
+
 void LyricsLoader::Load(Mpc::Song * song)
 {
    if (song) {
@@ -114,11 +158,77 @@ void LyricsLoader::Load(Mpc::Song * song)
    }
 }
 
-void LyricsLoader::Load(std::string artist, std::string title, std::string uri, uint32_t duration)
+std::string LyricsLoader::StripTitle(std::string title) const
 {
    Regex::RE titleStrip(Main::Settings::Instance().Get(Setting::LyricsStrip));
 
    titleStrip.ReplaceAll("", title);
+   return title;
+}
+
+void LyricsLoader::Prefetch()
+{
+   Main::Settings const & settings = Main::Settings::Instance();
+   uint32_t const count = atoi(settings.Get(Setting::LyricsPrefetch).c_str());
+
+   std::list<PrefetchItem> items;
+
+   if ((clientState_ != NULL) && (count > 0) && (settings.Get(Setting::AutoLyrics) == true))
+   {
+      int32_t  const current = clientState_->GetCurrentSongPos();
+      int32_t  const next    = clientState_->GetNextSongPos();
+      uint32_t const size    = Main::Playlist().Size();
+
+      std::vector<int32_t> positions;
+
+      // In random mode the only song known to be next is the one mpd has picked
+      if (next >= 0)
+      {
+         positions.push_back(next);
+      }
+
+      for (uint32_t i = 1; (current >= 0) && (clientState_->Random() == false) && (i <= count) && (size > 0); ++i)
+      {
+         uint32_t position = current + i;
+
+         if ((position >= size) && (clientState_->Repeat() == true))
+         {
+            position %= size;
+         }
+
+         if ((position < size) && (static_cast<int32_t>(position) != current) &&
+             (std::find(positions.begin(), positions.end(), static_cast<int32_t>(position)) == positions.end()))
+         {
+            positions.push_back(position);
+         }
+      }
+
+      for (auto it = positions.begin(); ((it != positions.end()) && (items.size() < count)); ++it)
+      {
+         Mpc::Song const * const song = (static_cast<uint32_t>(*it) < size) ? Main::Playlist().Get(*it) : NULL;
+
+         // Whether the cache already has them is checked by the lyrics thread,
+         // opening the cache may have to read it from disk
+         if ((song != NULL) && (song->Artist() != "") && (song->Title() != ""))
+         {
+            items.push_back(PrefetchItem(song->Artist(), StripTitle(song->Title())));
+         }
+      }
+   }
+
+   UniqueLock<Mutex> Lock(QueueMutex);
+   PrefetchQueue.swap(items);
+
+   if (PrefetchQueue.empty() == false)
+   {
+      Debug("Prefetching lyrics for %u songs", static_cast<uint32_t>(PrefetchQueue.size()));
+      Condition.notify_all();
+   }
+}
+
+void LyricsLoader::Load(std::string artist, std::string title, std::string uri, uint32_t duration)
+{
+   title = StripTitle(title);
 
    UniqueLock<Mutex> Lock(QueueMutex);
 
@@ -135,10 +245,32 @@ void LyricsLoader::Load(std::string artist, std::string title, std::string uri,
       title_   = title;
       uri_     = uri;
       duration_= duration;
-      percent_ = 0;
-      Queue.push_back(uri_);
-      Debug("Notifying lyrics loader");
-      Condition.notify_all();
+      line_    = -1;
+
+      std::string lyrics;
+      bool const local = LoadLocal(uri_);
+      LyricsCache::Status const status = (local == true) ? LyricsCache::Found : cache_.Lookup(artist_, title_, lyrics);
+
+      if (status != LyricsCache::Unknown)
+      {
+         if (local == false)
+         {
+            Debug("Loaded lyrics from the cache");
+            SetLyrics(lyrics);
+         }
+
+         loaded_  = true;
+         loading_ = false;
+
+         Main::Vimpc::CreateEvent(Event::LyricsLoaded);
+         Main::Vimpc::CreateEvent(Event::Repaint);
+      }
+      else
+      {
+         Queue.push_back(uri_);
+         Debug("Notifying lyrics loader");
+         Condition.notify_all();
+      }
    }
    else
    {
@@ -146,63 +278,168 @@ void LyricsLoader::Load(std::string artist, std::string title, std::string uri,
    }
 }
 
+bool LyricsLoader::LoadLocal(std::string const & uri)
+{
+   std::string const directory = Main::Settings::Instance().Get(Setting::LocalMusicDir);
+
+   if ((directory == "") || (uri == ""))
+   {
+      return false;
+   }
+
+   // An lrc file next to the song with the same name
+   std::string path = directory + "/" + uri;
+   size_t const slash = path.rfind('/');
+   size_t const dot   = path.rfind('.');
+
+   if ((dot != std::string::npos) && (dot > slash))
+   {
+      path.erase(dot);
+   }
+
+   std::ifstream stream((path + ".lrc").c_str(), std::ios::in | std::ios::binary);
+
+   if (stream.is_open() == false)
+   {
+      return false;
+   }
+
+   std::string const lyrics((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+   Debug("Loaded lyrics from %s.lrc", path.c_str());
+   SetLyrics(lyrics);
+   return true;
+}
+
+void LyricsLoader::SetLyrics(std::string const & lyrics)
+{
+   std::stringstream stream(lyrics);
+   std::string line;
+   std::string last_line = "";
+
+   lyrics_.Clear();
+
+   {
+      UniqueLock<Mutex> Lock(syncedMutex_);
+
+      if (synced_.Parse(lyrics) == true)
+      {
+         std::vector<std::string> const & lines = synced_.Lines();
+
+         for (auto it = lines.begin(); (it != lines.end()); ++it)
+         {
+            lyrics_.Add(*it);
+         }
+
+         return;
+      }
+   }
+
+   while (std::getline(stream, line))
+   {
+      if ((line == last_line) && (last_line == ""))
+      {
+          continue;
+      }
+
+      lyrics_.Add(line);
+      last_line = line;
+   }
+}
+
 void LyricsLoader::LyricsQueueExecutor(Main::LyricsLoader * loader)
 {
+   Main::Trace::NameThread("lyrics");
+
    while (Running == true)
    {
       UniqueLock<Mutex> Lock(QueueMutex);
 
-      if ((Queue.empty() == false) ||
+      if ((Queue.empty() == false) || (PrefetchQueue.empty() == false) ||
           (ConditionWait(Condition, Lock, 250) != false))
       {
          if (Queue.empty() == false)
          {
             Queue.pop_front();
+
+            std::string const artistTag = artist_;
+            std::string const titleTag  = title_;
+
             Lock.unlock();
             loaded_  = false;
             loading_ = true;
 
             // \todo wait on the queue
-            std::string const artist = Curl::escape(artist_);
-            std::string const title  = Curl::escape(title_);
+            std::string const artist = Curl::escape(artistTag);
+            std::string const title  = Curl::escape(titleTag);
             LyricsFetcher::Result result;
+            bool missing = false;
 
             Debug("Attempting to find lyrics");
 
-            for (LyricsFetcher **plugin = lyricsPlugins; *plugin != 0; ++plugin)
+            uint64_t const start = Main::Stats::Now();
+
             {
-               result = (*plugin)->fetch(artist, title);
+               Main::Trace::Span Span("lyrics", "fetch");
+
+               if (Main::Settings::Instance().Get(Setting::LyricsConcurrent) == true)
+               {
+                  result = fetchLyricsConcurrently(artist, title, missing);
+               }
+               else
+               {
+                  for (LyricsFetcher **plugin = lyricsPlugins; *plugin != 0; ++plugin)
+                  {
+                     result = (*plugin)->fetch(artist, title);
 
-               if (result.first == true)
-                  break;
+                     if (result.first == true)
+                        break;
+
+                     // Only remember that there are no lyrics if a site said so,
+                     // rather than every site being unreachable
+                     missing = missing || (result.second == LyricsFetcher::msgNotFound);
+                  }
+               }
             }
 
-            lyrics_.Clear();
+            Main::Stats::Instance().Lyrics().Add(Main::Stats::Now() - start);
+            debugLyricsStats();
 
             if (result.first == true)
             {
-               std::stringstream stream(result.second);
-               std::string line;
-               std::string last_line = "";
                Debug("Found lyrics");
+               cache_.Store(artistTag, titleTag, result.second);
+            }
+            else if (missing == true)
+            {
+               cache_.StoreMissing(artistTag, titleTag);
+            }
 
-               while (std::getline(stream, line))
-               {
-                  if ((line == last_line) && (last_line == ""))
-                  {
-                      continue;
-                  }
+            Lock.lock();
 
-                  lyrics_.Add(line);
-                  last_line = line;
-               }
+            // The song may have changed and been loaded from the cache whilst fetching
+            if ((artistTag != artist_) || (titleTag != title_))
+            {
+               continue;
             }
 
+            Lock.unlock();
+
+            SetLyrics((result.first == true) ? result.second : "");
+
             loaded_  = true;
 
-            EventData Data;
-            Main::Vimpc::CreateEvent(Event::LyricsLoaded, Data);
-            Main::Vimpc::CreateEvent(Event::Repaint,      Data);
+            Main::Vimpc::CreateEvent(Event::LyricsLoaded);
+            Main::Vimpc::CreateEvent(Event::Repaint);
+            continue;
+         }
+         else if (PrefetchQueue.empty() == false)
+         {
+            PrefetchItem const item = PrefetchQueue.front();
+            PrefetchQueue.pop_front();
+            Lock.unlock();
+
+            PrefetchLyrics(item.first, item.second);
             continue;
          }
       }
@@ -210,3 +447,59 @@ void LyricsLoader::LyricsQueueExecutor(Main::LyricsLoader * loader)
       loading_ = false;
    }
 }
+
+void LyricsLoader::PrefetchLyrics(std::string const & artist, std::string const & title)
+{
+   if (cache_.Contains(artist, title) == true)
+   {
+      return;
+   }
+
+   // Prefetching is done one site at a time with a limited download
+   // rate, so that it does not compete with the song that is playing
+   unsigned long const rate = atoi(Main::Settings::Instance().Get(Setting::LyricsPrefetchRate).c_str());
+
+   LyricsFetcher::Result result(false, "");
+   bool missing   = false;
+   bool cancelled = false;
+
+   Debug("Prefetching lyrics for %s - %s", artist.c_str(), title.c_str());
+   Curl::setMaxSpeed(rate * 1024);
+
+   for (LyricsFetcher **plugin = lyricsPlugins; *plugin != 0; ++plugin)
+   {
+      {
+         UniqueLock<Mutex> Lock(QueueMutex);
+
+         // Lyrics for the current song take priority, try again later
+         if (Queue.empty() == false)
+         {
+            PrefetchQueue.push_front(PrefetchItem(artist, title));
+            cancelled = true;
+            break;
+         }
+      }
+
+      Main::Trace::Span Span("lyrics", "prefetch");
+      result = (*plugin)->fetch(Curl::escape(artist), Curl::escape(title));
+
+      if (result.first == true)
+         break;
+
+      missing = missing || (result.second == LyricsFetcher::msgNotFound);
+   }
+
+   Curl::setMaxSpeed(0);
+
+   if (cancelled == false)
+   {
+      if (result.first == true)
+      {
+         cache_.Store(artist, title, result.second);
+      }
+      else if (missing == true)
+      {
+         cache_.StoreMissing(artist, title);
+      }
+   }
+}
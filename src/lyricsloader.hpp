@@ -28,9 +28,16 @@
 #include "compiler.hpp"
 #include "events.hpp"
 #include "song.hpp"
+#include "lyricscache.hpp"
 #include "lyricsfetcher.hpp"
+#include "syncedlyrics.hpp"
 #include "buffer/buffer.hpp"
 
+namespace Mpc
+{
+   class ClientState;
+}
+
 namespace Main
 {
    class LyricsLoader
@@ -45,10 +52,16 @@ namespace Main
       public:
          void Load(Mpc::Song * song);
 
+         //! Used to find the songs that will be played next so their lyrics can be prefetched
+         void SetClientState(Mpc::ClientState * clientState) { clientState_ = clientState; }
+
       private:
          void SongChanged(EventData const & Data);
          void ElapsedUpdate(uint32_t elapsed);
          void Load(std::string artist, std::string title, std::string uri, uint32_t duration);
+         bool LoadLocal(std::string const & uri);
+         void Prefetch();
+         std::string StripTitle(std::string title) const;
 
       public:
          std::string  Artist()    { return artist_; }
@@ -57,18 +70,30 @@ namespace Main
          bool         Loaded()    { return loaded_; }
          bool         IsLoading() { return loading_; }
 
+         //! Whether the lyrics have the time each line is sung
+         bool         Synced();
+
+         //! The line of the lyrics being sung, or -1 if not known
+         int32_t      CurrentLine() { return line_; }
+
       private:
          void LyricsQueueExecutor(Main::LyricsLoader * loader);
+         void PrefetchLyrics(std::string const & artist, std::string const & title);
+         void SetLyrics(std::string const & lyrics);
 
       private:
          bool           loaded_;
          bool           loading_;
-         uint32_t       percent_;
+         int32_t        line_;
          uint32_t       duration_;
          std::string    artist_;
          std::string    title_;
          std::string    uri_;
          Main::Lyrics & lyrics_;
+         LyricsCache    cache_;
+         SyncedLyrics   synced_;
+         Mutex          syncedMutex_;
+         Mpc::ClientState * clientState_;
          Thread         lyricsThread_;
    };
 
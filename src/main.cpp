@@ -24,6 +24,10 @@
 #include "project.hpp"
 #include "vimpc.hpp"
 
+#ifdef TEST_ENABLED
+#include "test/bench.hpp"
+#endif
+
 #ifdef __DEBUG_ASSERT
 
 #ifdef HAVE_EXECINFO_H
@@ -59,8 +63,10 @@ int main(int argc, char** argv)
    bool runVimpc           = true;
    int  option             = 0;
    int  option_index       = 0;
+   int  result             = 0;
 
    std::string hostname("");
+   std::string bench("");
    uint16_t    port(0);
 
    while (option != -1)
@@ -72,6 +78,9 @@ int main(int argc, char** argv)
          {"bugreport",  no_argument, 0, 'b'},
          {"url",        no_argument, 0, 'u'},
          {"version",    no_argument, 0, 'v'},
+#ifdef TEST_ENABLED
+         {"bench",      required_argument, 0, 'B'},
+#endif
          {0, 0, 0, 0}
       };
 
@@ -104,6 +113,10 @@ int main(int argc, char** argv)
          {
             port = atoi(optarg);
          }
+         else if (option == 'B')
+         {
+            bench = optarg;
+         }
          else if (option == ':' || option == '?')
          {
             runVimpc  = false;
@@ -117,12 +130,22 @@ int main(int argc, char** argv)
    {
       setlocale(LC_ALL, "");
 
-      Main::Vimpc vimpc;
-      vimpc.Run(hostname, port);
+#ifdef TEST_ENABLED
+      if (bench != "")
+      {
+         Main::Bench benchmark(bench);
+         result = benchmark.Run();
+      }
+      else
+#endif
+      {
+         Main::Vimpc vimpc;
+         vimpc.Run(hostname, port);
+      }
    }
 
    Main::Delete();
 
-   return 0;
+   return result;
 }
 /* vim: set sw=3 ts=3: */
@@ -44,7 +44,9 @@
 #include "buffers.hpp"
 #include "regex.hpp"
 #include "settings.hpp"
+#include "songsorter.hpp"
 #include "tag.hpp"
+#include "trace.hpp"
 #include "vimpc.hpp"
 
 #include "buffer/directory.hpp"
@@ -52,9 +54,12 @@
 #include "buffer/outputs.hpp"
 #include "buffer/playlist.hpp"
 #include "mode/normal.hpp"
+#include "mode/search.hpp"
 #include "window/console.hpp"
 #include "window/debug.hpp"
 #include "window/error.hpp"
+#include "window/filterwindow.hpp"
+#include "window/infowindow.hpp"
 #include "window/songwindow.hpp"
 
 using namespace Ui;
@@ -109,6 +114,7 @@ Command::Command(Main::Vimpc * vimpc, Ui::Screen & screen, Mpc::Client & client,
    AddCommand("echo",       false, false, &Command::Echo);
    AddCommand("enable",     true,  true,  &Command::Output<true>);
    AddCommand("error",      false, false, &Command::EchoError);
+   AddCommand("filter",     false, false, &Command::Filter);
    AddCommand("find",       true,  false, &Command::FindAny);
    AddCommand("findalbum",  true,  false, &Command::FindAlbum);
    AddCommand("findartist", true,  false, &Command::FindArtist);
@@ -136,6 +142,7 @@ Command::Command(Main::Vimpc * vimpc, Ui::Screen & screen, Mpc::Client & client,
    AddCommand("single",     true,  false, &Command::Single);
    AddCommand("shuffle",    true,  false, &Command::Shuffle);
    AddCommand("sleep",      false, false, &Command::Sleep);
+   AddCommand("sort",       true,  false, &Command::Sort);
 #ifdef TAG_SUPPORT
    AddCommand("substitute", false, true,  &Command::Substitute);
    AddCommand("s",          false, true,  &Command::Substitute);
@@ -143,6 +150,7 @@ Command::Command(Main::Vimpc * vimpc, Ui::Screen & screen, Mpc::Client & client,
    AddCommand("swap",       true,  false,  &Command::Swap);
    AddCommand("stop",       true,  false, &Command::Stop);
    AddCommand("toggle",     true,  true,  &Command::ToggleOutput);
+   AddCommand("trace",      false, false, &Command::Trace);
    AddCommand("unalias",    false, false, &Command::Unalias);
    AddCommand("volume",     true,  false,  &Command::Volume);
 
@@ -178,6 +186,7 @@ Command::Command(Main::Vimpc * vimpc, Ui::Screen & screen, Mpc::Client & client,
    AddCommand("library",     true,  false, &Command::SetActiveAndVisible<Ui::Screen::Library>);
    AddCommand("directory",   true,  false, &Command::SetActiveAndVisible<Ui::Screen::Directory>);
    AddCommand("playlist",    true,  false, &Command::SetActiveAndVisible<Ui::Screen::Playlist>);
+   AddCommand("stats",       true,  false, &Command::SetActiveAndVisible<Ui::Screen::Stats>);
    AddCommand("outputs",     true,  false, &Command::SetActiveAndVisible<Ui::Screen::Outputs>);
    AddCommand("lists",       true,  false, &Command::SetActiveAndVisible<Ui::Screen::Lists>);
    AddCommand("windowselect",false, false, &Command::SetActiveAndVisible<Ui::Screen::WindowSelect>);
@@ -714,6 +723,36 @@ void Command::Sleep(std::string const & seconds)
    usleep(1000 * 1000 * atoi(seconds.c_str()));
 }
 
+void Command::Trace(std::string const & arguments)
+{
+   std::vector<std::string> const args = SplitArguments(arguments);
+
+   if (args.empty() == true)
+   {
+      ErrorString(ErrorNumber::NoParameter);
+   }
+   else if ((args[0] == "start") && (args.size() == 1))
+   {
+      Main::Trace::Start();
+      Main::Console().Add("Tracing started");
+   }
+   else if ((args[0] == "stop") && (args.size() == 2))
+   {
+      if (Main::Trace::Stop(args[1]) == true)
+      {
+         Main::Console().Add("Trace written to " + args[1]);
+      }
+      else
+      {
+         ErrorString(ErrorNumber::InvalidParameter, "could not write " + args[1]);
+      }
+   }
+   else
+   {
+      ErrorString(ErrorNumber::InvalidParameter);
+   }
+}
+
 void Command::Substitute(std::string const & expression)
 {
 #ifdef TAG_SUPPORT
@@ -972,6 +1011,33 @@ void Command::FindSong(std::string const & arguments)
    Find("F:" + arguments);
 }
 
+void Command::Filter(std::string const & arguments)
+{
+   Ui::SongWindow * source = dynamic_cast<Ui::SongWindow *>(&screen_.ActiveWindow());
+
+   if (arguments == "")
+   {
+      ErrorString(ErrorNumber::NoParameter);
+   }
+   else if ((source == NULL) || (dynamic_cast<Ui::InfoWindow *>(source) != NULL))
+   {
+      ErrorString(ErrorNumber::FilterNotSupported);
+   }
+   else
+   {
+      Ui::FilterWindow * window = dynamic_cast<Ui::FilterWindow *>(source);
+
+      // Filtering a filter window just changes its pattern
+      if (window == NULL)
+      {
+         window = screen_.CreateFilterWindow(*source);
+      }
+
+      window->SetPattern(search_.StripFlags(arguments), search_.GetOptions(arguments));
+      screen_.SetActiveAndVisible(screen_.GetWindowFromName(window->Name()));
+   }
+}
+
 void Command::PrintMappings(std::string tabname)
 {
    Ui::Normal::MapNameTable mappings = normalMode_.Mappings();
@@ -1139,6 +1205,39 @@ void Command::Shuffle(std::string const & arguments)
    Player::Shuffle();
 }
 
+void Command::Sort(std::string const & arguments)
+{
+   Ui::FieldSorter const sorter(arguments);
+
+   if (arguments == "")
+   {
+      ErrorString(ErrorNumber::NoParameter);
+   }
+   else if (sorter.Valid() == false)
+   {
+      Error(ErrorNumber::InvalidParameter, "Can't sort by " + sorter.Invalid());
+   }
+   else
+   {
+      screen_.Initialise(Ui::Screen::Playlist);
+
+      std::vector<Mpc::Song *> songs;
+      songs.reserve(Main::Playlist().Size());
+
+      for (uint32_t i = 0; i < Main::Playlist().Size(); ++i)
+      {
+         songs.push_back(Main::Playlist().Get(i));
+      }
+
+      // Only the songs that are out of order are moved, so the current song keeps playing
+      std::vector<uint32_t> const order = sorter.Order(songs);
+
+      client_.Move(Algorithm::OrderMoves(order));
+      Main::Playlist().Reorder(order);
+      screen_.Update();
+   }
+}
+
 void Command::Move(std::string const & arguments)
 {
    screen_.Initialise(Ui::Screen::Playlist);
@@ -1436,8 +1535,8 @@ void Command::TestExecutor()
                if (output != "")
                {
                   EventData Data; Data.name = output;
-                  Main::Vimpc::CreateEvent(Event::TestResult, Data);
-                  Main::Vimpc::CreateEvent(Event::Repaint,   Data);
+                  Main::Vimpc::CreateEvent(Event::TestResult, std::move(Data));
+                  Main::Vimpc::CreateEvent(Event::Repaint);
                }
             }
 
@@ -100,6 +100,7 @@ namespace Ui
       void Crossfade(std::string const & arguments);
       void Move(std::string const & arguments);
       void Shuffle(std::string const & arguments);
+      void Sort(std::string const & arguments);
       void Swap(std::string const & arguments);
       void Redraw(std::string const & arguments);
       void Stop(std::string const & arguments);
@@ -134,6 +135,9 @@ namespace Ui
 
       void Sleep(std::string const & expression);
 
+      //! Starts tracing or stops and writes the trace to the given file
+      void Trace(std::string const & arguments);
+
       void Substitute(std::string const & seconds);
 
    private:
@@ -164,6 +168,7 @@ namespace Ui
       void FindArtist(std::string const & arguments);
       void FindGenre(std::string const & arguments);
       void FindSong(std::string const & arguments);
+      void Filter(std::string const & arguments);
 
       void PrintMappings(std::string tabname = "");
       void Map(std::string const & arguments);
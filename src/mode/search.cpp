@@ -22,6 +22,7 @@
 
 #include "algorithm.hpp"
 #include "settings.hpp"
+#include "taskpool.hpp"
 #include "vimpc.hpp"
 #include "buffer/playlist.hpp"
 #include "window/debug.hpp"
@@ -31,6 +32,10 @@
 
 using namespace Ui;
 
+// Windows with at least this many lines are searched in parallel chunks
+static uint32_t const ChunkSize         = 4096;
+static uint32_t const ChunkedSearchSize = 4 * ChunkSize;
+
 Search::Search(Ui::Screen & screen, Mpc::Client & client, Main::Settings & settings) :
    InputMode   (screen),
    direction_  (Forwards),
@@ -38,9 +43,15 @@ Search::Search(Ui::Screen & screen, Mpc::Client & client, Main::Settings & setti
    lastSearch_ (""),
    hasSearched_(false),
    highlight_  (true),
+   cancelled_  (false),
    prompt_     (),
    settings_   (settings),
-   screen_     (screen)
+   screen_     (screen),
+   chunkSearch_    (""),
+   chunkOptions_   (Regex::None),
+   chunkWindow_    (NULL),
+   chunkGeneration_(0),
+   chunkLines_     (0)
 {
    prompt_[Forwards]  = '/';
    prompt_[Backwards] = '?';
@@ -102,7 +113,8 @@ bool Search::Handle(int input)
 
          if ((inputString_ == Match) || (LastIncFound == true))
          {
-            LastIncFound = SearchResult(Next, inputString_, currentLine_, 1, false);
+            // A search cancelled by further input has not proved there are no results
+            LastIncFound = (SearchResult(Next, inputString_, currentLine_, 1, false) || cancelled_);
 
             if (LastIncFound == true)
             {
@@ -145,6 +157,8 @@ bool Search::SearchResult(Skip skip, std::string const & search, int32_t line, u
 {
    bool found = false;
 
+   cancelled_ = false;
+
    if (screen_.GetActiveWindow() != Screen::DebugConsole)
    {
       Direction direction = direction_;
@@ -156,7 +170,7 @@ bool Search::SearchResult(Skip skip, std::string const & search, int32_t line, u
 
       found = SearchWindow(direction, search, line, count);
 
-      if (found == false)
+      if ((found == false) && (cancelled_ == false))
       {
          if (raiseError == true)
          {
@@ -176,6 +190,11 @@ bool Search::SearchWindow(Direction direction, std::string search, int32_t start
 {
    bool found = false;
 
+   if (UseChunkedSearch() == true)
+   {
+      return SearchChunks(direction, search, count, startLine);
+   }
+
    found = SearchForResult(direction, search, count, startLine);
 
    if ((found == false) && (settings_.Get(Setting::SearchWrap) == true))
@@ -196,26 +215,256 @@ bool Search::SearchWindow(Direction direction, std::string search, int32_t start
 
 bool Search::SearchForResult(Direction direction, std::string search, uint32_t count, int32_t startLine)
 {
-   bool found = false;
+   // see :help pattern-overview for full descriptions of what should be supported
+   Regex::RE const expression(StripFlags(search), GetOptions(search));
+   bool            found = false;
 
    if (direction == Forwards)
    {
       for (int32_t i = startLine + 1; ((i >= 0) && (i < static_cast<int32_t>(screen_.ActiveWindow().BufferSize())) && (found == false)); ++i)
       {
-         found = CheckForMatch(search, i, count);
+         found = CheckForMatch(expression, i, count);
       }
    }
    else
    {
       for (int32_t i = startLine - 1; ((i >= 0) && (i < static_cast<int32_t>(screen_.ActiveWindow().BufferSize())) && (found == false)); --i)
       {
-         found = CheckForMatch(search, i, count);
+         found = CheckForMatch(expression, i, count);
       }
    }
 
    return found;
 }
 
+bool Search::UseChunkedSearch() const
+{
+   return (screen_.ActiveWindow().BufferSize() >= ChunkedSearchSize);
+}
+
+bool Search::SearchChunks(Direction direction, std::string const & search, uint32_t count, int32_t startLine)
+{
+   ValidateChunks(search);
+
+   Regex::RE const expression(StripFlags(search), GetOptions(search));
+
+   int32_t const lines = static_cast<int32_t>(chunkLines_);
+   int32_t const step  = (direction == Forwards) ? 1 : -1;
+   uint32_t const batchSize = 2 * Workers();
+
+   // The first pass covers everything after the start line, if the search wraps
+   // the second pass covers the whole window again and counts from the start
+   // again, as the line by line search does
+   std::vector<std::pair<int32_t, int32_t> > passes;
+   passes.push_back(std::make_pair(startLine + step, (direction == Forwards) ? lines : -1));
+
+   if (settings_.Get(Setting::SearchWrap) == true)
+   {
+      passes.push_back((direction == Forwards) ? std::make_pair(0, lines) : std::make_pair(lines - 1, -1));
+   }
+
+   for (auto const & pass : passes)
+   {
+      int32_t const first = pass.first;
+      int32_t const end   = pass.second;
+      uint32_t      left  = count;
+
+      if ((first < 0) || (first >= lines))
+      {
+         continue;
+      }
+
+      // Chunks in the order they are reached from the first line
+      std::vector<uint32_t> order;
+
+      for (int32_t chunk = first / ChunkSize; (chunk >= 0) && (chunk * ChunkSize < static_cast<uint32_t>(lines)); chunk += step)
+      {
+         order.push_back(chunk);
+      }
+
+      for (uint32_t i = 0; i < order.size(); ++i)
+      {
+         uint32_t const chunk = order[i];
+
+         if (chunkState_[chunk] != Searched)
+         {
+            // Match this chunk and the next few that have not been searched yet,
+            // nearer chunks are handed to the workers first
+            std::vector<uint32_t> batch;
+
+            for (uint32_t j = i; (j < order.size()) && (batch.size() < batchSize); ++j)
+            {
+               if (chunkState_[order[j]] != Searched)
+               {
+                  batch.push_back(order[j]);
+               }
+            }
+
+            if (MatchChunks(expression, batch) == false)
+            {
+               cancelled_ = true;
+               return false;
+            }
+         }
+
+         LineList const & matches = chunkMatches_[chunk];
+
+         for (uint32_t j = 0; j < matches.size(); ++j)
+         {
+            int32_t const line = static_cast<int32_t>((direction == Forwards) ? matches[j] : matches[matches.size() - j - 1]);
+
+            if (((step > 0) && (line >= first) && (line < end)) ||
+                ((step < 0) && (line <= first) && (line > end)))
+            {
+               screen_.ScrollTo(line);
+
+               if (--left == 0)
+               {
+                  return true;
+               }
+            }
+         }
+      }
+   }
+
+   return false;
+}
+
+bool Search::MatchChunks(Regex::RE const & expression, std::vector<uint32_t> const & chunks)
+{
+   Mutex                                ChunkMutex;
+   std::vector<Main::TaskPool::TaskPtr> tasks;
+
+   for (auto const chunk : chunks)
+   {
+      tasks.push_back(Main::TaskPool::Instance().Submit(Main::TaskPool::Interactive, [&, chunk] (Main::TaskPool::Task const & task)
+      {
+         LineList lines;
+         MatchChunk(expression, chunk, lines);
+
+         UniqueLock<Mutex> Lock(ChunkMutex);
+
+         if (task.Cancelled() == false)
+         {
+            chunkMatches_[chunk].swap(lines);
+            chunkState_[chunk] = Searched;
+         }
+      }));
+   }
+
+   // Keep checking for a keypress whilst the tasks run, any input
+   // abandons the search so that the interface stays responsive
+   bool cancelled = false;
+
+   for (auto const & task : tasks)
+   {
+      while (task->Wait(20) == false)
+      {
+         if ((cancelled == false) && (Main::Vimpc::InputPending() == true))
+         {
+            Debug("Search cancelled by input");
+            cancelled = true;
+
+            for (auto const & other : tasks)
+            {
+               other->Cancel();
+            }
+         }
+      }
+   }
+
+   return (cancelled == false);
+}
+
+void Search::MatchChunk(Regex::RE const & expression, uint32_t chunk, LineList & lines) const
+{
+   Ui::ScrollWindow const & window = *chunkWindow_;
+
+   if (chunkState_[chunk] == Candidates)
+   {
+      // Only the lines that matched a pattern this one extends can match
+      for (auto const line : chunkMatches_[chunk])
+      {
+         if (expression.Matches(window.SearchPattern(line)) == true)
+         {
+            lines.push_back(line);
+         }
+      }
+   }
+   else
+   {
+      uint32_t const first = chunk * ChunkSize;
+      uint32_t const last  = std::min(first + ChunkSize, chunkLines_);
+
+      for (uint32_t line = first; line < last; ++line)
+      {
+         if (expression.Matches(window.SearchPattern(line)) == true)
+         {
+            lines.push_back(line);
+         }
+      }
+   }
+}
+
+void Search::ValidateChunks(std::string const & search)
+{
+   Ui::ScrollWindow const & window = screen_.ActiveWindow();
+
+   std::string const    pattern = StripFlags(search);
+   Regex::Options const options = GetOptions(search);
+
+   if ((chunkWindow_ != &window) || (chunkGeneration_ != window.BufferGeneration()) ||
+       (chunkLines_ != window.BufferSize()) || (chunkOptions_ != options))
+   {
+      ResetChunks(window);
+   }
+   else if ((chunkSearch_ != pattern) && (IsLiteralExtension(chunkSearch_, pattern) == true))
+   {
+      // Every line that failed the previous pattern must also fail this one,
+      // so searched chunks only need their previous matches testing again
+      for (auto & state : chunkState_)
+      {
+         if (state == Searched)
+         {
+            state = Candidates;
+         }
+      }
+   }
+   else if (chunkSearch_ != pattern)
+   {
+      ResetChunks(window);
+   }
+
+   chunkSearch_  = pattern;
+   chunkOptions_ = options;
+}
+
+void Search::ResetChunks(Ui::ScrollWindow const & window)
+{
+   chunkWindow_     = &window;
+   chunkGeneration_ = window.BufferGeneration();
+   chunkLines_      = window.BufferSize();
+
+   uint32_t const chunks = (chunkLines_ + ChunkSize - 1) / ChunkSize;
+
+   chunkState_.assign(chunks, Unsearched);
+   chunkMatches_.assign(chunks, LineList());
+}
+
+bool Search::IsLiteralExtension(std::string const & previous, std::string const & pattern) const
+{
+   static std::string const Special("\\^$.|?*+()[]{}");
+
+   return ((pattern.size() > previous.size()) &&
+           (pattern.compare(0, previous.size(), previous) == 0) &&
+           (pattern.find_first_of(Special) == std::string::npos));
+}
+
+uint32_t Search::Workers() const
+{
+   return Main::TaskPool::Instance().Workers();
+}
+
 Search::Direction Search::SwapDirection(Direction direction) const
 {
    return ((direction == Forwards) ? Backwards : Forwards);
@@ -233,16 +482,14 @@ Search::Direction Search::GetDirectionForInput(int input) const
    return direction;
 }
 
-bool Search::CheckForMatch(std::string const & search, int32_t songId, uint32_t & count)
+bool Search::CheckForMatch(Regex::RE const & expression, int32_t songId, uint32_t & count)
 {
-   // see :help pattern-overview for full descriptions of what should be supported
-   Regex::RE   expression(".*" + StripFlags(search) + ".*", GetOptions(search));
    bool        found     (false);
 
    //std::string songDescription(screen_.PlaylistWindow().GetSong(songId)->PlaylistDescription());
    std::string searchPattern(screen_.ActiveWindow().SearchPattern(songId));
 
-   if (expression.CompleteMatch(searchPattern.c_str()) == true)
+   if (expression.Matches(searchPattern) == true)
    {
       screen_.ScrollTo(songId);
 
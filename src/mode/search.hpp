@@ -38,6 +38,7 @@ namespace Main
 namespace Ui
 {
    class Screen;
+   class ScrollWindow;
 
    // Handles all input received whilst in search mode
    class Search : public InputMode
@@ -75,16 +76,40 @@ namespace Ui
       void SetHighlightSearch(bool highlight) { highlight_ = highlight; }
       bool HighlightSearch() const { return highlight_; }
 
+      Regex::Options GetOptions(const std::string & search) const;
+      std::string StripFlags(std::string) const;
+
+   protected:
+      //! Uses a chunked search across the workers for large windows
+      bool SearchWindow(Direction direction, std::string search, int32_t startLine, uint32_t count);
+
    private:
       bool SearchResult(Skip skip, std::string const & search, int32_t line, uint32_t count, bool raiseError = true);
-      bool SearchWindow(Direction direction, std::string search, int32_t startLine, uint32_t count);
       bool SearchForResult(Direction direction, std::string search, uint32_t count, int32_t startLine);
       Direction SwapDirection(Direction direction) const;
       Direction GetDirectionForInput(int input) const;
-      bool CheckForMatch(std::string const & search, int32_t songId, uint32_t & count);
+      bool CheckForMatch(Regex::RE const & expression, int32_t songId, uint32_t & count);
 
-      Regex::Options GetOptions(const std::string & search) const;
-      std::string StripFlags(std::string) const;
+   private:
+      // Large windows are searched in chunks across several threads, the
+      // results of each chunk are kept so that n and N can reuse them
+      typedef std::vector<uint32_t> LineList;
+
+      typedef enum
+      {
+         Unsearched,
+         Candidates, // Matches of a previous pattern that need testing again
+         Searched
+      } ChunkState;
+
+      bool UseChunkedSearch() const;
+      bool SearchChunks(Direction direction, std::string const & search, uint32_t count, int32_t startLine);
+      bool MatchChunks(Regex::RE const & expression, std::vector<uint32_t> const & chunks);
+      void MatchChunk(Regex::RE const & expression, uint32_t chunk, LineList & lines) const;
+      void ValidateChunks(std::string const & search);
+      void ResetChunks(Ui::ScrollWindow const & window);
+      bool IsLiteralExtension(std::string const & previous, std::string const & pattern) const;
+      uint32_t Workers() const;
 
    private: //Ui::InputMode
       bool InputStringHandler(std::string input);
@@ -97,10 +122,19 @@ namespace Ui
       std::string         currentSearch_;
       bool                hasSearched_;
       bool                highlight_;
+      bool                cancelled_;
       char                prompt_[DirectionCount];
       Main::Settings &    settings_;
       Ui::Screen     &    screen_;
 
+      std::string                chunkSearch_;
+      Regex::Options             chunkOptions_;
+      Ui::ScrollWindow const *   chunkWindow_;
+      uint32_t                   chunkGeneration_;
+      uint32_t                   chunkLines_;
+      std::vector<ChunkState>    chunkState_;
+      std::vector<LineList>      chunkMatches_;
+
   };
 }
 
@@ -20,10 +20,13 @@
 
 #include "mpdclient.hpp"
 
+#include "algorithm.hpp"
 #include "assert.hpp"
 #include "events.hpp"
 #include "screen.hpp"
 #include "settings.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
 #include "vimpc.hpp"
 
 #include "buffer/playlist.hpp"
@@ -46,7 +49,9 @@ using namespace Mpc;
 //#define _DEBUG_ASSERT_ON_ERROR
 //#define _DEBUG_BREAK_ON_ERROR
 
-static std::list<FUNCTION<void()> >       Queue;
+typedef std::pair<char const *, FUNCTION<void()> > ClientCommand;
+
+static std::list<ClientCommand>            Queue;
 static Mutex                              QueueMutex;
 static Atomic(bool)                       Running(true);
 static ConditionVariable                  Condition;
@@ -120,6 +125,7 @@ Client::Client(Main::Vimpc * vimpc, Main::Settings & settings, Mpc::Lists & list
    currentSong_          (NULL),
    currentStatus_        (NULL),
    currentSongId_        (-1),
+   nextSongPos_          (-1),
    totalNumberOfSongs_   (0),
    currentSongURI_       (""),
    currentState_         ("Disconnected"),
@@ -141,19 +147,19 @@ Client::Client(Main::Vimpc * vimpc, Main::Settings & settings, Mpc::Lists & list
 
    Main::Vimpc::EventHandler(Event::PlaylistContentsForRemove, [this] (EventData const & Data)
    {
-      Mpc::CommandList list(*this);
+      std::vector<Mpc::Song *> songs;
 
-      for (auto uri : Data.uris)
+      for (auto uri : Data.Uris())
       {
          Mpc::Song * song = Main::Library().Song(uri);
 
-         int const PlaylistIndex = Main::Playlist().Index(song);
-
-         if (PlaylistIndex >= 0)
+         if (song != NULL)
          {
-            Delete(PlaylistIndex);
+            songs.push_back(song);
          }
       }
+
+      Delete(Main::Playlist().Positions(songs));
    });
 }
 
@@ -178,10 +184,10 @@ Client::~Client()
    DeleteConnection();
 }
 
-void Client::QueueCommand(FUNCTION<void()> const & function)
+void Client::QueueCommand(char const * name, FUNCTION<void()> const & function)
 {
    UniqueLock<Mutex> Lock(QueueMutex);
-   Queue.push_back(function);
+   Queue.push_back(ClientCommand(name, function));
    Condition.notify_all();
 }
 
@@ -202,7 +208,7 @@ void Client::WaitForCompletion()
 
 void Client::Connect(std::string const & hostname, uint16_t port, uint32_t timeout_ms)
 {
-   QueueCommand([this, hostname, port, timeout_ms] () { ConnectImpl(hostname, port, timeout_ms); });
+   QueueCommand("Connect", [this, hostname, port, timeout_ms] () { ConnectImpl(hostname, port, timeout_ms); });
    //ConnectImpl(hostname, port, timeout_ms);
 }
 
@@ -257,7 +263,7 @@ void Client::ConnectImpl(std::string const & hostname, uint16_t port, uint32_t t
 
       if (settings_.Get(Setting::Timeout) != "0")
       {
-         Debug("Client::Connect timeout " + settings_.Get(Setting::Timeout));
+         Debug("Client::Connect timeout %s", settings_.Get(Setting::Timeout));
          connect_timeout = atoi(settings_.Get(Setting::Timeout).c_str());
       }
       else if (timeout_env != NULL)
@@ -279,12 +285,12 @@ void Client::ConnectImpl(std::string const & hostname, uint16_t port, uint32_t t
    connection_ = NULL;
 
    EventData HostData;
-   HostData.hostname = hostname_;
-   HostData.port     = port_;
-   Main::Vimpc::CreateEvent(Event::ChangeHost, HostData);
+   HostData.name = hostname_;
+   HostData.port = port_;
+   Main::Vimpc::CreateEvent(Event::ChangeHost, std::move(HostData));
 
    //! \TODO make the connection async
-   Debug("Client::Connecting to %s:%u - timeout %u", connect_hostname.c_str(), connect_port, connect_timeout);
+   LogInfo("Client::Connecting to %s:%u - timeout %u", connect_hostname.c_str(), connect_port, connect_timeout);
    connection_ = mpd_connection_new(connect_hostname.c_str(), connect_port, connect_timeout);
 
    CheckError();
@@ -293,11 +299,10 @@ void Client::ConnectImpl(std::string const & hostname, uint16_t port, uint32_t t
    {
       fd_ = mpd_connection_get_fd(connection_);
 
-      Debug("Client::Connected.");
+      LogInfo("Client::Connected");
 
-      EventData Data;
-      Main::Vimpc::CreateEvent(Event::Connected, Data);
-      Main::Vimpc::CreateEvent(Event::Repaint,   Data);
+      Main::Vimpc::CreateEvent(Event::Connected);
+      Main::Vimpc::CreateEvent(Event::Repaint);
 
       GetVersion();
 
@@ -315,8 +320,7 @@ void Client::ConnectImpl(std::string const & hostname, uint16_t port, uint32_t t
       else
       {
          StateEvent();
-         EventData Data;
-         Main::Vimpc::CreateEvent(Event::RequirePassword, Data);
+         Main::Vimpc::CreateEvent(Event::RequirePassword);
       }
    }
    else
@@ -343,11 +347,11 @@ void Client::Initialise()
 
 void Client::Disconnect()
 {
-   QueueCommand([this] ()
+   QueueCommand("Disconnect", [this] ()
    {
       if (Connected() == true)
       {
-         Debug("Client::Disconnect");
+         LogInfo("Client::Disconnect");
          DeleteConnection();
       }
    });
@@ -355,7 +359,7 @@ void Client::Disconnect()
 
 void Client::Reconnect()
 {
-   QueueCommand([this] ()
+   QueueCommand("Reconnect", [this] ()
    {
       Debug("Client::Reconnect");
       Disconnect();
@@ -365,7 +369,7 @@ void Client::Reconnect()
 
 void Client::Password(std::string const & password)
 {
-   QueueCommand([this, password] ()
+   QueueCommand("Password", [this, password] ()
    {
       ClearCommand();
 
@@ -389,7 +393,7 @@ bool Client::Connected() const
 
 void Client::Play(uint32_t const playId)
 {
-   QueueCommand([this, playId] ()
+   QueueCommand("Play", [this, playId] ()
    {
       ClearCommand();
 
@@ -401,10 +405,10 @@ void Client::Play(uint32_t const playId)
          {
             currentSongId_ = playId;
             EventData IdData; IdData.id = currentSongId_;
-            Main::Vimpc::CreateEvent(Event::CurrentSongId, IdData);
+            Main::Vimpc::CreateEvent(Event::CurrentSongId, std::move(IdData));
 
             autoscroll_ = false;
-            Main::Vimpc::CreateEvent(Event::Autoscroll,    IdData);
+            Main::Vimpc::CreateEvent(Event::Autoscroll);
 
             state_ = MPD_STATE_PLAY;
             elapsed_ = 0;
@@ -422,7 +426,7 @@ void Client::Play(uint32_t const playId)
 
 void Client::AddComplete()
 {
-   QueueCommand([this] ()
+   QueueCommand("AddComplete", [this] ()
    {
       if ((state_ == MPD_STATE_STOP) && (settings_.Get(Setting::PlayOnAdd) == true))
       {
@@ -434,7 +438,7 @@ void Client::AddComplete()
 
 void Client::Pause()
 {
-   QueueCommand([this] ()
+   QueueCommand("Pause", [this] ()
    {
       ClearCommand();
 
@@ -467,7 +471,7 @@ void Client::Pause()
 
 void Client::Stop()
 {
-   QueueCommand([this] ()
+   QueueCommand("Stop", [this] ()
    {
       ClearCommand();
 
@@ -490,7 +494,7 @@ void Client::Stop()
 
 void Client::Next()
 {
-   QueueCommand([this] ()
+   QueueCommand("Next", [this] ()
    {
       ClearCommand();
 
@@ -510,7 +514,7 @@ void Client::Next()
 
 void Client::Previous()
 {
-   QueueCommand([this] ()
+   QueueCommand("Previous", [this] ()
    {
       ClearCommand();
 
@@ -530,7 +534,7 @@ void Client::Previous()
 
 void Client::Seek(int32_t Offset)
 {
-   QueueCommand([this, Offset] ()
+   QueueCommand("Seek", [this, Offset] ()
    {
       ClearCommand();
 
@@ -551,7 +555,7 @@ void Client::Seek(int32_t Offset)
 
 void Client::SeekTo(uint32_t Time)
 {
-   QueueCommand([this, Time] ()
+   QueueCommand("SeekTo", [this, Time] ()
    {
       ClearCommand();
 
@@ -572,7 +576,7 @@ void Client::SeekTo(uint32_t Time)
 
 void Client::SeekToPercent(double Percent)
 {
-   QueueCommand([this, Percent] ()
+   QueueCommand("SeekToPercent", [this, Percent] ()
    {
       if (currentSong_)
       {
@@ -587,7 +591,7 @@ void Client::SeekToPercent(double Percent)
 
 void Client::SetRandom(bool const random)
 {
-   QueueCommand([this, random] ()
+   QueueCommand("SetRandom", [this, random] ()
    {
       ClearCommand();
 
@@ -609,7 +613,7 @@ void Client::SetRandom(bool const random)
 
 void Client::SetSingle(bool const single)
 {
-   QueueCommand([this, single] ()
+   QueueCommand("SetSingle", [this, single] ()
    {
       ClearCommand();
 
@@ -631,7 +635,7 @@ void Client::SetSingle(bool const single)
 
 void Client::SetConsume(bool const consume)
 {
-   QueueCommand([this, consume] ()
+   QueueCommand("SetConsume", [this, consume] ()
    {
       ClearCommand();
 
@@ -653,7 +657,7 @@ void Client::SetConsume(bool const consume)
 
 void Client::SetRepeat(bool const repeat)
 {
-   QueueCommand([this, repeat] ()
+   QueueCommand("SetRepeat", [this, repeat] ()
    {
       ClearCommand();
 
@@ -675,7 +679,7 @@ void Client::SetRepeat(bool const repeat)
 
 void Client::SetCrossfade(bool crossfade)
 {
-   QueueCommand([this, crossfade] ()
+   QueueCommand("SetCrossfade", [this, crossfade] ()
    {
       if (crossfade == true)
       {
@@ -690,7 +694,7 @@ void Client::SetCrossfade(bool crossfade)
 
 void Client::SetCrossfade(uint32_t crossfade)
 {
-   QueueCommand([this, crossfade] ()
+   QueueCommand("SetCrossfade", [this, crossfade] ()
    {
       ClearCommand();
 
@@ -706,11 +710,11 @@ void Client::SetCrossfade(uint32_t crossfade)
             {
                crossfadeTime_ = crossfade;
                EventData Data; Data.value = crossfade;
-               Main::Vimpc::CreateEvent(Event::CrossfadeTime, Data);
+               Main::Vimpc::CreateEvent(Event::CrossfadeTime, std::move(Data));
             }
 
             EventData Data; Data.state = crossfade_;
-            Main::Vimpc::CreateEvent(Event::Crossfade, Data);
+            Main::Vimpc::CreateEvent(Event::Crossfade, std::move(Data));
          }
       }
       else
@@ -722,7 +726,7 @@ void Client::SetCrossfade(uint32_t crossfade)
 
 void Client::SetVolume(uint32_t volume)
 {
-   QueueCommand([this, volume] ()
+   QueueCommand("SetVolume", [this, volume] ()
    {
       ClearCommand();
 
@@ -735,7 +739,7 @@ void Client::SetVolume(uint32_t volume)
             volume_ = volume;
 
             EventData Data; Data.value = volume;
-            Main::Vimpc::CreateEvent(Event::Volume, Data);
+            Main::Vimpc::CreateEvent(Event::Volume, std::move(Data));
          }
       }
       else
@@ -747,7 +751,7 @@ void Client::SetVolume(uint32_t volume)
 
 void Client::SetMute(bool mute)
 {
-   QueueCommand([this, mute] ()
+   QueueCommand("SetMute", [this, mute] ()
    {
       if ((mute == true) && (mute_ == false))
       {
@@ -761,13 +765,13 @@ void Client::SetMute(bool mute)
 
       mute_ = mute;
       EventData Data; Data.state = mute_;
-      Main::Vimpc::CreateEvent(Event::Mute, Data);
+      Main::Vimpc::CreateEvent(Event::Mute, std::move(Data));
    });
 }
 
 void Client::DeltaVolume(int32_t Delta)
 {
-   QueueCommand([this, Delta] ()
+   QueueCommand("DeltaVolume", [this, Delta] ()
    {
       ClearCommand();
 
@@ -790,7 +794,7 @@ void Client::DeltaVolume(int32_t Delta)
          {
             volume_ = CurrentVolume;
             EventData Data; Data.value = CurrentVolume;
-            Main::Vimpc::CreateEvent(Event::Volume, Data);
+            Main::Vimpc::CreateEvent(Event::Volume, std::move(Data));
          }
       }
    });
@@ -798,7 +802,7 @@ void Client::DeltaVolume(int32_t Delta)
 
 void Client::ToggleRandom()
 {
-   QueueCommand([this] ()
+   QueueCommand("ToggleRandom", [this] ()
    {
       ClearCommand();
 
@@ -820,7 +824,7 @@ void Client::ToggleRandom()
 
 void Client::ToggleSingle()
 {
-   QueueCommand([this] ()
+   QueueCommand("ToggleSingle", [this] ()
    {
       ClearCommand();
 
@@ -842,7 +846,7 @@ void Client::ToggleSingle()
 
 void Client::ToggleConsume()
 {
-   QueueCommand([this] ()
+   QueueCommand("ToggleConsume", [this] ()
    {
       ClearCommand();
 
@@ -865,7 +869,7 @@ void Client::ToggleConsume()
 
 void Client::ToggleRepeat()
 {
-   QueueCommand([this] ()
+   QueueCommand("ToggleRepeat", [this] ()
    {
       ClearCommand();
 
@@ -887,7 +891,7 @@ void Client::ToggleRepeat()
 
 void Client::ToggleCrossfade()
 {
-   QueueCommand([this] ()
+   QueueCommand("ToggleCrossfade", [this] ()
    {
       if (crossfade_ == false)
       {
@@ -902,7 +906,7 @@ void Client::ToggleCrossfade()
 
 void Client::Shuffle()
 {
-   QueueCommand([this] ()
+   QueueCommand("Shuffle", [this] ()
    {
       ClearCommand();
 
@@ -920,7 +924,7 @@ void Client::Shuffle()
 
 void Client::Move(uint32_t position1, uint32_t position2)
 {
-   QueueCommand([this, position1, position2] ()
+   QueueCommand("Move", [this, position1, position2] ()
    {
       ClearCommand();
 
@@ -936,9 +940,90 @@ void Client::Move(uint32_t position1, uint32_t position2)
    });
 }
 
+void Client::Move(Algorithm::Moves const & moves)
+{
+   if (moves.empty() == true)
+   {
+      return;
+   }
+
+   QueueCommand("Move", [this, moves] ()
+   {
+      ClearCommand();
+
+      if (Connected() == true)
+      {
+         bool const startList = (listMode_ == false);
+
+         if ((startList == true) && (mpd_command_list_begin(connection_, false) == false))
+         {
+            CheckError();
+            return;
+         }
+
+         listMode_ = true;
+
+         Debug("Client::Send %u moves", static_cast<uint32_t>(moves.size()));
+
+         for (auto const & move : moves)
+         {
+            if (move.end - move.start == 1)
+            {
+               mpd_send_move(connection_, move.start, move.to);
+            }
+            else
+            {
+               mpd_send_move_range(connection_, move.start, move.end, move.to);
+            }
+
+            // Follow the current song to where it has been moved
+            if (currentSongId_ > -1)
+            {
+               uint32_t songId = static_cast<uint32_t>(currentSongId_);
+               uint32_t const count = move.end - move.start;
+
+               if ((songId >= move.start) && (songId < move.end))
+               {
+                  songId = move.to + (songId - move.start);
+               }
+               else
+               {
+                  songId -= (songId >= move.end) ? count : 0;
+                  songId += (songId >= move.to) ? count : 0;
+               }
+
+               currentSongId_ = songId;
+            }
+         }
+
+         if ((startList == true) && (mpd_command_list_end(connection_) == false))
+         {
+            CheckError();
+            return;
+         }
+
+         if (startList == true)
+         {
+            listMode_ = false;
+            Main::Vimpc::CreateEvent(Event::CommandListSend);
+         }
+
+         if (currentSongId_ > -1)
+         {
+            EventData IdData; IdData.id = currentSongId_;
+            Main::Vimpc::CreateEvent(Event::CurrentSongId, std::move(IdData));
+         }
+      }
+      else
+      {
+         ErrorString(ErrorNumber::ClientNoConnection);
+      }
+   });
+}
+
 void Client::Swap(uint32_t position1, uint32_t position2)
 {
-   QueueCommand([this, position1, position2] ()
+   QueueCommand("Swap", [this, position1, position2] ()
    {
       ClearCommand();
 
@@ -957,7 +1042,7 @@ void Client::Swap(uint32_t position1, uint32_t position2)
 
 void Client::CreatePlaylist(std::string const & name)
 {
-   QueueCommand([this, name] ()
+   QueueCommand("CreatePlaylist", [this, name] ()
    {
       ClearCommand();
 
@@ -968,8 +1053,8 @@ void Client::CreatePlaylist(std::string const & name)
          if (mpd_run_save(connection_, name.c_str()) == true)
          {
             EventData Data; Data.name = name;
-            Main::Vimpc::CreateEvent(Event::NewPlaylist, Data);
-            Main::Vimpc::CreateEvent(Event::Repaint,   Data);
+            Main::Vimpc::CreateEvent(Event::NewPlaylist, std::move(Data));
+            Main::Vimpc::CreateEvent(Event::Repaint);
          }
 
          Debug("Client::Send clear playlist %s", name.c_str());
@@ -1012,7 +1097,7 @@ void Client::SaveLoadedPlaylist()
 
 void Client::SavePlaylist(std::string const & name)
 {
-   QueueCommand([this, name] ()
+   QueueCommand("SavePlaylist", [this, name] ()
    {
       ClearCommand();
 
@@ -1029,7 +1114,7 @@ void Client::SavePlaylist(std::string const & name)
          if (mpd_run_save(connection_, name.c_str()) == true)
          {
             EventData Data; Data.name = name;
-            Main::Vimpc::CreateEvent(Event::NewPlaylist, Data);
+            Main::Vimpc::CreateEvent(Event::NewPlaylist, std::move(Data));
          }
       }
       else
@@ -1041,7 +1126,7 @@ void Client::SavePlaylist(std::string const & name)
 
 void Client::LoadPlaylist(std::string const & name)
 {
-   QueueCommand([this, name] ()
+   QueueCommand("LoadPlaylist", [this, name] ()
    {
       ClearCommand();
 
@@ -1061,7 +1146,7 @@ void Client::LoadPlaylist(std::string const & name)
 
 void Client::AppendPlaylist(std::string const & name)
 {
-   QueueCommand([this, name] ()
+   QueueCommand("AppendPlaylist", [this, name] ()
    {
       ClearCommand();
 
@@ -1080,7 +1165,7 @@ void Client::AppendPlaylist(std::string const & name)
 
 void Client::RemovePlaylist(std::string const & name)
 {
-   QueueCommand([this, name] ()
+   QueueCommand("RemovePlaylist", [this, name] ()
    {
       ClearCommand();
 
@@ -1100,7 +1185,7 @@ void Client::AddToNamedPlaylist(std::string const & name, Mpc::Song * song)
 {
    std::string URI = song->URI();
 
-   QueueCommand([this, name, URI] ()
+   QueueCommand("AddToNamedPlaylist", [this, name, URI] ()
    {
       ClearCommand();
 
@@ -1119,7 +1204,7 @@ void Client::AddToNamedPlaylist(std::string const & name, Mpc::Song * song)
 
 void Client::PlaylistContents(std::string const & name)
 {
-   QueueCommand([this, name] ()
+   QueueCommand("PlaylistContents", [this, name] ()
    {
       std::string const SongFormat = settings_.Get(Setting::SongFormat);
 
@@ -1153,7 +1238,7 @@ void Client::PlaylistContents(std::string const & name)
                        // Pre cache the print of the song
                        (void) song->FormatString(SongFormat);
                        EventData Data; Data.song = song;
-                       Main::Vimpc::CreateEvent(Event::DatabaseSong, Data);
+                       Main::Vimpc::CreateEvent(Event::DatabaseSong, std::move(Data));
                    }
                }
 
@@ -1161,8 +1246,8 @@ void Client::PlaylistContents(std::string const & name)
                mpd_song_free(nextSong);
             }
 
-            EventData Data; Data.name = name; Data.uris = URIs;
-            Main::Vimpc::CreateEvent(Event::PlaylistContents, Data);
+            EventData Data; Data.name = name; Data.Uris() = std::move(URIs);
+            Main::Vimpc::CreateEvent(Event::PlaylistContents, std::move(Data));
          }
       }
    });
@@ -1170,7 +1255,7 @@ void Client::PlaylistContents(std::string const & name)
 
 void Client::PlaylistContentsForRemove(std::string const & name)
 {
-   QueueCommand([this, name] ()
+   QueueCommand("PlaylistContentsForRemove", [this, name] ()
    {
       ClearCommand();
 
@@ -1192,8 +1277,8 @@ void Client::PlaylistContentsForRemove(std::string const & name)
                mpd_song_free(nextSong);
             }
 
-            EventData Data; Data.name = name; Data.uris = URIs;
-            Main::Vimpc::CreateEvent(Event::PlaylistContentsForRemove, Data);
+            EventData Data; Data.name = name; Data.Uris() = std::move(URIs);
+            Main::Vimpc::CreateEvent(Event::PlaylistContentsForRemove, std::move(Data));
          }
       }
    });
@@ -1215,7 +1300,7 @@ void Client::EnableOutput(Mpc::Output * output)
 {
    uint32_t Id = output->Id();
 
-   QueueCommand([this, Id] ()
+   QueueCommand("EnableOutput", [this, Id] ()
    {
       ClearCommand();
 
@@ -1226,8 +1311,8 @@ void Client::EnableOutput(Mpc::Output * output)
          if (mpd_run_enable_output(connection_, Id) == true)
          {
             EventData Data; Data.id = Id;
-            Main::Vimpc::CreateEvent(Event::OutputEnabled, Data);
-            Main::Vimpc::CreateEvent(Event::Repaint,   Data);
+            Main::Vimpc::CreateEvent(Event::OutputEnabled, std::move(Data));
+            Main::Vimpc::CreateEvent(Event::Repaint);
          }
       }
       else
@@ -1241,7 +1326,7 @@ void Client::DisableOutput(Mpc::Output * output)
 {
    uint32_t Id = output->Id();
 
-   QueueCommand([this, Id] ()
+   QueueCommand("DisableOutput", [this, Id] ()
    {
       ClearCommand();
 
@@ -1252,8 +1337,8 @@ void Client::DisableOutput(Mpc::Output * output)
          if (mpd_run_disable_output(connection_, Id) == true)
          {
             EventData Data; Data.id = Id;
-            Main::Vimpc::CreateEvent(Event::OutputDisabled, Data);
-            Main::Vimpc::CreateEvent(Event::Repaint,   Data);
+            Main::Vimpc::CreateEvent(Event::OutputDisabled, std::move(Data));
+            Main::Vimpc::CreateEvent(Event::Repaint);
          }
       }
       else
@@ -1272,55 +1357,73 @@ void Client::Add(Mpc::Song * song)
    }
 }
 
-void Client::Add(std::vector<Mpc::Song *> songs)
+void Client::Add(std::vector<Mpc::Song *> const & songs, int32_t position)
 {
+   if (songs.empty() == true)
+   {
+      return;
+   }
+
    std::vector<std::string> URIs;
+   URIs.reserve(songs.size());
 
    for (auto song : songs)
    {
       URIs.push_back(song->URI());
    }
 
-   QueueCommand([this, URIs] ()
+   QueueCommand("Add", [this, URIs, position] ()
    {
       ClearCommand();
 
       if (Connected() == true)
       {
-         if (mpd_command_list_begin(connection_, false) == true)
+         // Part of a list that has already been started is sent along with it
+         bool const startList = (listMode_ == false);
+
+         if ((startList == true) && (mpd_command_list_begin(connection_, false) == false))
          {
-            listMode_ = true;
+            CheckError();
+            return;
+         }
 
-            Debug("Client::List add started");
+         listMode_ = true;
 
-            for (auto URI : URIs)
-            {
-               mpd_send_add(connection_, URI.c_str());
-            }
+         Debug("Client::List add of %u songs at %d", static_cast<uint32_t>(URIs.size()), position);
 
-            if (mpd_command_list_end(connection_) == true)
+         for (uint32_t i = 0; i < URIs.size(); ++i)
+         {
+            if (position == -1)
             {
-               Debug("Client::List add success");
-               listMode_ = false;
-
-               for (auto URI : URIs)
-               {
-                  EventData Data; Data.uri = URI; Data.pos1 = -1;
-                  Main::Vimpc::CreateEvent(Event::PlaylistAdd, Data);
-               }
-
-               EventData Data;
-               Main::Vimpc::CreateEvent(Event::CommandListSend, Data);
-               Main::Vimpc::CreateEvent(Event::Repaint,   Data);
+               mpd_send_add(connection_, URIs[i].c_str());
             }
             else
             {
-               CheckError();
+               mpd_send_add_id_to(connection_, URIs[i].c_str(), position + i);
             }
          }
-         else
+
+         if ((startList == true) && (mpd_command_list_end(connection_) == false))
          {
             CheckError();
+            return;
+         }
+
+         if (startList == true)
+         {
+            listMode_ = false;
+            Main::Vimpc::CreateEvent(Event::CommandListSend);
+         }
+
+         EventData Data; Data.Uris() = URIs; Data.pos1 = position;
+         Main::Vimpc::CreateEvent(Event::PlaylistAddSongs, std::move(Data));
+         Main::Vimpc::CreateEvent(Event::Repaint);
+
+         if ((position != -1) && (currentSongId_ > -1) && (position <= currentSongId_))
+         {
+            currentSongId_ += URIs.size();
+            EventData IdData; IdData.id = currentSongId_;
+            Main::Vimpc::CreateEvent(Event::CurrentSongId, std::move(IdData));
          }
       }
       else
@@ -1334,7 +1437,7 @@ void Client::Add(Mpc::Song & song)
 {
    std::string URI = song.URI();
 
-   QueueCommand([this, URI] ()
+   QueueCommand("Add", [this, URI] ()
    {
       ClearCommand();
 
@@ -1343,8 +1446,8 @@ void Client::Add(Mpc::Song & song)
          //Debug("Client::Add song %s", URI.c_str());
          mpd_send_add(connection_, URI.c_str());
 
-         EventData Data; Data.uri = URI; Data.pos1 = -1;
-         Main::Vimpc::CreateEvent(Event::PlaylistAdd, Data);
+         EventData Data; Data.Uri() = URI; Data.pos1 = -1;
+         Main::Vimpc::CreateEvent(Event::PlaylistAdd, std::move(Data));
       }
       else
       {
@@ -1357,7 +1460,7 @@ void Client::Add(Mpc::Song & song, uint32_t position)
 {
    std::string URI = song.URI();
 
-   QueueCommand([this, URI, position] ()
+   QueueCommand("Add", [this, URI, position] ()
    {
       ClearCommand();
 
@@ -1366,14 +1469,14 @@ void Client::Add(Mpc::Song & song, uint32_t position)
          Debug("Client::Add song %s at %u", URI.c_str(), position);
          mpd_send_add_id_to(connection_, URI.c_str(), position);
 
-         EventData Data; Data.uri = URI; Data.pos1 = position;
-         Main::Vimpc::CreateEvent(Event::PlaylistAdd, Data);
+         EventData Data; Data.Uri() = URI; Data.pos1 = position;
+         Main::Vimpc::CreateEvent(Event::PlaylistAdd, std::move(Data));
 
          if ((currentSongId_ > -1) && (position <= static_cast<uint32_t>(currentSongId_)))
          {
             ++currentSongId_;
             EventData IdData; IdData.id = currentSongId_;
-            Main::Vimpc::CreateEvent(Event::CurrentSongId, IdData);
+            Main::Vimpc::CreateEvent(Event::CurrentSongId, std::move(IdData));
          }
       }
       else
@@ -1385,7 +1488,7 @@ void Client::Add(Mpc::Song & song, uint32_t position)
 
 void Client::AddAllSongs()
 {
-   QueueCommand([this] ()
+   QueueCommand("AddAllSongs", [this] ()
    {
       ClearCommand();
 
@@ -1403,7 +1506,7 @@ void Client::AddAllSongs()
 
 void Client::Add(std::string const & URI)
 {
-   QueueCommand([this, URI] ()
+   QueueCommand("Add", [this, URI] ()
    {
       ClearCommand();
 
@@ -1422,7 +1525,7 @@ void Client::Add(std::string const & URI)
 
 void Client::Delete(uint32_t position)
 {
-   QueueCommand([this, position] ()
+   QueueCommand("Delete", [this, position] ()
    {
       ClearCommand();
 
@@ -1437,7 +1540,7 @@ void Client::Delete(uint32_t position)
          {
             --currentSongId_;
             EventData IdData; IdData.id = currentSongId_;
-            Main::Vimpc::CreateEvent(Event::CurrentSongId, IdData);
+            Main::Vimpc::CreateEvent(Event::CurrentSongId, std::move(IdData));
          }
       }
       else if (Connected() == false)
@@ -1451,7 +1554,7 @@ void Client::Delete(uint32_t position)
 
 void Client::Delete(uint32_t position1, uint32_t position2)
 {
-   QueueCommand([this, position1, position2] ()
+   QueueCommand("Delete", [this, position1, position2] ()
    {
       // There might be an add in the queue, so we can't use the totalNumberOfSongs_ to determine
       // whether or not to do a delete
@@ -1490,7 +1593,7 @@ void Client::Delete(uint32_t position1, uint32_t position2)
                   }
 
                   EventData IdData; IdData.id = currentSongId_;
-                  Main::Vimpc::CreateEvent(Event::CurrentSongId, IdData);
+                  Main::Vimpc::CreateEvent(Event::CurrentSongId, std::move(IdData));
                }
             }
          }
@@ -1502,12 +1605,108 @@ void Client::Delete(uint32_t position1, uint32_t position2)
       }
    });
 
-   Main::Playlist().Remove(position1, position2 - position1);
+   if (position2 > position1)
+   {
+      Mpc::Song::ReferenceBatch batch;
+      Main::Playlist().Remove(Algorithm::Ranges(1, std::make_pair(position1, position2)));
+   }
+}
+
+void Client::Delete(std::vector<uint32_t> const & positions)
+{
+   Algorithm::Ranges const ranges = Algorithm::MergeRanges(positions);
+
+   if (ranges.empty() == true)
+   {
+      return;
+   }
+
+   QueueCommand("Delete", [this, ranges] ()
+   {
+      ClearCommand();
+
+      if (Connected() == true)
+      {
+         // Ranges are only supported from MPD 0.16
+         bool const useRange  = ((versionMajor_ > 0) || (versionMinor_ >= 16));
+         bool const startList = (listMode_ == false);
+
+         if ((startList == true) && (mpd_command_list_begin(connection_, false) == false))
+         {
+            CheckError();
+            return;
+         }
+
+         listMode_ = true;
+
+         Debug("Client::Delete %u ranges", static_cast<uint32_t>(ranges.size()));
+
+         // From the last range so that the positions of the ones before it still hold
+         for (auto range = ranges.rbegin(); range != ranges.rend(); ++range)
+         {
+            if (useRange == true)
+            {
+               mpd_send_delete_range(connection_, range->first, range->second);
+            }
+            else
+            {
+               for (uint32_t i = range->first; i < range->second; ++i)
+               {
+                  mpd_send_delete(connection_, range->first);
+               }
+            }
+         }
+
+         if ((startList == true) && (mpd_command_list_end(connection_) == false))
+         {
+            CheckError();
+            return;
+         }
+
+         if (startList == true)
+         {
+            listMode_ = false;
+            Main::Vimpc::CreateEvent(Event::CommandListSend);
+         }
+
+         if (currentSongId_ > -1)
+         {
+            uint32_t const songId  = static_cast<uint32_t>(currentSongId_);
+            uint32_t       removed = 0;
+
+            for (auto const & range : ranges)
+            {
+               if (range.second <= songId)
+               {
+                  removed += range.second - range.first;
+               }
+               else if (range.first <= songId)
+               {
+                  removed += songId - range.first;
+               }
+            }
+
+            if (removed > 0)
+            {
+               currentSongId_ -= removed;
+               EventData IdData; IdData.id = currentSongId_;
+               Main::Vimpc::CreateEvent(Event::CurrentSongId, std::move(IdData));
+            }
+         }
+      }
+      else
+      {
+         ErrorString(ErrorNumber::ClientNoConnection);
+      }
+   });
+
+   Mpc::Song::ReferenceBatch batch;
+   Main::Playlist().Remove(ranges);
 }
 
 void Client::Clear()
 {
-   QueueCommand([this] ()
+   QueueCommand("Clear", [this] ()
    {
       ClearCommand();
 
@@ -1526,7 +1725,7 @@ void Client::Clear()
 
 void Client::SearchAny(std::string const & search, bool exact)
 {
-   QueueCommand([this, search, exact] ()
+   QueueCommand("SearchAny", [this, search, exact] ()
    {
       ClearCommand();
 
@@ -1541,7 +1740,7 @@ void Client::SearchAny(std::string const & search, bool exact)
 
 void Client::SearchArtist(std::string const & search, bool exact)
 {
-   QueueCommand([this, search, exact] ()
+   QueueCommand("SearchArtist", [this, search, exact] ()
    {
       ClearCommand();
 
@@ -1556,7 +1755,7 @@ void Client::SearchArtist(std::string const & search, bool exact)
 
 void Client::SearchGenre(std::string const & search, bool exact)
 {
-   QueueCommand([this, search, exact] ()
+   QueueCommand("SearchGenre", [this, search, exact] ()
    {
       ClearCommand();
 
@@ -1572,7 +1771,7 @@ void Client::SearchGenre(std::string const & search, bool exact)
 
 void Client::SearchAlbum(std::string const & search, bool exact)
 {
-   QueueCommand([this, search, exact] ()
+   QueueCommand("SearchAlbum", [this, search, exact] ()
    {
       ClearCommand();
 
@@ -1587,7 +1786,7 @@ void Client::SearchAlbum(std::string const & search, bool exact)
 
 void Client::SearchSong(std::string const & search, bool exact)
 {
-   QueueCommand([this, search, exact] ()
+   QueueCommand("SearchSong", [this, search, exact] ()
    {
       ClearCommand();
 
@@ -1603,7 +1802,7 @@ void Client::SearchSong(std::string const & search, bool exact)
 
 void Client::AddAllSearchResults()
 {
-   QueueCommand([this] ()
+   QueueCommand("AddAllSearchResults", [this] ()
    {
       if (Connected())
       {
@@ -1635,7 +1834,7 @@ void Client::AddAllSearchResults()
 
 void Client::SearchResults(std::string const & name)
 {
-   QueueCommand([this, name] ()
+   QueueCommand("SearchResults", [this, name] ()
    {
       std::string const SongFormat = settings_.Get(Setting::SongFormat);
 
@@ -1670,15 +1869,15 @@ void Client::SearchResults(std::string const & name)
                        // Pre cache the print of the song
                        (void) song->FormatString(SongFormat);
                        EventData Data; Data.song = song;
-                       Main::Vimpc::CreateEvent(Event::DatabaseSong, Data);
+                       Main::Vimpc::CreateEvent(Event::DatabaseSong, std::move(Data));
                    }
                }
 
-               Data.uris.push_back(mpd_song_get_uri(nextSong));
+               Data.Uris().push_back(mpd_song_get_uri(nextSong));
                mpd_song_free(nextSong);
             }
 
-            Main::Vimpc::CreateEvent(Event::SearchResults, Data);
+            Main::Vimpc::CreateEvent(Event::SearchResults, std::move(Data));
          }
       }
    });
@@ -1707,14 +1906,14 @@ void Client::StateEvent()
       }
    }
 
-   EventData Data; Data.clientstate = currentState_;
-   Main::Vimpc::CreateEvent(Event::CurrentState, Data);
+   EventData Data; Data.name = currentState_;
+   Main::Vimpc::CreateEvent(Event::CurrentState, std::move(Data));
 }
 
 
 void Client::Rescan(std::string const & Path)
 {
-   QueueCommand([this, Path] ()
+   QueueCommand("Rescan", [this, Path] ()
    {
       ClearCommand();
 
@@ -1726,8 +1925,7 @@ void Client::Rescan(std::string const & Path)
          {
             updating_ = true;
 
-            EventData Data;
-            Main::Vimpc::CreateEvent(Event::Update, Data);
+            Main::Vimpc::CreateEvent(Event::Update);
          }
       }
       else
@@ -1739,7 +1937,7 @@ void Client::Rescan(std::string const & Path)
 
 void Client::Update(std::string const & Path)
 {
-   QueueCommand([this, Path] ()
+   QueueCommand("Update", [this, Path] ()
    {
       ClearCommand();
 
@@ -1751,8 +1949,7 @@ void Client::Update(std::string const & Path)
          {
             updating_ = true;
 
-            EventData Data;
-            Main::Vimpc::CreateEvent(Event::Update, Data);
+            Main::Vimpc::CreateEvent(Event::Update);
          }
       }
       else
@@ -1777,7 +1974,7 @@ void Client::IncrementTime(long time)
             elapsed_ = mpdelapsed_ + (timeSinceUpdate_ / 1000);
 
             EventData EData; EData.value = elapsed_;
-            Main::Vimpc::CreateEvent(Event::Elapsed, EData);
+            Main::Vimpc::CreateEvent(Event::Elapsed, std::move(EData));
          }
       }
 
@@ -1803,14 +2000,14 @@ void Client::IdleMode()
 
       if ((Connected() == true))
       {
+         Main::Trace::Span Span("mpd", "idle");
          if (mpd_send_idle(connection_) == true)
          {
             Debug("Client::Enter idle mode");
 
             idleMode_ = true;
 
-            EventData Data;
-            Main::Vimpc::CreateEvent(Event::IdleMode, Data);
+            Main::Vimpc::CreateEvent(Event::IdleMode);
          }
       }
    }
@@ -1820,6 +2017,7 @@ void Client::ExitIdleMode()
 {
    if ((idleMode_ == true) && (Connected() == true))
    {
+      Main::Trace::Span Span("mpd", "noidle");
       mpd_send_noidle(connection_);
 
       if (mpd_recv_idle(connection_, false) != 0)
@@ -1832,8 +2030,7 @@ void Client::ExitIdleMode()
 
       idleMode_ = false;
 
-      EventData Data;
-      Main::Vimpc::CreateEvent(Event::StopIdleMode, Data);
+      Main::Vimpc::CreateEvent(Event::StopIdleMode);
    }
 }
 
@@ -1850,9 +2047,9 @@ void Client::CheckForEvents()
       {
          idleMode_ = false;
 
-         EventData Data;
-         Main::Vimpc::CreateEvent(Event::StopIdleMode, Data);
+         Main::Vimpc::CreateEvent(Event::StopIdleMode);
 
+         Main::Trace::Span Span("mpd", "idle events");
          if (mpd_recv_idle(connection_, false) != 0)
          {
             UpdateStatus();
@@ -1882,6 +2079,7 @@ void Client::UpdateCurrentSong()
             currentSongURI_ = "";
          }
 
+         Main::Trace::Span Span("mpd", "currentsong");
          Debug("Client::Send get current song");
          currentSong_ = mpd_run_current_song(connection_);
          CheckError();
@@ -1902,23 +2100,25 @@ void Client::UpdateCurrentSong()
    }
 
    EventData IdData; IdData.id = currentSongId_;
-   Main::Vimpc::CreateEvent(Event::CurrentSongId, IdData);
+   Main::Vimpc::CreateEvent(Event::CurrentSongId, std::move(IdData));
 
    if (autoscroll_ == true)
    {
-      Main::Vimpc::CreateEvent(Event::Autoscroll, IdData);
+      Main::Vimpc::CreateEvent(Event::Autoscroll);
       autoscroll_ = false;
    }
 
    if (currentSong_ != NULL)
    {
       EventData SongData; SongData.currentSong = mpd_song_dup(currentSong_);
-      Main::Vimpc::CreateEvent(Event::CurrentSong, SongData);
+      Main::Vimpc::CreateEvent(Event::CurrentSong, std::move(SongData));
    }
 }
 
 void Client::ClientQueueExecutor(Mpc::Client * client)
 {
+   Main::Trace::NameThread("client");
+
    struct timeval start, end;
    gettimeofday(&start, NULL);
 
@@ -1939,12 +2139,18 @@ void Client::ClientQueueExecutor(Mpc::Client * client)
          {
             if (Queue.empty() == false)
             {
-               FUNCTION<void()> function = Queue.front();
+               ClientCommand const command = Queue.front();
                Queue.pop_front();
                Lock.unlock();
 
                ExitIdleMode();
-               function();
+
+               {
+                  Main::Stats::Timer Timer(Main::Stats::Instance().Command(command.first));
+                  Main::Trace::Span  Span("client", command.first);
+                  command.second();
+               }
+
                continue;
             }
          }
@@ -1958,6 +2164,8 @@ void Client::ClientQueueExecutor(Mpc::Client * client)
             if (queueUpdate_ == true)
             {
                Lock.unlock();
+               Main::Stats::Timer Timer(Main::Stats::Instance().Command("QueueMetaChanges"));
+               Main::Trace::Span  Span("client", "QueueMetaChanges");
                QueueMetaChanges();
             }
             else if (idleMode_ == false)
@@ -1982,6 +2190,7 @@ void Client::ClearCommand()
 
    if ((listMode_ == false) && (idleMode_ == false) && (Connected() == true))
    {
+      Main::Trace::Span Span("mpd", "response");
       Debug("Client::Finish the response");
       mpd_response_finish(connection_);
       CheckError();
@@ -2033,11 +2242,11 @@ void Client::GetAllMetaInformation()
 
    if (Connected() == true)
    {
-      EventData DBData;
-      Main::Vimpc::CreateEvent(Event::ClearDatabase, DBData);
+      Main::Vimpc::CreateEvent(Event::ClearDatabase);
 
       Debug("Client::Get all meta information");
 
+      Main::Trace::Span Span("mpd", "listallinfo");
       if ((settings_.Get(Setting::ListAllMeta) == true))
       {
           mpd_send_list_all_meta(connection_, NULL);
@@ -2088,7 +2297,7 @@ void Client::GetAllMetaInformation()
 
    if (error_)
    {
-       Debug("List all failed, disabling\n");
+       LogWarning("List all failed, disabling");
        Error(ErrorNumber::ErrorClear, "");
        ErrorString(ErrorNumber::ClientNoMeta, "not supported on server");
        settings_.Set(Setting::ListAllMeta, false);
@@ -2096,7 +2305,7 @@ void Client::GetAllMetaInformation()
 
    EventData DatabaseEvent;
    DatabaseEvent.state = (settings_.Get(Setting::ListAllMeta));
-   Main::Vimpc::CreateEvent(Event::DatabaseEnabled, DatabaseEvent);
+   Main::Vimpc::CreateEvent(Event::DatabaseEnabled, std::move(DatabaseEvent));
 
    if (Connected() == true)
    {
@@ -2107,19 +2316,19 @@ void Client::GetAllMetaInformation()
          // Pre cache the print of the song
          (void) song->FormatString(SongFormat);
          EventData Data; Data.song = song;
-         Main::Vimpc::CreateEvent(Event::DatabaseSong, Data);
+         Main::Vimpc::CreateEvent(Event::DatabaseSong, std::move(Data));
       }
 
       for (auto path : paths)
       {
-         EventData Data; Data.uri = path;
-         Main::Vimpc::CreateEvent(Event::DatabasePath, Data);
+         EventData Data; Data.Uri() = path;
+         Main::Vimpc::CreateEvent(Event::DatabasePath, std::move(Data));
       }
 
       for (auto list : lists)
       {
-         EventData Data; Data.name = list.first; Data.uri = list.second;
-         Main::Vimpc::CreateEvent(Event::DatabaseListFile, Data);
+         EventData Data; Data.name = list.first; Data.Uri() = list.second;
+         Main::Vimpc::CreateEvent(Event::DatabaseListFile, std::move(Data));
       }
    }
 
@@ -2127,6 +2336,7 @@ void Client::GetAllMetaInformation()
 
    if (Connected() == true)
    {
+      Main::Trace::Span Span("mpd", "playlistinfo");
       Debug("Client::List queue meta data");
       mpd_send_list_queue_meta(connection_);
 
@@ -2134,10 +2344,10 @@ void Client::GetAllMetaInformation()
 
       for (; nextSong != NULL; nextSong = mpd_recv_song(connection_))
       {
-         EventData Data; Data.song = NULL; Data.uri = mpd_song_get_uri(nextSong); Data.pos1 = -1;
+         EventData Data; Data.song = NULL; Data.Uri() = mpd_song_get_uri(nextSong); Data.pos1 = -1;
 
          if (((settings_.Get(Setting::ListAllMeta) == false) &&
-              (Main::Library().Song(Data.uri) == NULL)) ||
+              (Main::Library().Song(Data.Uri()) == NULL)) ||
              // Handle "virtual" songs embedded within files
              (mpd_song_get_end(nextSong) != 0))
          {
@@ -2149,7 +2359,7 @@ void Client::GetAllMetaInformation()
             }
          }
 
-         Main::Vimpc::CreateEvent(Event::PlaylistAdd, Data);
+         Main::Vimpc::CreateEvent(Event::PlaylistAdd, std::move(Data));
 
          mpd_song_free(nextSong);
       }
@@ -2165,7 +2375,7 @@ void Client::GetAllMetaInformation()
             // Pre cache the print of the song
             (void) song->FormatString(SongFormat);
             EventData Data; Data.song = song;
-            Main::Vimpc::CreateEvent(Event::DatabaseSong, Data);
+            Main::Vimpc::CreateEvent(Event::DatabaseSong, std::move(Data));
          }
       }
    }
@@ -2179,6 +2389,7 @@ void Client::GetAllMetaInformation()
       {
          Debug("Client::Request playlists");
 
+         Main::Trace::Span Span("mpd", "listplaylists");
          if (mpd_send_list_playlists(connection_))
          {
             mpd_playlist * nextPlaylist = mpd_recv_playlist(connection_);
@@ -2187,8 +2398,8 @@ void Client::GetAllMetaInformation()
             {
                std::string const playlist = mpd_playlist_get_path(nextPlaylist);
 
-               EventData Data; Data.uri = playlist; Data.name = playlist;
-               Main::Vimpc::CreateEvent(Event::DatabaseList, Data);
+               EventData Data; Data.Uri() = playlist; Data.name = playlist;
+               Main::Vimpc::CreateEvent(Event::DatabaseList, std::move(Data));
 
                mpd_playlist_free(nextPlaylist);
             }
@@ -2201,9 +2412,8 @@ void Client::GetAllMetaInformation()
 
    if (Connected() == true)
    {
-      EventData Data;
-      Main::Vimpc::CreateEvent(Event::AllMetaDataReady, Data);
-      Main::Vimpc::CreateEvent(Event::Repaint,   Data);
+      Main::Vimpc::CreateEvent(Event::AllMetaDataReady);
+      Main::Vimpc::CreateEvent(Event::Repaint);
    }
 
 #if !LIBMPDCLIENT_CHECK_VERSION(2,5,0)
@@ -2213,12 +2423,13 @@ void Client::GetAllMetaInformation()
 
 void Client::GetAllOutputs()
 {
-   QueueCommand([this] ()
+   QueueCommand("GetAllOutputs", [this] ()
    {
       ClearCommand();
 
       if (Connected() == true)
       {
+         Main::Trace::Span Span("mpd", "outputs");
          Debug("Client::Get outputs");
          mpd_send_outputs(connection_);
 
@@ -2232,14 +2443,13 @@ void Client::GetAllOutputs()
             output->SetName(mpd_output_get_name(next));
 
             EventData Data; Data.output = output;
-            Main::Vimpc::CreateEvent(Event::Output, Data);
+            Main::Vimpc::CreateEvent(Event::Output, std::move(Data));
 
             mpd_output_free(next);
          }
 
          Debug("Client::Get outputs complete");
-         EventData Data;
-         Main::Vimpc::CreateEvent(Event::Repaint,Data);
+         Main::Vimpc::CreateEvent(Event::Repaint);
       }
    });
 }
@@ -2252,6 +2462,7 @@ void Client::GetAllMetaFromRoot()
 
    if (Connected() == true)
    {
+      Main::Trace::Span Span("mpd", "lsinfo");
       Debug("Client::Get all root meta");
       mpd_send_list_meta(connection_, "/");
 
@@ -2273,8 +2484,8 @@ void Client::GetAllMetaFromRoot()
                   name = name.substr(name.find_last_of("/") + 1);
                }
 
-               EventData Data; Data.uri = path; Data.name = name;
-               Main::Vimpc::CreateEvent(Event::DatabaseList, Data);
+               EventData Data; Data.Uri() = path; Data.name = name;
+               Main::Vimpc::CreateEvent(Event::DatabaseList, std::move(Data));
             }
          }
 
@@ -2288,7 +2499,7 @@ void Client::GetAllMetaFromRoot()
 
 void Client::StartCommandList()
 {
-   QueueCommand([this] ()
+   QueueCommand("StartCommandList", [this] ()
    {
       ClearCommand();
 
@@ -2302,7 +2513,7 @@ void Client::StartCommandList()
          }
          else
          {
-            Debug("Client::Start command list failed");
+            LogWarning("Client::Start command list failed");
             CheckError();
          }
       }
@@ -2311,7 +2522,7 @@ void Client::StartCommandList()
 
 void Client::SendCommandList()
 {
-   QueueCommand([this] ()
+   QueueCommand("SendCommandList", [this] ()
    {
       if ((Connected() == true) && (listMode_ == true))
       {
@@ -2320,13 +2531,12 @@ void Client::SendCommandList()
          if (mpd_command_list_end(connection_) == true)
          {
             listMode_ = false;
-            EventData Data;
-            Main::Vimpc::CreateEvent(Event::CommandListSend, Data);
-            Main::Vimpc::CreateEvent(Event::Repaint,   Data);
+            Main::Vimpc::CreateEvent(Event::CommandListSend);
+            Main::Vimpc::CreateEvent(Event::Repaint);
          }
          else
          {
-            Debug("Client::End command list failed");
+            LogWarning("Client::End command list failed");
             CheckError();
          }
       }
@@ -2344,12 +2554,12 @@ void Client::SetStateAndEvent(int event, bool & state, bool value)
 {
    state = value;
    EventData Data; Data.state = value;
-   Main::Vimpc::CreateEvent(event, Data);
+   Main::Vimpc::CreateEvent(event, std::move(Data));
 }
 
 void Client::UpdateStatus(bool ExpectUpdate)
 {
-   QueueCommand([this, ExpectUpdate] ()
+   QueueCommand("UpdateStatus", [this, ExpectUpdate] ()
    {
       ClearCommand();
 
@@ -2361,6 +2571,7 @@ void Client::UpdateStatus(bool ExpectUpdate)
             currentStatus_ = NULL;
          }
 
+         Main::Trace::Span Span("mpd", "status");
          Debug("Client::Get current status");
          struct mpd_status * status = mpd_run_status(connection_);
          CheckError();
@@ -2379,7 +2590,7 @@ void Client::UpdateStatus(bool ExpectUpdate)
                volume_ = mpd_status_get_volume(currentStatus_);
 
                EventData Data; Data.value = volume_;
-               Main::Vimpc::CreateEvent(Event::Volume, Data);
+               Main::Vimpc::CreateEvent(Event::Volume, std::move(Data));
             }
 
             if (updating_ != (mpd_status_get_update_id(currentStatus_) >= 1))
@@ -2388,8 +2599,7 @@ void Client::UpdateStatus(bool ExpectUpdate)
 
                if (updating_ == true)
                {
-                  EventData Data;
-                  Main::Vimpc::CreateEvent(Event::Update, Data);
+                  Main::Vimpc::CreateEvent(Event::Update);
                }
             }
 
@@ -2418,14 +2628,14 @@ void Client::UpdateStatus(bool ExpectUpdate)
                totalNumberOfSongs_ = mpd_status_get_queue_length(currentStatus_);
 
                EventData Data; Data.count = totalNumberOfSongs_;
-               Main::Vimpc::CreateEvent(Event::TotalSongCount, Data);
+               Main::Vimpc::CreateEvent(Event::TotalSongCount, std::move(Data));
             }
 
             if (crossfade_ != (mpd_status_get_crossfade(currentStatus_) > 0))
             {
                crossfade_ = (mpd_status_get_crossfade(currentStatus_) > 0);
                EventData Data; Data.state = crossfade_;
-               Main::Vimpc::CreateEvent(Event::Crossfade, Data);
+               Main::Vimpc::CreateEvent(Event::Crossfade, std::move(Data));
             }
 
             if (crossfade_ == true)
@@ -2434,10 +2644,19 @@ void Client::UpdateStatus(bool ExpectUpdate)
                {
                   crossfadeTime_ = mpd_status_get_crossfade(currentStatus_);
                   EventData Data; Data.value = crossfadeTime_;
-                  Main::Vimpc::CreateEvent(Event::CrossfadeTime, Data);
+                  Main::Vimpc::CreateEvent(Event::CrossfadeTime, std::move(Data));
                }
             }
 
+            // In random mode only mpd knows which song will be played next
+            if (nextSongPos_ != mpd_status_get_next_song_pos(currentStatus_))
+            {
+               nextSongPos_ = mpd_status_get_next_song_pos(currentStatus_);
+
+               EventData Data; Data.value = nextSongPos_;
+               Main::Vimpc::CreateEvent(Event::NextSongPos, std::move(Data));
+            }
+
             // Check if we need to update the current song
             if ((mpdstate_ != mpd_status_get_state(currentStatus_)) ||
                ((mpdstate_ != MPD_STATE_STOP) && (currentSong_ == NULL)) ||
@@ -2466,9 +2685,9 @@ void Client::UpdateStatus(bool ExpectUpdate)
                currentSongURI_ = "";
 
                EventData IdData; IdData.id = currentSongId_;
-               Main::Vimpc::CreateEvent(Event::CurrentSongId, IdData);
+               Main::Vimpc::CreateEvent(Event::CurrentSongId, std::move(IdData));
                EventData Data; Data.currentSong = NULL;
-               Main::Vimpc::CreateEvent(Event::CurrentSong, Data);
+               Main::Vimpc::CreateEvent(Event::CurrentSong, std::move(Data));
             }
 
             if (mpdstate_ != MPD_STATE_PLAY)
@@ -2477,7 +2696,7 @@ void Client::UpdateStatus(bool ExpectUpdate)
             }
 
             EventData EData; EData.value = elapsed_;
-            Main::Vimpc::CreateEvent(Event::Elapsed, EData);
+            Main::Vimpc::CreateEvent(Event::Elapsed, std::move(EData));
 
             if ((queueVersion_ > -1) && (version > qVersion) && (queueUpdate_ == false))
             {
@@ -2490,9 +2709,8 @@ void Client::UpdateStatus(bool ExpectUpdate)
                GetAllMetaInformation();
                UpdateCurrentSong();
 
-               EventData Data;
-               Main::Vimpc::CreateEvent(Event::UpdateComplete, Data);
-               Main::Vimpc::CreateEvent(Event::Repaint,   Data);
+               Main::Vimpc::CreateEvent(Event::UpdateComplete);
+               Main::Vimpc::CreateEvent(Event::Repaint);
             }
 
             queueVersion_ = version;
@@ -2530,6 +2748,7 @@ void Client::QueueMetaChanges()
 
    if (Connected() == true)
    {
+      Main::Trace::Span Span("mpd", "status");
       struct mpd_status * status = mpd_run_status(connection_);
       queueVersion_ = mpd_status_get_queue_version(status);
 
@@ -2538,11 +2757,12 @@ void Client::QueueMetaChanges()
          totalNumberOfSongs_ = mpd_status_get_queue_length(status);
 
          EventData Data; Data.count = totalNumberOfSongs_;
-         Main::Vimpc::CreateEvent(Event::TotalSongCount, Data);
+         Main::Vimpc::CreateEvent(Event::TotalSongCount, std::move(Data));
       }
 
       if (oldVersion_ != queueVersion_)
       {
+         Main::Trace::Span Span("mpd", "plchanges");
          Debug("Client::List queue meta data changes %d %d", oldVersion_, queueVersion_);
          mpd_send_queue_changes_meta(connection_, oldVersion_);
 
@@ -2555,7 +2775,7 @@ void Client::QueueMetaChanges()
             Song * newSong = NULL;
 
             if (((settings_.Get(Setting::ListAllMeta) == false) &&
-                 (Main::Library().Song(Data.uri) == NULL)) ||
+                 (Main::Library().Song(mpd_song_get_uri(nextSong)) == NULL)) ||
                 // Handle "virtual" songs embedded within files
                 (mpd_song_get_end(nextSong) != 0))
             {
@@ -2563,7 +2783,7 @@ void Client::QueueMetaChanges()
             }
 
             //Debug("Change: %d %s", mpd_song_get_pos(nextSong), mpd_song_get_uri(nextSong));
-            Data.posuri.push_back(std::make_pair(mpd_song_get_pos(nextSong), std::make_pair(newSong, mpd_song_get_uri(nextSong))));
+            Data.PosUri().push_back(std::make_pair(mpd_song_get_pos(nextSong), std::make_pair(newSong, mpd_song_get_uri(nextSong))));
             mpd_song_free(nextSong);
          }
 
@@ -2575,10 +2795,9 @@ void Client::QueueMetaChanges()
 
             oldVersion_  = queueVersion_;
             queueUpdate_ = false;
-            Main::Vimpc::CreateEvent(Event::PlaylistQueueReplace, Data);
+            Main::Vimpc::CreateEvent(Event::PlaylistQueueReplace, std::move(Data));
 
-            EventData QueueData;
-            Main::Vimpc::CreateEvent(Event::QueueUpdate, QueueData);
+            Main::Vimpc::CreateEvent(Event::QueueUpdate);
 
             UpdateCurrentSong();
          }
@@ -2609,8 +2828,8 @@ void Client::GetVersion()
          versionMinor_ = version[1];
          versionPatch_ = version[2];
 
-         Debug("libmpdclient: %d.%d.%d", LIBMPDCLIENT_MAJOR_VERSION, LIBMPDCLIENT_MINOR_VERSION, LIBMPDCLIENT_PATCH_VERSION);
-         Debug("MPD Server  : %d.%d.%d", versionMajor_, versionMinor_, versionPatch_);
+         LogInfo("libmpdclient: %d.%d.%d", LIBMPDCLIENT_MAJOR_VERSION, LIBMPDCLIENT_MINOR_VERSION, LIBMPDCLIENT_PATCH_VERSION);
+         LogInfo("MPD Server  : %d.%d.%d", versionMajor_, versionMinor_, versionPatch_);
       }
    }
 }
@@ -2625,7 +2844,7 @@ bool Client::CheckError()
          snprintf(error, 255, "MPD Error: %s",  mpd_connection_get_error_message(connection_));
          Error(ErrorNumber::ClientError, error);
 
-         Debug("Client::%s", error);
+         LogError("Client::%s", error);
 
 #ifdef _DEBUG_ASSERT_ON_ERROR
          ASSERT(false);
@@ -2638,7 +2857,7 @@ bool Client::CheckError()
 
          if (ClearError == false)
          {
-            Debug("Client::Unable to clear error");
+            LogError("Client::Unable to clear error");
             DeleteConnection();
 
             if ((settings_.Get(Setting::Reconnect) == true) && (retried_ == false))
@@ -2675,6 +2894,7 @@ void Client::DeleteConnection()
    state_        = MPD_STATE_UNKNOWN;
 
    totalNumberOfSongs_ = 0;
+   nextSongPos_        = -1;
 
    versionMajor_ = -1;
    versionMinor_ = -1;
@@ -2695,8 +2915,7 @@ void Client::DeleteConnection()
       fd_         = -1;
    }
 
-   EventData Data;
-   Main::Vimpc::CreateEvent(Event::Disconnected, Data);
+   Main::Vimpc::CreateEvent(Event::Disconnected);
 
    ENSURE(connection_ == NULL);
 }
@@ -24,6 +24,7 @@
 
 #include <mpd/client.h>
 
+#include "algorithm.hpp"
 #include "compiler.hpp"
 #include "output.hpp"
 #include "screen.hpp"
@@ -96,7 +97,8 @@ namespace Mpc
       ~Client();
 
    public:
-      void QueueCommand(FUNCTION<void()> const & function);
+      //! The name is used to group the command's timings in the stats window
+      void QueueCommand(char const * name, FUNCTION<void()> const & function);
       void WaitForCompletion();
 
    private:
@@ -145,6 +147,9 @@ namespace Mpc
       // Playlist editing
       void Shuffle();
       void Move(uint32_t position1, uint32_t position2);
+
+      //! Applies the moves in turn in one command list
+      void Move(Algorithm::Moves const & moves);
       void Swap(uint32_t position1, uint32_t position2);
 
    public:
@@ -171,7 +176,8 @@ namespace Mpc
    public:
       // Queue manipulation
       void Add(Mpc::Song * song);
-      void Add(std::vector<Mpc::Song *> song);
+      //! Adds the songs in one command list, in order from the position or at the end if it is -1
+      void Add(std::vector<Mpc::Song *> const & songs, int32_t position = -1);
       void Add(Mpc::Song & song);
       void Add(Mpc::Song & song, uint32_t position);
       void AddAllSongs();
@@ -186,6 +192,9 @@ namespace Mpc
 
       void Delete(uint32_t position);
       void Delete(uint32_t position1, uint32_t position2);
+
+      //! Deletes the positions as the fewest ranges, from the last, in one command list
+      void Delete(std::vector<uint32_t> const & positions);
       void Clear();
 
    public:
@@ -270,6 +279,7 @@ namespace Mpc
       struct mpd_song *       currentSong_;
       struct mpd_status *     currentStatus_;
       int32_t                 currentSongId_;
+      int32_t                 nextSongPos_;
       uint32_t                totalNumberOfSongs_;
       std::string             currentSongURI_;
       std::string             currentState_;
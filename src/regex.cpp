@@ -18,32 +18,87 @@
    regex.hpp - C++ wrapper around pcre and/or other regex libraries
 */
 
+#include <list>
 #include <map>
 
+#include "compiler.hpp"
 #include "regex.hpp"
 #include "window/debug.hpp"
 
 using namespace Regex;
 
+typedef std::pair<std::string, int> PatternKey;
+
+class RE::Pattern
+{
+   public:
+      Pattern(PatternKey const & key) : key_(key), re_(NULL), extra_(NULL), references_(0) { }
+
+      ~Pattern()
+      {
+         if (extra_ != NULL)
+         {
+            pcre_free_study(extra_);
+         }
+
+         if (re_ != NULL)
+         {
+            pcre_free(re_);
+         }
+      }
+
+   private:
+      Pattern(Pattern const & pattern);
+      Pattern & operator=(Pattern const & pattern);
+
+   public:
+      PatternKey const key_;
+      pcre *           re_;
+      pcre_extra *     extra_;
+      uint32_t         references_;
+};
+
+// Patterns that no RE uses any more are kept in case the same pattern is
+// constructed again, only the most recently used MaxUnused of them are kept
+class RE::Cache
+{
+   public:
+      static uint32_t const MaxUnused = 64;
+
+      std::map<PatternKey, Pattern *> patterns_;
+      std::list<Pattern *>            unused_;
+      Mutex                           mutex_;
+};
+
+
 RE::RE(std::string exp) :
     exp_     (exp),
-    compiled_(""),
     opt_     (Regex::None),
-    re_      (NULL)
+    match_   (Acquire(exp_, opt_)),
+    complete_(NULL)
 {
 }
 
 RE::RE(std::string exp, Regex::Options opt) :
     exp_     (exp),
-    compiled_(""),
     opt_     (opt),
-    re_      (NULL)
+    match_   (Acquire(exp_, opt_)),
+    complete_(NULL)
+{
+}
+
+RE::RE(RE const & re) :
+    exp_     (re.exp_),
+    opt_     (re.opt_),
+    match_   (Retain(re.match_)),
+    complete_(Retain(__atomic_load_n(&re.complete_, __ATOMIC_ACQUIRE)))
 {
 }
 
 RE::~RE()
 {
-   Free();
+   Release(match_);
+   Release(complete_);
 }
 
 
@@ -56,30 +111,121 @@ RE::~RE()
 	end.Replace("", input);
 }
 
-void RE::Compile(std::string toCompile) const
+/* static */ RE::Cache & RE::Patterns()
+{
+   static Cache Patterns;
+   return Patterns;
+}
+
+/* static */ RE::Pattern * RE::Acquire(std::string const & exp, Regex::Options opt)
 {
+   // The same pattern is often constructed many thousands of times,
+   // so it is only compiled again if it has fallen out of the cache
+   Cache & cache = Patterns();
+   UniqueLock<Mutex> Lock(cache.mutex_);
+
+   PatternKey const key(exp, static_cast<int>(opt));
+   auto const it = cache.patterns_.find(key);
+
+   if (it != cache.patterns_.end())
+   {
+      Pattern * const pattern = it->second;
+
+      if (pattern->references_ == 0)
+      {
+         cache.unused_.remove(pattern);
+      }
+
+      ++pattern->references_;
+      return pattern;
+   }
+
    char const * error;
    int erroffset;
 
-   if (toCompile != compiled_)
+   Pattern * const pattern = new Pattern(key);
+   pattern->references_ = 1;
+   cache.patterns_[key] = pattern;
+
+   Debug("Doing PCRE compilation on %s", exp.c_str());
+   pattern->re_ = pcre_compile(exp.c_str(), opt, &error, &erroffset, NULL);
+
+   if (pattern->re_ == NULL)
    {
-       Free();
+      LogWarning("PCRE compilation failed at offset %d: %s\n", erroffset, error);
+   }
+   else
+   {
+#ifdef PCRE_STUDY_JIT_COMPILE
+      pattern->extra_ = pcre_study(pattern->re_, PCRE_STUDY_JIT_COMPILE, &error);
+#else
+      pattern->extra_ = pcre_study(pattern->re_, 0, &error);
+#endif
 
-       if (re_ == NULL)
-       {
-           Debug("Doing PCRE compilation on %s", exp_.c_str());
-           re_ = pcre_compile(toCompile.c_str(), opt_, &error, &erroffset, NULL);
-
-           if (re_ == NULL)
-           {
-              Debug("PCRE compilation failed at offset %d: %s\n", erroffset, error);
-           }
-           else
-           {
-              compiled_ = toCompile;
-           }
-       }
+      if (error != NULL)
+      {
+         LogWarning("PCRE study failed: %s\n", error);
+      }
    }
+
+   return pattern;
+}
+
+/* static */ RE::Pattern * RE::Retain(Pattern * pattern)
+{
+   if (pattern != NULL)
+   {
+      UniqueLock<Mutex> Lock(Patterns().mutex_);
+      ++pattern->references_;
+   }
+
+   return pattern;
+}
+
+/* static */ void RE::Release(Pattern * pattern)
+{
+   if (pattern == NULL)
+   {
+      return;
+   }
+
+   Cache & cache = Patterns();
+   UniqueLock<Mutex> Lock(cache.mutex_);
+
+   if (--pattern->references_ == 0)
+   {
+      cache.unused_.push_front(pattern);
+
+      while (cache.unused_.size() > Cache::MaxUnused)
+      {
+         Pattern * const oldest = cache.unused_.back();
+         cache.unused_.pop_back();
+         cache.patterns_.erase(oldest->key_);
+         delete oldest;
+      }
+   }
+}
+
+RE::Pattern const * RE::Complete() const
+{
+   Pattern * complete = __atomic_load_n(&complete_, __ATOMIC_ACQUIRE);
+
+   if (complete == NULL)
+   {
+      // Another thread may get here first, in which case use its pattern
+      Pattern * const pattern = Acquire("(?:" + exp_ + ")\\z", opt_);
+
+      if (__atomic_compare_exchange_n(&complete_, &complete, pattern, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) == true)
+      {
+         complete = pattern;
+      }
+      else
+      {
+         Release(pattern);
+      }
+   }
+
+   return complete;
 }
 
 bool RE::Capture(std::string match,
@@ -88,8 +234,6 @@ bool RE::Capture(std::string match,
                  std::string * arg5, std::string * arg6,
                  std::string * arg7, std::string * arg8) const
 {
-   Compile(exp_);
-
    std::map<int, std::string *> args;
 
    args[0] = arg1; args[1] = arg2; args[2] = arg3; args[3] = arg4;
@@ -98,7 +242,12 @@ bool RE::Capture(std::string match,
    int const vecsize = 24;
    int ovector[vecsize];
 
-   int rc = pcre_exec(re_, NULL, match.c_str(), match.length(), 0, 0, ovector, vecsize);
+   if (match_->re_ == NULL)
+   {
+      return false;
+   }
+
+   int rc = pcre_exec(match_->re_, match_->extra_, match.c_str(), match.length(), 0, 0, ovector, vecsize);
 
    ErrorPrint(rc);
 
@@ -136,12 +285,15 @@ bool RE::Capture(std::string match,
 
 bool RE::Replace(std::string substitution, std::string & valueString) const
 {
-   Compile(exp_);
+   if (match_->re_ == NULL)
+   {
+      return false;
+   }
 
    int const vecsize = 24;
    int ovector[vecsize];
 
-   int rc = pcre_exec(re_, NULL, valueString.c_str(), valueString.length(), 0, 0, ovector, vecsize);
+   int rc = pcre_exec(match_->re_, match_->extra_, valueString.c_str(), valueString.length(), 0, 0, ovector, vecsize);
 
    ErrorPrint(rc);
 
@@ -162,12 +314,17 @@ bool RE::Replace(std::string substitution, std::string & valueString) const
    return false;
 }
 
-bool RE::IsMatch(std::string match) const
+bool RE::IsMatch(Pattern const * pattern, char const * match, size_t length) const
 {
+   if (pattern->re_ == NULL)
+   {
+      return false;
+   }
+
    int const vecsize = 12;
    int ovector[vecsize];
 
-   int const rc = pcre_exec(re_, NULL, match.c_str(), match.length(), 0, 0, ovector, vecsize);
+   int const rc = pcre_exec(pattern->re_, pattern->extra_, match, length, 0, 0, ovector, vecsize);
 
    ErrorPrint(rc);
    return (rc >= 0);
@@ -187,13 +344,3 @@ void RE::ErrorPrint(int rc) const
        }
    }
 }
-
-void RE::Free() const
-{
-    if (re_ != NULL)
-    {
-        compiled_ = "";
-        pcre_free(re_);
-        re_ = NULL;
-    }
-}
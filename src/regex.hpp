@@ -32,30 +32,46 @@ namespace Regex
    {
       None            = 0,
       CaseInsensitive = PCRE_CASELESS,
+      DotAll          = PCRE_DOTALL,
       UTF8            = PCRE_UTF8
    } Options;
 
    class RE
    {
+      private:
+         // A compiled (and where possible JIT studied) expression, these
+         // are shared between all RE instances with the same pattern and options
+         class Pattern;
+         class Cache;
+
       public:
          RE(std::string exp);
          RE(std::string exp, Regex::Options opt);
+         RE(RE const & re);
          ~RE();
 
       public:
 			static void Trim(std::string & input);
 
 		public:
-         inline bool Matches(std::string match) const
+         inline bool Matches(std::string const & match) const
+         {
+            return Matches(match.c_str(), match.length());
+         }
+
+         inline bool Matches(char const * match, size_t length) const
          {
-            Compile(exp_);
-            return IsMatch(match);
+            return IsMatch(match_, match, length);
          }
 
-         inline bool CompleteMatch(std::string match) const
+         inline bool CompleteMatch(std::string const & match) const
          {
-            Compile("(?:" + exp_ + ")\\z");
-            return IsMatch(match);
+            return CompleteMatch(match.c_str(), match.length());
+         }
+
+         inline bool CompleteMatch(char const * match, size_t length) const
+         {
+            return IsMatch(Complete(), match, length);
          }
 
 
@@ -80,16 +96,23 @@ namespace Regex
 			}
 
       private:
-         void Compile(std::string toCompile) const;
-         bool IsMatch(std::string match) const;
+         Pattern const * Complete() const;
+
+         static Cache & Patterns();
+         static Pattern * Acquire(std::string const & exp, Regex::Options opt);
+         static Pattern * Retain(Pattern * pattern);
+         static void Release(Pattern * pattern);
+
+         bool IsMatch(Pattern const * pattern, char const * match, size_t length) const;
          void ErrorPrint(int rc) const;
-         void Free() const;
 
       private:
-         std::string const   exp_;
-         mutable std::string compiled_;
-         mutable pcre *      re_;
-         Regex::Options const opt_;
+         // The expression is compiled on construction so that an RE shared
+         // between threads is only read, complete_ is filled in atomically
+         std::string const       exp_;
+         Regex::Options const    opt_;
+         Pattern * const         match_;
+         mutable Pattern *       complete_;
    };
 }
 
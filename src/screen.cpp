@@ -39,6 +39,7 @@
 #include "settings.hpp"
 #include "song.hpp"
 #include "songsorter.hpp"
+#include "trace.hpp"
 #include "vimpc.hpp"
 
 #include "window/browsewindow.hpp"
@@ -46,6 +47,7 @@
 #include "window/debug.hpp"
 #include "window/directorywindow.hpp"
 #include "window/error.hpp"
+#include "window/filterwindow.hpp"
 #include "window/help.hpp"
 #include "window/infowindow.hpp"
 #include "window/librarywindow.hpp"
@@ -54,6 +56,7 @@
 #include "window/playlistwindow.hpp"
 #include "window/result.hpp"
 #include "window/songwindow.hpp"
+#include "window/statswindow.hpp"
 #include "window/windowselector.hpp"
 
 #ifdef LYRICS_SUPPORT
@@ -80,6 +83,11 @@ int32_t RndCount   = 0;
 static Atomic(bool)   Running(true);
 static RecursiveMutex CursesMutex;
 
+static bool           Headless       = false;
+static SCREEN *       HeadlessScreen = NULL;
+static FILE *         HeadlessInput  = NULL;
+static FILE *         HeadlessOutput = NULL;
+
 extern "C" void ResizeHandler(int);
 extern "C" void ContinueHandler(int);
 
@@ -115,6 +123,8 @@ void RandomCharacterInput()
 
 void QueueInput(WINDOW * inputWindow)
 {
+   Main::Trace::NameThread("input");
+
    CursesMutex.lock();
    keypad(inputWindow, true);
    wtimeout(inputWindow, -1);
@@ -143,8 +153,7 @@ void QueueInput(WINDOW * inputWindow)
          wtimeout(inputWindow, -1);
          CursesMutex.unlock();
 
-         EventData Data;
-         Main::Vimpc::CreateEvent(Event::Continue, Data);
+         Main::Vimpc::CreateEvent(Event::Continue);
       }
 
       if (poll(&fds, 1, 250) <= 0)
@@ -194,7 +203,7 @@ void QueueInput(WINDOW * inputWindow)
                EventData Data;
                Data.user  = true;
                Data.input = input;
-               Main::Vimpc::CreateEvent(Event::Input, Data);
+               Main::Vimpc::CreateEvent(Event::Input, std::move(Data));
             }
          }
       }
@@ -223,7 +232,19 @@ Screen::Screen(Main::Settings & settings, Mpc::Client & client, Mpc::ClientState
 {
    // ncurses initialisation
    CursesMutex.lock();
-   initscr();
+
+   if (Headless == true)
+   {
+      HeadlessInput  = fopen("/dev/null", "r");
+      HeadlessOutput = fopen("/dev/null", "w");
+      HeadlessScreen = newterm((getenv("TERM") != NULL) ? NULL : "vt100", HeadlessOutput, HeadlessInput);
+      set_term(HeadlessScreen);
+   }
+   else
+   {
+      initscr();
+   }
+
    raw();
    noecho();
 
@@ -251,6 +272,7 @@ Screen::Screen(Main::Settings & settings, Mpc::Client & client, Mpc::ClientState
    mainWindows_[Help]         = new Ui::HelpWindow     (settings, *this, search);
    mainWindows_[DebugConsole] = new Ui::ConsoleWindow  (settings, *this, "debug",   Main::DebugConsole());
    mainWindows_[TestConsole]  = new Ui::ConsoleWindow  (settings, *this, "test",    Main::TestConsole());
+   mainWindows_[Stats]        = new Ui::StatsWindow    (*this);
    mainWindows_[Console]      = new Ui::ConsoleWindow  (settings, *this, "console", Main::Console());
    mainWindows_[Outputs]      = new Ui::OutputWindow   (settings, *this, Main::Outputs(),   client, search);
    mainWindows_[Library]      = new Ui::LibraryWindow  (settings, *this, Main::Library(),   client, clientState, search);
@@ -287,6 +309,7 @@ Screen::Screen(Main::Settings & settings, Mpc::Client & client, Mpc::ClientState
    }
 
    SetVisible(DebugConsole, false);
+   SetVisible(Stats, false);
 
    // Force auto scroll on the consoles
    mainWindows_[Console]->SetAutoScroll(true);
@@ -319,7 +342,7 @@ Screen::Screen(Main::Settings & settings, Mpc::Client & client, Mpc::ClientState
    {
       Ui::SongWindow * const window = CreateSongWindow(Data.name);
 
-      for (auto uri : Data.uris)
+      for (auto uri : Data.Uris())
       {
          Mpc::Song * song = Main::Library().Song(uri);
 
@@ -338,7 +361,7 @@ Screen::Screen(Main::Settings & settings, Mpc::Client & client, Mpc::ClientState
    {
       Ui::SongWindow * const window = CreateSongWindow("P:" + Data.name);
 
-      for (auto uri : Data.uris)
+      for (auto uri : Data.Uris())
       {
          Mpc::Song * song = Main::Library().Song(uri);
 
@@ -365,13 +388,20 @@ Screen::Screen(Main::Settings & settings, Mpc::Client & client, Mpc::ClientState
    });
 
    // Thread handling of input
-   inputThread_ = Thread(QueueInput, commandWindow_);
+   if (Headless == false)
+   {
+      inputThread_ = Thread(QueueInput, commandWindow_);
+   }
 }
 
 Screen::~Screen()
 {
    Running = false;
-   inputThread_.join();
+
+   if (inputThread_.joinable() == true)
+   {
+      inputThread_.join();
+   }
 
    CursesMutex.lock();
 
@@ -389,9 +419,25 @@ Screen::~Screen()
 
    endwin();
 
+   if (HeadlessScreen != NULL)
+   {
+      delscreen(HeadlessScreen);
+      fclose(HeadlessInput);
+      fclose(HeadlessOutput);
+      HeadlessScreen = NULL;
+   }
+
    CursesMutex.unlock();
 }
 
+/* static */ void Screen::SetHeadless(int rows, int columns)
+{
+   // Curses takes the size of the screen from these rather than the terminal
+   Headless = true;
+   setenv("LINES",   std::to_string(rows).c_str(),    1);
+   setenv("COLUMNS", std::to_string(columns).c_str(), 1);
+}
+
 
 int32_t Screen::GetWindowFromName(std::string const & name) const
 {
@@ -495,6 +541,21 @@ Ui::SongWindow * Screen::CreateSongWindow(std::string const & name)
    return window;
 }
 
+Ui::FilterWindow * Screen::CreateFilterWindow(Ui::SongWindow & source)
+{
+   int32_t id = static_cast<int32_t>(Dynamic);
+
+   while (mainWindows_.find(id) != mainWindows_.end())
+   {
+      ++id;
+   }
+
+   Ui::FilterWindow * window = new FilterWindow(source, settings_, *this, client_, clientState_, search_);
+   mainWindows_[id]          = window;
+
+   return window;
+}
+
 Ui::InfoWindow * Screen::CreateInfoWindow(int32_t Id, std::string const & name, Mpc::Song * song)
 {
    SetVisible(Id, false);
@@ -831,11 +892,19 @@ void Screen::Update()
 {
    if ((started_ == true) && (mainWindows_[window_] != NULL))
    {
+      Main::Trace::Span Span("screen", "Update");
+
       WindowMap::iterator it = mainWindows_.begin();
 
       HideCursor();
       Initialise(window_);
 
+      // The stats change all of the time, so read them on every update
+      if (window_ == Stats)
+      {
+         Redraw(Stats);
+      }
+
       CursesMutex.lock();
       werase(mainWindow_);
       CursesMutex.unlock();
@@ -854,9 +923,13 @@ void Screen::Update()
       CursesMutex.lock();
 
       // Paint the main window
-      for (uint32_t i = 0; (i < static_cast<uint32_t>(MaxRows())); ++i)
       {
-         ActiveWindow().Print(i);
+         Main::Trace::Span PrintSpan("print", ActiveWindow().Name());
+
+         for (uint32_t i = 0; (i < static_cast<uint32_t>(MaxRows())); ++i)
+         {
+            ActiveWindow().Print(i);
+         }
       }
 
       wnoutrefresh(mainWindow_);
@@ -894,6 +967,7 @@ void Screen::Redraw(int32_t window) const
 
    if ((it != mainWindows_.end()) && (it->second != NULL))
    {
+      Main::Trace::Span Span("redraw", (it->second)->Name());
       (it->second)->Redraw();
    }
 
@@ -946,7 +1020,8 @@ bool Screen::Resize(bool forceResize, int rows, int cols)
 #ifdef TIOCGWINSZ
       struct winsize windowSize;
 
-      if ((ioctl(0, TIOCGWINSZ, &windowSize) >= 0) &&
+      if ((Headless == false) &&
+          (ioctl(0, TIOCGWINSZ, &windowSize) >= 0) &&
           (windowSize.ws_row >= 0 && windowSize.ws_col >= 0))
       {
          maxRows_    = windowSize.ws_row;
@@ -1261,9 +1336,9 @@ Mpc::Song * Screen::GetSong(uint32_t window, uint32_t pos) const
    Ui::ScrollWindow & scrollWindow = Window(window);
    Ui::SongWindow * songWindow = dynamic_cast<Ui::SongWindow *>(&scrollWindow);
 
-   if ((songWindow != NULL) && (songWindow->Buffer().Size() > pos))
+   if ((songWindow != NULL) && (songWindow->BufferSize() > pos))
    {
-      return songWindow->Buffer().Get(pos);
+      return songWindow->GetSong(pos);
    }
    return NULL;
 }
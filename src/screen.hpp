@@ -62,6 +62,7 @@ namespace Ui
    class PlaylistWindow;
    class Search;
    class SongWindow;
+   class FilterWindow;
    class Screen;
 }
 
@@ -95,6 +96,12 @@ namespace Ui
       Screen(Screen & screen);
       Screen & operator=(Screen & screen);
 
+   public:
+      //! Screens created after this draw into curses' own copy of the screen
+      //! with the given size, nothing is written to the terminal and there
+      //! is no keyboard input, used by the benchmarks
+      static void SetHeadless(int rows, int columns);
+
    public:
       typedef std::map<int32_t, ScrollWindow *> WindowMap;
 
@@ -104,6 +111,7 @@ namespace Ui
          Help = 0,
          DebugConsole,
          TestConsole,
+         Stats,
          Console,
          Outputs,
          Library,
@@ -161,6 +169,9 @@ namespace Ui
       Ui::InfoWindow * CreateInfoWindow(int32_t Id, std::string const & name, Mpc::Song * song = NULL);
       void CreateSongInfoWindow(Mpc::Song * song = NULL);
 
+      // Create a window showing the songs of another window that match a pattern
+      Ui::FilterWindow * CreateFilterWindow(Ui::SongWindow & source);
+
 #ifdef LYRICS_SUPPORT
       Ui::LyricsWindow * CreateLyricsWindow(int32_t Id, std::string const & name, Mpc::Song * song = NULL);
       void CreateSongLyricsWindow(Mpc::Song * song = NULL);
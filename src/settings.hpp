@@ -37,6 +37,8 @@
    X(AutoUpdate,       "autoupdate",      true)  /* Automatically update after file edits */ \
    X(AutoLyrics,       "autolyrics",      false) /* Automatically get lyrics for the playing song */ \
    X(AutoScrollLyrics, "autoscrolllyrics",false) /* Automatically scroll lyrics for the playing song */ \
+   X(LyricsCache,      "lyricscache",     true)  /* Keep fetched lyrics on disk */ \
+   X(LyricsConcurrent, "lyricsconcurrent",false) /* Request lyrics from every site at once */ \
    X(AlbumArtist,      "albumartist",     true)  /* Use the album artist tag if there is one */ \
    X(BrowseNumbers,    "browsenumbers",   false) /* Show numbers in the browse window */ \
    X(ColourEnabled,    "colour",          true)  /* Determine if we should use colours */ \
@@ -70,6 +72,12 @@
    X(TimeRemaining,    "timeremaining",   false) /* Show time left rather than time elapsed */ \
    X(WindowNumbers,    "windownumbers",   false) /* Window numbers next to each window in the tab list */
 
+#ifdef __DEBUG_PRINTS
+#define LOG_LEVEL_DEFAULT "debug"
+#else
+#define LOG_LEVEL_DEFAULT "info"
+#endif
+
 // X(enum-entry, setting-name, default-value, regex-filter)
 #define STRING_SETTINGS \
    /* position to add songs */ \
@@ -82,6 +90,22 @@
    X(LibraryFormat,    "libraryformat", "$I%n \\| $D$H[$H%l$H]$H {%t}|{%f}$E$R ", ".*") \
    /* Library format string */ \
    X(LocalMusicDir,    "local-music-dir", "", ".*") \
+   /* File to also write log messages to */ \
+   X(LogFile,          "logfile", "", ".*") \
+   /* Size in megabytes at which the log file is rotated */ \
+   X(LogFileSize,      "logfilesize", "1", "\\d+") \
+   /* Least important messages kept in the debug console and log file */ \
+   X(LoggingLevel,     "loglevel", LOG_LEVEL_DEFAULT, "error|warning|info|debug") \
+   /* Lyrics cache directory, defaults to $XDG_CACHE_HOME/vimpc/lyrics */ \
+   X(LyricsCacheDir,   "lyricscachedir", "", ".*") \
+   /* Lyrics cache size in megabytes */ \
+   X(LyricsCacheSize,  "lyricscachesize", "16", "\\d+") \
+   /* Hours to remember that no lyrics could be found for a song */ \
+   X(LyricsMissTTL,    "lyricsmissttl", "24", "\\d+") \
+   /* Number of upcoming songs to fetch lyrics for, 0 to disable */ \
+   X(LyricsPrefetch,   "lyricsprefetch", "2", "\\d+") \
+   /* Download rate in kilobytes per second when prefetching lyrics, 0 is unlimited */ \
+   X(LyricsPrefetchRate, "lyricsprefetchrate", "32", "\\d+") \
    /* Lyrics strip regex */ \
    X(LyricsStrip,      "lyricsstrip", "(\\s*(R|r)emaster\\w*)|(\\s+-.*)", ".*") \
    /* Lists to show in the lists window */ \
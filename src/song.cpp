@@ -20,9 +20,11 @@
 
 #include "song.hpp"
 
+#include <algorithm>
 #include <stdio.h>
 
 #include "buffers.hpp"
+#include "compiler.hpp"
 #include "buffer/directory.hpp"
 #include "buffer/library.hpp"
 
@@ -55,6 +57,11 @@ std::map<std::string, uint32_t> Mpc::Song::DiscMap;
 
 std::map<char, Mpc::Song::SongFunction> Mpc::Song::SongInfo;
 
+static uint32_t                 BatchDepth = 0;
+static uint32_t                 SongRevision = 0;
+static std::vector<Mpc::Song *> BatchSongs;
+static uint32_t const           NotBatched = static_cast<uint32_t>(-1);
+
 using namespace Mpc;
 
 Song::Song() :
@@ -70,9 +77,14 @@ Song::Song() :
    virtualEnd_  (0),
    uri_         (""),
    title_       (""),
+   formatting_  (false),
    lastFormat_  (""),
    formatted_   (""),
-   entry_       (NULL)
+   entry_       (NULL),
+   directory_   (NULL),
+   directoryGeneration_(0),
+   batchIndex_  (NotBatched),
+   batchReferenced_(false)
 { }
 
 Song::Song(Song const & song) :
@@ -87,8 +99,14 @@ Song::Song(Song const & song) :
    duration_    (song.duration_),
    uri_         (song.URI()),
    title_       (song.Title()),
-   lastFormat_  (song.lastFormat_),
-   formatted_   (song.formatted_)
+   formatting_  (false),
+   lastFormat_  (""),
+   formatted_   (""),
+   entry_       (NULL),
+   directory_   (NULL),
+   directoryGeneration_(0),
+   batchIndex_  (NotBatched),
+   batchReferenced_(false)
 {
    SetDuration(duration_);
 }
@@ -101,6 +119,59 @@ Song::~Song()
    {
       entry_->song_ = NULL;
    }
+
+   if (batchIndex_ != NotBatched)
+   {
+      BatchSongs[batchIndex_] = NULL;
+   }
+}
+
+
+Song::ReferenceBatch::ReferenceBatch()
+{
+   ++BatchDepth;
+}
+
+Song::ReferenceBatch::~ReferenceBatch()
+{
+   if (--BatchDepth > 0)
+   {
+      return;
+   }
+
+   // Songs in the same directory are passed on to it together
+   std::map<DirectoryNode *, int32_t> directories;
+
+   for (auto song : BatchSongs)
+   {
+      if (song == NULL)
+      {
+         continue;
+      }
+
+      bool const referenced = (song->reference_ > 0);
+      song->batchIndex_ = NotBatched;
+
+      if (referenced != song->batchReferenced_)
+      {
+         if (song->entry_ != NULL)
+         {
+            (referenced == true) ? song->entry_->AddedToPlaylist() : song->entry_->RemovedFromPlaylist();
+         }
+
+         if ((song->directory_ != NULL) && (song->directoryGeneration_ == Main::Directory().DatabaseGeneration()))
+         {
+            directories[song->directory_] += (referenced == true) ? 1 : -1;
+         }
+      }
+   }
+
+   BatchSongs.clear();
+
+   for (auto directory : directories)
+   {
+      Main::Directory().AddReferences(directory.first, directory.second);
+   }
 }
 
 
@@ -109,15 +180,19 @@ int32_t Song::Reference() const
    return reference_;
 }
 
+size_t Song::Memory() const
+{
+   return sizeof(Song) + uri_.capacity() + title_.capacity() + lastFormat_.capacity() + formatted_.capacity();
+}
+
 /* static */ void Song::IncrementReference(Song * song)
 {
    if (song) {
        song->reference_ += 1;
 
-       if ((song->entry_ != NULL) && (song->reference_ == 1))
+       if (song->reference_ == 1)
        {
-          song->entry_->AddedToPlaylist();
-          Main::Directory().AddedToPlaylist(song->URI());
+          Referenced(song, true);
        }
    }
 }
@@ -127,11 +202,41 @@ int32_t Song::Reference() const
    if (song) {
       song->reference_ -= 1;
 
-      if ((song->entry_ != NULL) && (song->reference_ == 0))
+      if (song->reference_ == 0)
+      {
+         Referenced(song, false);
+      }
+   }
+}
+
+/* static */ void Song::Referenced(Song * song, bool added)
+{
+   // Songs that are in neither the library nor the directories have nothing to update
+   if ((song->entry_ == NULL) && (song->directory_ == NULL))
+   {
+      return;
+   }
+
+   if (BatchDepth > 0)
+   {
+      if (song->batchIndex_ == NotBatched)
       {
-          song->entry_->RemovedFromPlaylist();
-          Main::Directory().RemovedFromPlaylist(song->URI());
+         song->batchIndex_      = BatchSongs.size();
+         song->batchReferenced_ = !added;
+         BatchSongs.push_back(song);
       }
+
+      return;
+   }
+
+   if (song->entry_ != NULL)
+   {
+      (added == true) ? song->entry_->AddedToPlaylist() : song->entry_->RemovedFromPlaylist();
+   }
+
+   if ((song->directory_ != NULL) && (song->directoryGeneration_ == Main::Directory().DatabaseGeneration()))
+   {
+      Main::Directory().AddReferences(song->directory_, (added == true) ? 1 : -1);
    }
 }
 
@@ -145,11 +250,16 @@ int32_t Song::Reference() const
    }
 }
 
+/* static */ uint32_t Song::Revision()
+{
+   return __atomic_load_n(&SongRevision, __ATOMIC_ACQUIRE);
+}
+
 
 
 void Song::Set(const char * newVal, int32_t & oldVal, std::vector<std::string> & Values, std::map<std::string, uint32_t> & Indexes)
 {
-   lastFormat_ = "";
+   ClearFormat();
 
    if (newVal == NULL)
    {
@@ -224,7 +334,7 @@ std::string const & Song::Album() const
 
 void Song::SetTitle(const char * title)
 {
-   lastFormat_ = "";
+   ClearFormat();
 
    if (title != NULL)
    {
@@ -258,7 +368,7 @@ std::string const & Song::Track() const
 
 void Song::SetURI(const char * uri)
 {
-   lastFormat_ = "";
+   ClearFormat();
 
    if (uri != NULL)
    {
@@ -322,7 +432,7 @@ std::string const & Song::Disc() const
 
 void Song::SetDuration(int32_t duration)
 {
-   lastFormat_ = "";
+   ClearFormat();
    duration_ = duration;
 }
 
@@ -351,38 +461,59 @@ LibraryEntry * Song::Entry() const
    return entry_;
 }
 
-std::string const & Song::DurationString() const
+void Song::SetDirectoryHandle(DirectoryNode * node, uint32_t generation)
+{
+   directory_           = node;
+   directoryGeneration_ = generation;
+}
+
+std::string Song::DurationString() const
 {
-   static std::string Result;
-   static char cduration[32];
+   char cduration[32];
 
    uint32_t const minutes = static_cast<uint32_t>(duration_ / 60);
    uint32_t const seconds = (duration_ - (minutes * 60));
 
    snprintf(cduration, 32, "%2d:%.2d", minutes, seconds);
-   Result = std::string(cduration);
-   return Result;
+   return std::string(cduration);
 }
 
 std::string Song::FormatString(std::string fmt) const
 {
-   if (lastFormat_ == fmt)
+   std::string::const_iterator it = fmt.begin();
+
+   // Searches format songs from several threads at once, a song that is
+   // already being formatted elsewhere is formatted again without the cache
+   if (__atomic_exchange_n(&formatting_, true, __ATOMIC_ACQUIRE) == true)
    {
-      return formatted_;
+      return ParseString(it, true);
    }
 
-   lastFormat_ = fmt;
-   std::string::const_iterator it = fmt.begin();
-   formatted_ = ParseString(it, true);
+   if (lastFormat_ != fmt)
+   {
+      lastFormat_ = fmt;
+      formatted_  = ParseString(it, true);
+   }
+
+   std::string const Result(formatted_);
+   __atomic_store_n(&formatting_, false, __ATOMIC_RELEASE);
+   return Result;
+}
+
+void Song::ClearFormat()
+{
+   while (__atomic_exchange_n(&formatting_, true, __ATOMIC_ACQUIRE) == true) { }
+
+   lastFormat_ = "";
+   __atomic_store_n(&formatting_, false, __ATOMIC_RELEASE);
 
-   return formatted_;
+   __atomic_add_fetch(&SongRevision, 1, __ATOMIC_RELEASE);
 }
 
 /* static */ void Song::RepopulateSongFunctions()
 {
    SongInfo['b'] = &Mpc::Song::Album;
    SongInfo['B'] = &Mpc::Song::Album;
-   SongInfo['l'] = &Mpc::Song::DurationString;
    SongInfo['t'] = &Mpc::Song::Title;
    SongInfo['n'] = &Mpc::Song::Track;
    SongInfo['f'] = &Mpc::Song::URI;
@@ -465,8 +596,8 @@ std::string Song::ParseString(std::string::const_iterator & it, bool valid) cons
                   (*it == 'n') || (*it == 'f') ||
                   (*it == 'd') || (*it == 'c'))
          {
-            SongFunction Function = SongInfo[*it];
-            std::string val = (*this.*Function)();
+            // The duration is formatted on demand rather than stored
+            std::string val = (*it == 'l') ? DurationString() : (*this.*SongInfo[*it])();
 
             if ((*it == 'B') || (*it == 'A') ||
                 (*it == 'R') || (*it == 'M'))
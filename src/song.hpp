@@ -30,6 +30,7 @@
 
 namespace Mpc
 {
+   class DirectoryNode;
    class LibraryEntry;
 
    typedef enum
@@ -86,15 +87,36 @@ namespace Mpc
          return ((artist_ < rhs.artist_) || (title_ < rhs.title_));
       }
 
+   public:
+      //! While one exists, songs being added to or removed from the playlist
+      //! only update the library and directories once it has been destroyed,
+      //! a song removed and added again then costs nothing
+      class ReferenceBatch
+      {
+      public:
+         ReferenceBatch();
+         ~ReferenceBatch();
+
+      private:
+         ReferenceBatch(ReferenceBatch const &);
+         ReferenceBatch & operator=(ReferenceBatch const &);
+      };
+
    public:
       int32_t Reference() const;
 
+      //! Approximate bytes used by the song, shared tag values are not included
+      size_t Memory() const;
+
       // Find the corresponding entry in the library
       // for this song and update it's reference count
       static void IncrementReference(Song * song);
       static void DecrementReference(Song * song);
       static void SwapThe(std::string & String);
 
+      //! Changes whenever the tags of any song are changed
+      static uint32_t Revision();
+
       void SetArtist(const char * artist);
       std::string const & Artist() const;
 
@@ -124,7 +146,7 @@ namespace Mpc
 
       void SetDuration(int32_t duration);
       int32_t Duration() const;
-      std::string const & DurationString() const;
+      std::string DurationString() const;
 
       void SetVirtualEnd(int32_t end);
       int32_t VirtualEnd() const;
@@ -132,6 +154,10 @@ namespace Mpc
       void SetEntry(LibraryEntry * entry);
       LibraryEntry * Entry() const;
 
+      //! The node is only used while the directories have not been cleared
+      //! since, the generation is that of the directories when it was set
+      void SetDirectoryHandle(DirectoryNode * node, uint32_t generation);
+
       std::string FormatString(std::string fmt) const;
       std::string ParseString(std::string::const_iterator &it, bool valid) const;
 
@@ -160,8 +186,11 @@ namespace Mpc
       static std::map<std::string, uint32_t> DiscMap;
 
    private:
+      void ClearFormat();
       void Set(const char * newVal, int32_t & oldVal, std::vector<std::string> & Values, std::map<std::string, uint32_t> & Indexes);
 
+      static void Referenced(Song * song, bool added);
+
    private:
       int32_t     reference_;
       int32_t     artist_;
@@ -176,10 +205,20 @@ namespace Mpc
       std::string uri_;
       std::string title_;
 
+      // Only the thread that sets formatting_ may use the last format,
+      // any other thread formats the song without it rather than waiting
+      mutable bool        formatting_;
       mutable std::string lastFormat_;
       mutable std::string formatted_;
 
-      LibraryEntry * entry_;
+      LibraryEntry *  entry_;
+      DirectoryNode * directory_;
+      uint32_t        directoryGeneration_;
+
+      // Where the song is in the current batch and whether it was in the
+      // playlist when the batch started
+      uint32_t        batchIndex_;
+      bool            batchReferenced_;
    };
 }
 
@@ -18,6 +18,14 @@
    songsorter.hpp - sort songs based on a given criterium
 */
 
+#ifndef __UI__SONGSORTER
+#define __UI__SONGSORTER
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+
 #include <song.hpp>
 #include <buffer/library.hpp>
 #include <window/debug.hpp>
@@ -57,4 +65,111 @@ namespace Ui
          bool           const   ignoreCase_;
          bool           const   ignoreThe_;
    };
+
+   //! Sorts songs by a list of fields such as "artist album track", the
+   //! keys of each song are worked out once rather than for every comparison
+   class FieldSorter
+   {
+      public:
+      FieldSorter(std::string const & fields) :
+         settings_  (Main::Settings::Instance()),
+         ignoreCase_(settings_.Get(Setting::IgnoreCaseSort)),
+         ignoreThe_ (settings_.Get(Setting::IgnoreTheSort))
+      {
+         std::string field;
+
+         for (size_t i = 0; i <= fields.size(); ++i)
+         {
+            if ((i < fields.size()) && (fields[i] != ' ') && (fields[i] != ','))
+            {
+               field += tolower(fields[i]);
+            }
+            else if (field != "")
+            {
+               if (Known(field) == false)
+               {
+                  invalid_ = (invalid_ == "") ? field : invalid_;
+               }
+
+               fields_.push_back(field);
+               field = "";
+            }
+         }
+      }
+
+      public:
+      //! Returns the first field that can't be sorted by, or an empty string
+      std::string const & Invalid() const { return invalid_; }
+      bool Valid() const { return ((fields_.empty() == false) && (invalid_ == "")); }
+
+      //! The positions of the songs in sorted order, songs with the same keys keep their order
+      std::vector<uint32_t> Order(std::vector<Mpc::Song *> const & songs) const
+      {
+         std::vector<std::vector<std::string> > keys(songs.size());
+         std::vector<uint32_t>                  order(songs.size());
+
+         for (uint32_t i = 0; i < songs.size(); ++i)
+         {
+            order[i] = i;
+
+            for (auto const & field : fields_)
+            {
+               keys[i].push_back(Key(songs[i], field));
+            }
+         }
+
+         std::stable_sort(order.begin(), order.end(), [&keys] (uint32_t i, uint32_t j) { return (keys[i] < keys[j]); });
+         return order;
+      }
+
+      private:
+      static bool Known(std::string const & field)
+      {
+         return ((field == "artist") || (field == "albumartist") || (field == "album") || (field == "title") ||
+                 (field == "track") || (field == "disc") || (field == "date") || (field == "genre") ||
+                 (field == "duration") || (field == "uri") || (field == "file"));
+      }
+
+      std::string Key(Mpc::Song const * song, std::string const & field) const
+      {
+         if ((field == "track") || (field == "disc") || (field == "duration"))
+         {
+            // Numbers are padded so that 10 sorts after 9
+            char number[16];
+            snprintf(number, sizeof(number), "%010u", static_cast<uint32_t>(
+               (field == "track")    ? atoi(song->Track().c_str()) :
+               (field == "disc")     ? atoi(song->Disc().c_str())  : std::max(song->Duration(), 0)));
+            return number;
+         }
+
+         std::string key = (field == "artist")      ? song->Artist() :
+                           (field == "albumartist") ? song->AlbumArtist() :
+                           (field == "album")       ? song->Album() :
+                           (field == "title")       ? song->Title() :
+                           (field == "date")        ? song->Date() :
+                           (field == "genre")       ? song->Genre() : song->URI();
+
+         if (ignoreCase_ == true)
+         {
+            std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+         }
+
+         if ((ignoreThe_ == true) && (key.size() > 4) && (strncasecmp(key.c_str(), "the ", 4) == 0))
+         {
+            key.erase(0, 4);
+         }
+
+         return key;
+      }
+
+      private:
+         Main::Settings const &   settings_;
+         bool           const     ignoreCase_;
+         bool           const     ignoreThe_;
+         std::vector<std::string> fields_;
+         std::string              invalid_;
+   };
 }
+
+#endif
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,302 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   stats.cpp - timings and counters shown in the stats window
+   */
+
+#include "stats.hpp"
+
+#include <chrono>
+#include <sstream>
+#include <stdio.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace Main;
+
+namespace
+{
+   std::string Duration(uint64_t us)
+   {
+      char buffer[32];
+
+      if (us < 1000)
+      {
+         snprintf(buffer, sizeof(buffer), "%uus", static_cast<uint32_t>(us));
+      }
+      else if (us < 1000 * 1000)
+      {
+         snprintf(buffer, sizeof(buffer), "%.1fms", us / 1000.0);
+      }
+      else
+      {
+         snprintf(buffer, sizeof(buffer), "%.2fs", us / (1000.0 * 1000.0));
+      }
+
+      return buffer;
+   }
+
+   std::string Bytes(uint64_t bytes)
+   {
+      char buffer[32];
+
+      if (bytes < 1024)
+      {
+         snprintf(buffer, sizeof(buffer), "%uB", static_cast<uint32_t>(bytes));
+      }
+      else if (bytes < 1024 * 1024)
+      {
+         snprintf(buffer, sizeof(buffer), "%.1fKB", bytes / 1024.0);
+      }
+      else
+      {
+         snprintf(buffer, sizeof(buffer), "%.1fMB", bytes / (1024.0 * 1024.0));
+      }
+
+      return buffer;
+   }
+}
+
+
+Stats::Histogram::Histogram() :
+   count_(0),
+   total_(0),
+   max_  (0)
+{
+   for (uint32_t i = 0; i < Buckets; ++i)
+   {
+      buckets_[i] = 0;
+   }
+}
+
+void Stats::Histogram::Add(uint64_t us)
+{
+   uint32_t bucket = 0;
+
+   for (uint64_t value = us; (value > 1) && (bucket < Buckets - 1); value >>= 1)
+   {
+      ++bucket;
+   }
+
+   __atomic_add_fetch(&buckets_[bucket], 1, __ATOMIC_RELAXED);
+   __atomic_add_fetch(&total_, us, __ATOMIC_RELAXED);
+   __atomic_add_fetch(&count_, 1, __ATOMIC_RELAXED);
+
+   for (uint64_t max = __atomic_load_n(&max_, __ATOMIC_RELAXED);
+        (us > max) && (__atomic_compare_exchange_n(&max_, &max, us, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == false); ) { }
+}
+
+uint64_t Stats::Histogram::Count() const
+{
+   return __atomic_load_n(&count_, __ATOMIC_RELAXED);
+}
+
+uint64_t Stats::Histogram::Max() const
+{
+   return __atomic_load_n(&max_, __ATOMIC_RELAXED);
+}
+
+uint64_t Stats::Histogram::Mean() const
+{
+   uint64_t const count = Count();
+   return (count > 0) ? (__atomic_load_n(&total_, __ATOMIC_RELAXED) / count) : 0;
+}
+
+uint64_t Stats::Histogram::Percentile(uint32_t percent) const
+{
+   uint64_t counts[Buckets];
+   uint64_t count = 0;
+
+   for (uint32_t i = 0; i < Buckets; ++i)
+   {
+      counts[i] = __atomic_load_n(&buckets_[i], __ATOMIC_RELAXED);
+      count    += counts[i];
+   }
+
+   uint64_t const target = (count * percent + 99) / 100;
+   uint64_t       seen   = 0;
+
+   for (uint32_t i = 0; i < Buckets; ++i)
+   {
+      seen += counts[i];
+
+      if ((seen >= target) && (seen > 0))
+      {
+         // The last bucket has no upper bound
+         return (i == Buckets - 1) ? Max() : (static_cast<uint64_t>(2) << i);
+      }
+   }
+
+   return 0;
+}
+
+std::string Stats::Histogram::Summary() const
+{
+   std::stringstream stream;
+   stream << "n=" << Count() << " mean=" << Duration(Mean())
+          << " p50<" << Duration(Percentile(50)) << " p90<" << Duration(Percentile(90))
+          << " p99<" << Duration(Percentile(99)) << " max=" << Duration(Max());
+   return stream.str();
+}
+
+
+Stats & Stats::Instance()
+{
+   static Stats stats;
+   return stats;
+}
+
+uint64_t Stats::Now()
+{
+   return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Stats::Stats() :
+   queueDepth_ (0),
+   queueMax_   (0),
+   ingested_   (0),
+   ingestStart_(0),
+   ingestEnd_  (0)
+{
+}
+
+Stats::~Stats()
+{
+   for (auto it = commands_.begin(); (it != commands_.end()); ++it)
+   {
+      delete it->second;
+   }
+}
+
+void Stats::QueueDepth(uint32_t depth)
+{
+   __atomic_store_n(&queueDepth_, depth, __ATOMIC_RELAXED);
+
+   for (uint32_t max = __atomic_load_n(&queueMax_, __ATOMIC_RELAXED);
+        (depth > max) && (__atomic_compare_exchange_n(&queueMax_, &max, depth, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == false); ) { }
+}
+
+Stats::Histogram & Stats::Command(char const * name)
+{
+   UniqueLock<Mutex> Lock(commandMutex_);
+
+   Histogram * & histogram = commands_[name];
+
+   if (histogram == NULL)
+   {
+      histogram = new Histogram();
+   }
+
+   return *histogram;
+}
+
+void Stats::Ingest()
+{
+   uint64_t const now = Now();
+
+   if (__atomic_fetch_add(&ingested_, 1, __ATOMIC_RELAXED) == 0)
+   {
+      __atomic_store_n(&ingestStart_, now, __ATOMIC_RELAXED);
+   }
+
+   for (uint64_t end = __atomic_load_n(&ingestEnd_, __ATOMIC_RELAXED);
+        (now > end) && (__atomic_compare_exchange_n(&ingestEnd_, &end, now, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == false); ) { }
+}
+
+void Stats::IngestReset()
+{
+   __atomic_store_n(&ingested_, 0, __ATOMIC_RELAXED);
+}
+
+void Stats::RegisterMemory(std::string const & subsystem, MemoryFunction function)
+{
+   memory_.push_back(std::make_pair(subsystem, function));
+}
+
+
+std::vector<std::string> Stats::Lines() const
+{
+   std::vector<std::string> lines;
+
+   lines.push_back("Events");
+   lines.push_back("  queue depth " + std::to_string(__atomic_load_n(&queueDepth_, __ATOMIC_RELAXED)) +
+                   ", max " + std::to_string(__atomic_load_n(&queueMax_, __ATOMIC_RELAXED)));
+
+   for (int i = 0; i < Event::EventCount; ++i)
+   {
+      if (eventHandle_[i].Count() > 0)
+      {
+         lines.push_back("  " + EventStrings::Default[i]);
+         lines.push_back("    queued  " + eventWait_[i].Summary());
+         lines.push_back("    handled " + eventHandle_[i].Summary());
+      }
+   }
+
+   lines.push_back("");
+   lines.push_back("Client commands");
+
+   {
+      UniqueLock<Mutex> Lock(commandMutex_);
+
+      for (auto it = commands_.begin(); (it != commands_.end()); ++it)
+      {
+         lines.push_back("  " + it->first + " " + it->second->Summary());
+      }
+   }
+
+   lines.push_back("");
+   lines.push_back("Screen");
+   lines.push_back("  repaint " + repaint_.Summary());
+
+   lines.push_back("");
+   lines.push_back("Library");
+
+   uint64_t const ingested = __atomic_load_n(&ingested_, __ATOMIC_RELAXED);
+
+   if (ingested > 0)
+   {
+      uint64_t const start = __atomic_load_n(&ingestStart_, __ATOMIC_RELAXED);
+      uint64_t const end   = __atomic_load_n(&ingestEnd_, __ATOMIC_RELAXED);
+      uint64_t const us    = (end > start) ? (end - start) : 0;
+
+      lines.push_back("  " + std::to_string(ingested) + " songs added in " + Duration(us) +
+                      ((us > 0) ? (", " + std::to_string(ingested * 1000 * 1000 / us) + " songs/s") : ""));
+   }
+
+   lines.push_back("");
+   lines.push_back("Lyrics");
+   lines.push_back("  fetch " + lyrics_.Summary());
+
+   lines.push_back("");
+   lines.push_back("Memory");
+
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+   struct mallinfo2 const info = mallinfo2();
+   lines.push_back("  heap in use " + Bytes(info.uordblks + info.hblkhd));
+#endif
+
+   for (auto it = memory_.begin(); (it != memory_.end()); ++it)
+   {
+      lines.push_back("  " + it->first + " " + Bytes(it->second()));
+   }
+
+   return lines;
+}
+
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,139 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   stats.hpp - timings and counters shown in the stats window
+   */
+
+#ifndef __MAIN__STATS
+#define __MAIN__STATS
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "compiler.hpp"
+#include "events.hpp"
+
+namespace Main
+{
+   //! Everything is recorded with atomic adds and no locks, so that the
+   //! stats can always be collected, they are only formatted when shown
+   class Stats
+   {
+      public:
+         //! Counts of durations in power of two microsecond buckets
+         class Histogram
+         {
+            public:
+               static uint32_t const Buckets = 25;
+
+            public:
+               Histogram();
+
+            public:
+               void Add(uint64_t us);
+
+               uint64_t Count() const;
+               uint64_t Max() const;
+               uint64_t Mean() const;
+
+               //! The upper bound of the bucket that holds the given percentile
+               uint64_t Percentile(uint32_t percent) const;
+
+               //! Count, mean, p50, p90, p99 and max on one line
+               std::string Summary() const;
+
+            private:
+               uint64_t buckets_[Buckets];
+               uint64_t count_;
+               uint64_t total_;
+               uint64_t max_;
+         };
+
+         //! Adds the time between construction and destruction to a histogram
+         class Timer
+         {
+            public:
+               Timer(Histogram & histogram) : histogram_(histogram), start_(Stats::Now()) { }
+               ~Timer() { histogram_.Add(Stats::Now() - start_); }
+
+            private:
+               Histogram &    histogram_;
+               uint64_t const start_;
+         };
+
+         typedef FUNCTION<uint64_t ()> MemoryFunction;
+
+      public:
+         static Stats & Instance();
+
+         //! Monotonic time in microseconds
+         static uint64_t Now();
+
+      protected:
+         Stats();
+         ~Stats();
+
+      private:
+         Stats(Stats const &);
+         Stats & operator=(Stats const &);
+
+      public:
+         //! Time spent in the queue and in the handlers for each type of event
+         Histogram & EventWait(int event)   { return eventWait_[event]; }
+         Histogram & EventHandle(int event) { return eventHandle_[event]; }
+         void QueueDepth(uint32_t depth);
+
+         //! Time taken to run each type of client command, including the round trips to mpd
+         Histogram & Command(char const * name);
+
+         Histogram & Repaint() { return repaint_; }
+         Histogram & Lyrics()  { return lyrics_; }
+
+         //! Songs added to the library since it was last cleared
+         void Ingest();
+         void IngestReset();
+
+         //! The function is called when the stats are shown, from the main thread
+         void RegisterMemory(std::string const & subsystem, MemoryFunction function);
+
+         //! The lines shown in the stats window
+         std::vector<std::string> Lines() const;
+
+      private:
+         Histogram eventWait_[Event::EventCount];
+         Histogram eventHandle_[Event::EventCount];
+         uint32_t  queueDepth_;
+         uint32_t  queueMax_;
+
+         mutable Mutex                              commandMutex_;
+         std::map<std::string, Histogram *>         commands_;
+
+         Histogram repaint_;
+         Histogram lyrics_;
+
+         uint64_t  ingested_;
+         uint64_t  ingestStart_;
+         uint64_t  ingestEnd_;
+
+         std::vector<std::pair<std::string, MemoryFunction> > memory_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
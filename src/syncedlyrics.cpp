@@ -0,0 +1,190 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   syncedlyrics.cpp - lyrics with the time each line is sung (lrc)
+   */
+
+#include "syncedlyrics.hpp"
+
+#include <algorithm>
+#include <ctype.h>
+#include <sstream>
+#include <stdlib.h>
+
+using namespace Main;
+
+SyncedLyrics::SyncedLyrics() :
+   times_(),
+   lines_()
+{
+}
+
+SyncedLyrics::~SyncedLyrics()
+{
+}
+
+bool SyncedLyrics::Parse(std::string const & lyrics)
+{
+   typedef std::pair<int64_t, std::string> TimedLine;
+
+   std::vector<TimedLine> timed;
+   std::stringstream      stream(lyrics);
+   std::string            line;
+   int64_t                offset = 0;
+
+   Clear();
+
+   while (std::getline(stream, line))
+   {
+      if ((line != "") && (line[line.size() - 1] == '\r'))
+      {
+         line.erase(line.size() - 1);
+      }
+
+      // A line can have several times, [00:12.00][01:30.50]chorus
+      std::vector<int64_t> times;
+      size_t               pos = 0;
+
+      while ((pos < line.size()) && (line[pos] == '['))
+      {
+         size_t const end = line.find(']', pos);
+
+         if (end == std::string::npos)
+         {
+            break;
+         }
+
+         std::string const tag = line.substr(pos + 1, end - pos - 1);
+         int64_t           time;
+
+         if (ParseTime(tag, time) == true)
+         {
+            times.push_back(time);
+         }
+         else if (tag.compare(0, 7, "offset:") == 0)
+         {
+            // A positive offset shows the lyrics sooner
+            offset = atoi(tag.c_str() + 7);
+         }
+
+         pos = end + 1;
+      }
+
+      if (times.empty() == true)
+      {
+         continue;
+      }
+
+      // Drop the times of the individual words in enhanced lrc, <00:12.50>
+      std::string text;
+
+      for (size_t i = pos; i < line.size(); ++i)
+      {
+         size_t const end = (line[i] == '<') ? line.find('>', i) : std::string::npos;
+         int64_t      time;
+
+         if ((end != std::string::npos) && (ParseTime(line.substr(i + 1, end - i - 1), time) == true))
+         {
+            i = end;
+         }
+         else
+         {
+            text += line[i];
+         }
+      }
+
+      text.erase(0, text.find_first_not_of(' '));
+
+      for (auto it = times.begin(); (it != times.end()); ++it)
+      {
+         timed.push_back(TimedLine(*it, text));
+      }
+   }
+
+   std::stable_sort(timed.begin(), timed.end(), [] (TimedLine const & a, TimedLine const & b) { return (a.first < b.first); });
+
+   times_.reserve(timed.size());
+   lines_.reserve(timed.size());
+
+   for (auto it = timed.begin(); (it != timed.end()); ++it)
+   {
+      times_.push_back(static_cast<uint32_t>(std::max<int64_t>(0, it->first - offset)));
+      lines_.push_back(it->second);
+   }
+
+   return (Empty() == false);
+}
+
+void SyncedLyrics::Clear()
+{
+   times_.clear();
+   lines_.clear();
+}
+
+int32_t SyncedLyrics::Line(uint32_t elapsedMs) const
+{
+   auto const it = std::upper_bound(times_.begin(), times_.end(), elapsedMs);
+   return static_cast<int32_t>(it - times_.begin()) - 1;
+}
+
+bool SyncedLyrics::ParseTime(std::string const & tag, int64_t & time)
+{
+   // mm:ss, mm:ss.xx or mm:ss.xxx
+   char const * current = tag.c_str();
+   char *       end      = NULL;
+
+   if (isdigit(*current) == 0)
+   {
+      return false;
+   }
+
+   long const minutes = strtol(current, &end, 10);
+
+   if ((*end != ':') || (isdigit(end[1]) == 0))
+   {
+      return false;
+   }
+
+   long const seconds = strtol(end + 1, &end, 10);
+   long       fraction = 0;
+
+   if ((*end == '.') || (*end == ':'))
+   {
+      char const * const start = end + 1;
+      fraction = strtol(start, &end, 10);
+
+      for (ptrdiff_t digits = end - start; digits < 3; ++digits)
+      {
+         fraction *= 10;
+      }
+
+      for (ptrdiff_t digits = end - start; digits > 3; --digits)
+      {
+         fraction /= 10;
+      }
+   }
+
+   if (*end != '\0')
+   {
+      return false;
+   }
+
+   time = (static_cast<int64_t>(minutes) * 60 + seconds) * 1000 + fraction;
+   return true;
+}
+
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,59 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   syncedlyrics.hpp - lyrics with the time each line is sung (lrc)
+   */
+
+#ifndef __MAIN__SYNCEDLYRICS
+#define __MAIN__SYNCEDLYRICS
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Main
+{
+   //! The lines are kept sorted by time, so the line for
+   //! any point in the song can be found by a binary search
+   class SyncedLyrics
+   {
+      public:
+         SyncedLyrics();
+         ~SyncedLyrics();
+
+      public:
+         //! Returns false, keeping nothing, if the lyrics have no time tags
+         bool Parse(std::string const & lyrics);
+         void Clear();
+
+         bool Empty() const { return times_.empty(); }
+         std::vector<std::string> const & Lines() const { return lines_; }
+
+         //! The line being sung at the given time, or -1 before the first line
+         int32_t Line(uint32_t elapsedMs) const;
+
+      private:
+         static bool ParseTime(std::string const & tag, int64_t & time);
+
+      private:
+         std::vector<uint32_t>    times_;
+         std::vector<std::string> lines_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,227 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   taskpool.cpp - worker threads shared by anything that can run in parallel
+   */
+
+#include "taskpool.hpp"
+
+#include <algorithm>
+
+#include "trace.hpp"
+#include "window/debug.hpp"
+
+using namespace Main;
+
+TaskPool::Task::Task(Lane lane, FUNCTION<void (Task const &)> const & work) :
+   lane_     (lane),
+   work_     (work),
+   cancelled_(false),
+   finished_ (false)
+{
+}
+
+bool TaskPool::Task::Finished()
+{
+   UniqueLock<Mutex> Lock(mutex_);
+   return finished_;
+}
+
+bool TaskPool::Task::Wait(int timeoutMs)
+{
+   UniqueLock<Mutex> Lock(mutex_);
+
+   if (finished_ == false)
+   {
+      ConditionWait(condition_, Lock, timeoutMs);
+   }
+
+   return finished_;
+}
+
+void TaskPool::Task::Run()
+{
+   if (cancelled_ == false)
+   {
+      work_(*this);
+   }
+
+   UniqueLock<Mutex> Lock(mutex_);
+   finished_ = true;
+   condition_.notify_all();
+}
+
+
+TaskPool & TaskPool::Instance()
+{
+   static TaskPool pool;
+   return pool;
+}
+
+TaskPool::TaskPool() :
+   idle_   (0),
+   next_   (0),
+   running_(true)
+{
+   uint32_t const workers = std::max<uint32_t>(1, Thread::hardware_concurrency());
+
+   for (uint32_t i = 0; i < workers; ++i)
+   {
+      queues_.push_back(new Queue());
+   }
+
+   for (uint32_t i = 0; i < workers; ++i)
+   {
+      workers_.push_back(new Thread(&TaskPool::Worker, this, i));
+   }
+
+   Debug("Started %u task pool workers", workers);
+}
+
+TaskPool::~TaskPool()
+{
+   {
+      UniqueLock<Mutex> Lock(mutex_);
+      running_ = false;
+      condition_.notify_all();
+   }
+
+   for (auto it = workers_.begin(); (it != workers_.end()); ++it)
+   {
+      (*it)->join();
+      delete *it;
+   }
+
+   // Anything still waiting on a task that never ran is woken
+   for (auto it = queues_.begin(); (it != queues_.end()); ++it)
+   {
+      for (uint32_t lane = 0; lane < Lanes; ++lane)
+      {
+         for (auto jt = (*it)->lanes_[lane].begin(); (jt != (*it)->lanes_[lane].end()); ++jt)
+         {
+            (*jt)->Cancel();
+            (*jt)->Run();
+         }
+      }
+
+      delete *it;
+   }
+}
+
+TaskPool::TaskPtr TaskPool::Submit(Lane lane, FUNCTION<void (Task const &)> const & work)
+{
+   TaskPtr const task(new Task(lane, work));
+
+   // Spread the tasks across the workers, stealing evens out any imbalance
+   Queue & queue = *queues_[__atomic_fetch_add(&next_, 1, __ATOMIC_RELAXED) % queues_.size()];
+
+   {
+      UniqueLock<Mutex> QueueLock(queue.mutex_);
+      queue.lanes_[lane].push_back(task);
+   }
+
+   // A worker counts itself idle before it last looks for work,
+   // so either it finds this task or it is woken here
+   if (__atomic_load_n(&idle_, __ATOMIC_SEQ_CST) > 0)
+   {
+      UniqueLock<Mutex> Lock(mutex_);
+      condition_.notify_one();
+   }
+
+   return task;
+}
+
+void TaskPool::Worker(uint32_t index)
+{
+   Main::Trace::NameThread("worker");
+
+   while (true)
+   {
+      TaskPtr task = Take(index);
+
+      if (task == NULL)
+      {
+         UniqueLock<Mutex> Lock(mutex_);
+         __atomic_add_fetch(&idle_, 1, __ATOMIC_SEQ_CST);
+
+         while ((running_ == true) && ((task = Take(index)) == NULL))
+         {
+            condition_.wait(Lock);
+         }
+
+         __atomic_sub_fetch(&idle_, 1, __ATOMIC_SEQ_CST);
+
+         if (task == NULL)
+         {
+            break;
+         }
+      }
+
+      task->Run();
+   }
+}
+
+TaskPool::TaskPtr TaskPool::Take(uint32_t index)
+{
+   // A higher priority lane anywhere is taken before a lower one in this
+   // worker's queue, within a lane this worker's own tasks come first
+   for (uint32_t lane = 0; lane < Lanes; ++lane)
+   {
+      {
+         Queue & queue = *queues_[index];
+         UniqueLock<Mutex> Lock(queue.mutex_);
+         std::deque<TaskPtr> & tasks = queue.lanes_[lane];
+
+         if (tasks.empty() == false)
+         {
+            TaskPtr const task = tasks.front();
+            tasks.pop_front();
+            return task;
+         }
+      }
+
+      TaskPtr const task = Steal(index, static_cast<Lane>(lane));
+
+      if (task != NULL)
+      {
+         return task;
+      }
+   }
+
+   return TaskPtr();
+}
+
+TaskPool::TaskPtr TaskPool::Steal(uint32_t index, Lane lane)
+{
+   for (uint32_t i = 1; i < queues_.size(); ++i)
+   {
+      Queue & queue = *queues_[(index + i) % queues_.size()];
+      UniqueLock<Mutex> Lock(queue.mutex_);
+      std::deque<TaskPtr> & tasks = queue.lanes_[lane];
+
+      if (tasks.empty() == false)
+      {
+         TaskPtr const task = tasks.back();
+         tasks.pop_back();
+         return task;
+      }
+   }
+
+   return TaskPtr();
+}
+
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,121 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   taskpool.hpp - worker threads shared by anything that can run in parallel
+   */
+
+#ifndef __MAIN__TASKPOOL
+#define __MAIN__TASKPOOL
+
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include "compiler.hpp"
+
+namespace Main
+{
+   //! There is a worker for each core, each with its own queue for every lane,
+   //! a worker with nothing queued in a lane takes from the back of another
+   //! worker's queue before it looks at a lower lane, and only takes the
+   //! pool's lock to sleep when there is nothing to steal
+   class TaskPool
+   {
+      public:
+         typedef enum
+         {
+            Interactive = 0, // The user is waiting for the result
+            Bulk,            // Large amounts of work the user has asked for
+            Background,      // Nobody is waiting for the result
+            Lanes
+         } Lane;
+
+         class Task
+         {
+            public:
+               Task(Lane lane, FUNCTION<void (Task const &)> const & work);
+
+            private:
+               Task(Task const &);
+               Task & operator=(Task const &);
+
+            public:
+               //! A task that has not started is skipped, a running task
+               //! should check Cancelled() and finish early
+               void Cancel()          { cancelled_ = true; }
+               bool Cancelled() const { return cancelled_; }
+               Lane GetLane() const   { return lane_; }
+
+               bool Finished();
+
+               //! Returns false if the task has not finished within the timeout
+               bool Wait(int timeoutMs);
+
+            private:
+               friend class TaskPool;
+               void Run();
+
+            private:
+               Lane const                          lane_;
+               FUNCTION<void (Task const &)> const work_;
+               Atomic(bool)                        cancelled_;
+               bool                                finished_;
+               Mutex                               mutex_;
+               ConditionVariable                   condition_;
+         };
+
+         typedef std::shared_ptr<Task> TaskPtr;
+
+      public:
+         static TaskPool & Instance();
+
+      protected:
+         TaskPool();
+         ~TaskPool();
+
+      public:
+         TaskPtr Submit(Lane lane, FUNCTION<void (Task const &)> const & work);
+         uint32_t Workers() const { return static_cast<uint32_t>(workers_.size()); }
+
+      private:
+         void Worker(uint32_t index);
+         TaskPtr Take(uint32_t index);
+         TaskPtr Steal(uint32_t index, Lane lane);
+
+      private:
+         class Queue
+         {
+            public:
+               Mutex               mutex_;
+               std::deque<TaskPtr> lanes_[Lanes];
+         };
+
+         std::vector<Queue *>  queues_;
+         std::vector<Thread *> workers_;
+
+         // Only taken by workers going to sleep and to wake them
+         Mutex                 mutex_;
+         ConditionVariable     condition_;
+         uint32_t              idle_;
+         uint32_t              next_;
+         bool                  running_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
@@ -31,6 +31,7 @@ namespace Ui
 {
    class Command;
    class Screen;
+   class Search;
 }
 
 namespace Mpc
@@ -60,6 +61,7 @@ namespace Main
          Main::Vimpc * Vimpc;
          Ui::Screen *  Screen;
          Ui::Command * Command;
+         Ui::Search *  Search;
          Mpc::Client * Client;
          Mpc::ClientState * ClientState;
       #endif
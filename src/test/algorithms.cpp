@@ -31,6 +31,8 @@ class AlgorithmTester : public CppUnit::TestFixture
    CPPUNIT_TEST(icompare);
    CPPUNIT_TEST(iequals);
    CPPUNIT_TEST(isNumeric);
+   CPPUNIT_TEST(mergeRanges);
+   CPPUNIT_TEST(orderMoves);
    CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -47,6 +49,8 @@ protected:
    void icompare();
    void iequals();
    void isNumeric();
+   void mergeRanges();
+   void orderMoves();
 
 private:
 };
@@ -116,5 +120,57 @@ void AlgorithmTester::isNumeric()
    CPPUNIT_ASSERT(Algorithm::isNumeric("123.45")  == false); //We do not support floats
 }
 
+void AlgorithmTester::mergeRanges()
+{
+   uint32_t const positions[] = { 9, 3, 4, 0, 5, 4, 12, 10 };
+
+   Algorithm::Ranges const ranges = Algorithm::MergeRanges(std::vector<uint32_t>(positions, positions + 8));
+
+   CPPUNIT_ASSERT(ranges.size() == 4);
+   CPPUNIT_ASSERT(ranges[0] == std::make_pair(0u, 1u));
+   CPPUNIT_ASSERT(ranges[1] == std::make_pair(3u, 6u));
+   CPPUNIT_ASSERT(ranges[2] == std::make_pair(9u, 11u));
+   CPPUNIT_ASSERT(ranges[3] == std::make_pair(12u, 13u));
+
+   CPPUNIT_ASSERT(Algorithm::MergeRanges(std::vector<uint32_t>()).empty() == true);
+}
+
+void AlgorithmTester::orderMoves()
+{
+   uint32_t const orders[][8] =
+   {
+      { 0, 1, 2, 3, 4, 5, 6, 7 },
+      { 7, 6, 5, 4, 3, 2, 1, 0 },
+      { 4, 5, 6, 7, 0, 1, 2, 3 },
+      { 1, 0, 3, 2, 5, 4, 7, 6 },
+      { 0, 1, 7, 2, 3, 4, 5, 6 },
+   };
+
+   uint32_t const expectedMoves[] = { 0, 7, 1, 4, 1 };
+
+   for (uint32_t i = 0; i < 5; ++i)
+   {
+      std::vector<uint32_t> const order(orders[i], orders[i] + 8);
+      std::vector<uint32_t>       list;
+
+      for (uint32_t j = 0; j < 8; ++j)
+      {
+         list.push_back(j);
+      }
+
+      Algorithm::Moves const moves = Algorithm::OrderMoves(order);
+
+      for (auto move : moves)
+      {
+         std::vector<uint32_t> const moved(list.begin() + move.start, list.begin() + move.end);
+         list.erase(list.begin() + move.start, list.begin() + move.end);
+         list.insert(list.begin() + move.to, moved.begin(), moved.end());
+      }
+
+      CPPUNIT_ASSERT(list == order);
+      CPPUNIT_ASSERT(moves.size() == expectedMoves[i]);
+   }
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(AlgorithmTester);
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AlgorithmTester, "algorithms");
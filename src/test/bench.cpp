@@ -0,0 +1,267 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   bench.cpp - runs a script of commands without a terminal and times them
+   */
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+
+#include "events.hpp"
+#include "mpdclient.hpp"
+#include "mpdstandin.hpp"
+#include "screen.hpp"
+#include "stats.hpp"
+#include "test.hpp"
+#include "vimpc.hpp"
+
+using namespace Main;
+
+namespace
+{
+   uint32_t const DefaultSongs   = 10000;
+   int const      DefaultRows    = 50;
+   int const      DefaultColumns = 200;
+
+   uint64_t Percentile(std::vector<uint64_t> const & sorted, uint32_t percent)
+   {
+      size_t const rank = (sorted.size() * percent + 99) / 100;
+      return sorted[(rank > 0) ? (rank - 1) : 0];
+   }
+}
+
+
+Bench::Bench(std::string const & script) :
+   script_  (script),
+   songs_   (DefaultSongs),
+   rows_    (DefaultRows),
+   columns_ (DefaultColumns),
+   started_ (false),
+   step_    (0),
+   start_   (0)
+{
+}
+
+int Bench::Run()
+{
+   if (Load() == false)
+   {
+      return 1;
+   }
+
+   MpdStandIn mpd(songs_);
+
+   if (mpd.Start() == false)
+   {
+      std::cerr << "vimpc: could not start the mpd stand-in" << std::endl;
+      return 1;
+   }
+
+   Ui::Screen::SetHeadless(rows_, columns_);
+
+   {
+      Main::Vimpc vimpc;
+
+      // Start once the library and playlist have been loaded
+      Vimpc::EventHandler(Event::AllMetaDataReady, [this] (EventData const & Data)
+      {
+         if (started_ == false)
+         {
+            started_ = true;
+            Sync();
+         }
+      });
+
+      Vimpc::EventHandler(Event::Bench, [this] (EventData const & Data)
+      {
+         if (Data.value == Typed)
+         {
+            Sync();
+         }
+         else if (Data.value == Completed)
+         {
+            EventData Repainted;
+            Repainted.value = Painted;
+
+            Vimpc::CreateEvent(Event::Repaint);
+            Vimpc::CreateEvent(Event::Bench, std::move(Repainted));
+         }
+         else
+         {
+            Next();
+         }
+      });
+
+      vimpc.Run("127.0.0.1", mpd.Port());
+   }
+
+   mpd.Stop();
+   Report();
+   return 0;
+}
+
+
+bool Bench::Load()
+{
+   std::ifstream file(script_.c_str());
+
+   if (file.is_open() == false)
+   {
+      std::cerr << "vimpc: could not open " << script_ << std::endl;
+      return false;
+   }
+
+   std::string line;
+
+   for (uint32_t number = 1; (std::getline(file, line)); ++number)
+   {
+      line.erase(0, line.find_first_not_of(" \t"));
+      line.erase(line.find_last_not_of(" \t\r") + 1);
+
+      if ((line.empty() == true) || (line[0] == '"'))
+      {
+         continue;
+      }
+
+      std::stringstream stream(line);
+      std::string       word;
+      uint32_t          repeat = 1;
+
+      stream >> word;
+
+      if (word == "songs")
+      {
+         stream >> songs_;
+      }
+      else if (word == "size")
+      {
+         stream >> rows_ >> columns_;
+      }
+      else
+      {
+         if (word == "repeat")
+         {
+            stream >> repeat;
+            std::getline(stream >> std::ws, line);
+         }
+
+         if (line[0] == ':')
+         {
+            line.erase(0, 1);
+         }
+
+         if ((stream.fail() == true) || (line.empty() == true))
+         {
+            std::cerr << "vimpc: " << script_ << ":" << number << ": expected a command" << std::endl;
+            return false;
+         }
+
+         commands_.push_back(line);
+         steps_.insert(steps_.end(), repeat, commands_.size() - 1);
+         continue;
+      }
+
+      if (stream.fail() == true)
+      {
+         std::cerr << "vimpc: " << script_ << ":" << number << ": expected a number" << std::endl;
+         return false;
+      }
+   }
+
+   samples_.resize(commands_.size());
+   return true;
+}
+
+void Bench::Next()
+{
+   // Nothing has been typed before the first step
+   if (start_ != 0)
+   {
+      samples_[steps_[step_]].push_back(Stats::Now() - start_);
+      ++step_;
+   }
+
+   if (step_ == steps_.size())
+   {
+      Vimpc::SetRunning(false);
+      return;
+   }
+
+   // Typed as keys so that the command goes through the same path as the user's
+   std::string const keys = ":" + commands_[steps_[step_]] + "\n";
+
+   start_ = Stats::Now();
+
+   for (auto key : keys)
+   {
+      EventData Data;
+      Data.input = key;
+      Vimpc::CreateEvent(Event::Input, std::move(Data));
+   }
+
+   EventData Data;
+   Data.value = Typed;
+   Vimpc::CreateEvent(Event::Bench, std::move(Data));
+}
+
+void Bench::Sync()
+{
+   // Runs after anything the command has queued for the client
+   Main::Tester::Instance().Client->QueueCommand("Bench", [] ()
+   {
+      EventData Data;
+      Data.value = Completed;
+      Vimpc::CreateEvent(Event::Bench, std::move(Data));
+   });
+}
+
+void Bench::Report() const
+{
+   char line[512];
+
+   snprintf(line, sizeof(line), "%8s %10s %10s %10s %10s  %s", "count", "p50 ms", "p90 ms", "p99 ms", "max ms", "command");
+   std::cout << line << std::endl;
+
+   for (uint32_t i = 0; i < commands_.size(); ++i)
+   {
+      std::vector<uint64_t> sorted(samples_[i]);
+
+      if (sorted.empty() == true)
+      {
+         continue;
+      }
+
+      std::sort(sorted.begin(), sorted.end());
+
+      snprintf(line, sizeof(line), "%8u %10.3f %10.3f %10.3f %10.3f  %s", static_cast<uint32_t>(sorted.size()),
+               Percentile(sorted, 50) / 1000.0, Percentile(sorted, 90) / 1000.0,
+               Percentile(sorted, 99) / 1000.0, sorted.back() / 1000.0, commands_[i].c_str());
+      std::cout << line << std::endl;
+   }
+
+   if (step_ < steps_.size())
+   {
+      std::cout << "stopped after " << step_ << " of " << steps_.size() << " commands" << std::endl;
+   }
+}
+
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,84 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   bench.hpp - runs a script of commands without a terminal and times them
+   */
+
+#ifndef __MAIN__BENCH
+#define __MAIN__BENCH
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Main
+{
+   //! Runs the commands of a script against a local mpd stand-in with a
+   //! headless screen. Each command is typed as keys and timed until the
+   //! client has finished what the command queued and the screen has been
+   //! repainted, the percentiles for each line of the script are printed
+   //! once vimpc has exited
+   //!
+   //! Besides commands a script may contain
+   //!   songs <count>           the size of the stand-in's library
+   //!   size <rows> <columns>   the size of the screen
+   //!   repeat <count> <command>
+   //! and comments starting with "
+   class Bench
+   {
+      public:
+         Bench(std::string const & script);
+
+      private:
+         Bench(Bench const &);
+         Bench & operator=(Bench const &);
+
+      public:
+         //! Returns the exit status for vimpc
+         int Run();
+
+      private:
+         typedef enum
+         {
+            Typed,
+            Completed,
+            Painted
+         } Stage;
+
+         bool Load();
+         void Next();
+         void Sync();
+         void Report() const;
+
+      private:
+         std::string                          script_;
+         uint32_t                             songs_;
+         int                                  rows_;
+         int                                  columns_;
+
+         std::vector<std::string>             commands_;
+         std::vector<uint32_t>                steps_;
+         std::vector<std::vector<uint64_t> >  samples_;
+
+         bool                                 started_;
+         uint32_t                             step_;
+         uint64_t                             start_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
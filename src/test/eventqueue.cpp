@@ -0,0 +1,267 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   eventqueue.cpp - tests for the queue of events to the main loop
+   */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <chrono>
+#include <list>
+#include <sstream>
+#include <vector>
+
+#include "buffers.hpp"
+#include "compiler.hpp"
+#include "eventqueue.hpp"
+#include "events.hpp"
+#include "window/console.hpp"
+
+typedef std::pair<int32_t, EventData> EventPair;
+
+class EventQueueTester : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(EventQueueTester);
+   CPPUNIT_TEST(payload);
+   CPPUNIT_TEST(full);
+   CPPUNIT_TEST(ordered);
+   CPPUNIT_TEST(throughput);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+   void setUp();
+   void tearDown();
+
+protected:
+   void payload();
+   void full();
+   void ordered();
+   void throughput();
+
+private:
+   //! Each producer pushes count events, returns the time taken to receive them all
+   uint64_t Run(uint32_t producers, uint32_t count, bool locked);
+};
+
+static uint32_t const Producers = 4;
+
+void EventQueueTester::setUp()
+{
+}
+
+void EventQueueTester::tearDown()
+{
+}
+
+void EventQueueTester::payload()
+{
+   EventData data;
+   data.name = "list";
+   data.Uris().push_back("a");
+   data.Uris().push_back("b");
+
+   EventData moved(std::move(data));
+   EventData const & result = moved;
+
+   CPPUNIT_ASSERT(result.name == "list");
+   CPPUNIT_ASSERT(result.Uris().size() == 2);
+   CPPUNIT_ASSERT(result.Uri() == "");
+   CPPUNIT_ASSERT(data.payload.GetType() == EventPayload::None);
+
+   // Asking for a different payload replaces it
+   moved.Uri() = "file";
+
+   CPPUNIT_ASSERT(result.payload.GetType() == EventPayload::UriType);
+   CPPUNIT_ASSERT(result.Uri() == "file");
+   CPPUNIT_ASSERT(result.Uris().empty() == true);
+}
+
+void EventQueueTester::full()
+{
+   Main::EventQueue<EventPair> queue(8);
+   EventPair event;
+
+   for (uint32_t i = 0; i < queue.Capacity(); ++i)
+   {
+      event.first = i;
+      CPPUNIT_ASSERT(queue.TryPush(std::move(event)) == true);
+   }
+
+   event.first = queue.Capacity();
+   CPPUNIT_ASSERT(queue.TryPush(std::move(event)) == false);
+
+   for (uint32_t i = 0; i < queue.Capacity(); ++i)
+   {
+      CPPUNIT_ASSERT(queue.TryPop(event) == true);
+      CPPUNIT_ASSERT(event.first == static_cast<int32_t>(i));
+   }
+
+   CPPUNIT_ASSERT(queue.Empty() == true);
+   CPPUNIT_ASSERT(queue.TryPop(event) == false);
+}
+
+void EventQueueTester::ordered()
+{
+   uint32_t const count = 20000;
+
+   Main::EventQueue<EventPair> queue(64);
+   std::vector<Thread *>       threads;
+   std::vector<int32_t>        last(Producers, -1);
+
+   for (uint32_t producer = 0; producer < Producers; ++producer)
+   {
+      threads.push_back(new Thread([&queue, producer, count] ()
+      {
+         for (uint32_t i = 0; i < count; ++i)
+         {
+            EventPair event(producer, EventData());
+            event.second.value = i;
+            event.second.Uri() = "file";
+
+            while (queue.TryPush(std::move(event)) == false)
+            {
+               ThisThread::yield();
+            }
+         }
+      }));
+   }
+
+   // Events from a single producer must arrive in the order they were pushed
+   for (uint32_t received = 0; received < (count * Producers); )
+   {
+      EventPair event;
+
+      if (queue.TryPop(event) == true)
+      {
+         CPPUNIT_ASSERT(event.second.value == last[event.first] + 1);
+         CPPUNIT_ASSERT(event.second.Uri() == "file");
+         last[event.first] = event.second.value;
+         ++received;
+      }
+      else
+      {
+         queue.Wait(100);
+      }
+   }
+
+   for (auto thread : threads)
+   {
+      thread->join();
+      delete thread;
+   }
+
+   CPPUNIT_ASSERT(queue.Empty() == true);
+}
+
+void EventQueueTester::throughput()
+{
+   uint32_t const count = 100000;
+
+   std::stringstream result;
+   result << "Events per second:";
+
+   for (uint32_t producers = 1; producers <= Producers; producers *= 2)
+   {
+      uint64_t const lockedUs = Run(producers, count, true);
+      uint64_t const queueUs  = Run(producers, count, false);
+
+      result << " " << producers << " producer(s) "
+             << (static_cast<uint64_t>(producers) * count * 1000000 / std::max<uint64_t>(1, lockedUs)) << " locked, "
+             << (static_cast<uint64_t>(producers) * count * 1000000 / std::max<uint64_t>(1, queueUs)) << " lock free;";
+   }
+
+   Main::TestConsole().Add(result.str());
+}
+
+
+uint64_t EventQueueTester::Run(uint32_t producers, uint32_t count, bool locked)
+{
+   // The locked queue is the way events used to be queued
+   Main::EventQueue<EventPair> queue(4096);
+   std::list<EventPair>        list;
+   Mutex                       mutex;
+   ConditionVariable           condition;
+   std::vector<Thread *>       threads;
+
+   auto const start = std::chrono::steady_clock::now();
+
+   for (uint32_t producer = 0; producer < producers; ++producer)
+   {
+      threads.push_back(new Thread([&, producer] ()
+      {
+         for (uint32_t i = 0; i < count; ++i)
+         {
+            EventPair event(producer, EventData());
+            event.second.value = i;
+
+            if (locked == true)
+            {
+               UniqueLock<Mutex> Lock(mutex);
+               list.push_back(std::move(event));
+               condition.notify_all();
+            }
+            else
+            {
+               while (queue.TryPush(std::move(event)) == false)
+               {
+                  ThisThread::yield();
+               }
+            }
+         }
+      }));
+   }
+
+   for (uint32_t received = 0; received < (count * producers); )
+   {
+      EventPair event;
+
+      if (locked == true)
+      {
+         UniqueLock<Mutex> Lock(mutex);
+
+         if ((list.empty() == false) || (ConditionWait(condition, Lock, 100) != false))
+         {
+            if (list.empty() == false)
+            {
+               event = std::move(list.front());
+               list.pop_front();
+               ++received;
+            }
+         }
+      }
+      else if (queue.TryPop(event) == true)
+      {
+         ++received;
+      }
+      else
+      {
+         queue.Wait(100);
+      }
+   }
+
+   for (auto thread : threads)
+   {
+      thread->join();
+      delete thread;
+   }
+
+   return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(EventQueueTester);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(EventQueueTester, "eventqueue");
+/* vim: set sw=3 ts=3: */
@@ -0,0 +1,163 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   filter.cpp - tests for the filtered view of a song buffer
+   */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <sstream>
+#include <vector>
+
+#include "settings.hpp"
+#include "song.hpp"
+#include "buffer/filter.hpp"
+
+class FilterTester : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(FilterTester);
+   CPPUNIT_TEST(escapes);
+   CPPUNIT_TEST(updates);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+   FilterTester() : settings_(Main::Settings::Instance()) { }
+
+public:
+   void setUp();
+   void tearDown();
+
+protected:
+   void escapes();
+   void updates();
+
+private:
+   bool Same(Mpc::Filter const & filter, std::string const & pattern);
+
+private:
+   Main::Settings &          settings_;
+   std::string               format_;
+   std::vector<Mpc::Song *>  songs_;
+   Mpc::Filter::SourceBuffer source_;
+};
+
+void FilterTester::setUp()
+{
+   format_ = settings_.Get(Setting::SongFormat);
+   settings_.Set(Setting::SongFormat, "%t");
+
+   for (uint32_t i = 0; i < 40; ++i)
+   {
+      std::stringstream title;
+      title << ((i % 2 == 0) ? "Apple " : "Banana ") << i;
+
+      Mpc::Song * song = new Mpc::Song();
+      song->SetTitle(title.str().c_str());
+      songs_.push_back(song);
+      source_.Add(song);
+   }
+}
+
+void FilterTester::tearDown()
+{
+   source_.Clear();
+
+   for (auto song : songs_)
+   {
+      delete song;
+   }
+
+   songs_.clear();
+   settings_.Set(Setting::SongFormat, format_);
+}
+
+bool FilterTester::Same(Mpc::Filter const & filter, std::string const & pattern)
+{
+   // A filter built from scratch is what an updated one should look like
+   Mpc::Filter fresh(source_);
+   fresh.SetPattern(pattern, Regex::CaseInsensitive);
+
+   bool Result = (fresh.Size() == filter.Size());
+
+   for (uint32_t i = 0; (Result == true) && (i < filter.Size()); ++i)
+   {
+      Result = (fresh.Row(i) == filter.Row(i));
+   }
+
+   return Result;
+}
+
+void FilterTester::escapes()
+{
+   Mpc::Filter filter(source_);
+
+   // The characters after these escapes are not literal text in the line
+   char const * const patterns[] = { "\\x41pple", "\\101pple", "\\p{Lu}pple", "\\Qapple\\E", "\\bapple\\s\\d" };
+
+   for (auto pattern : patterns)
+   {
+      filter.SetPattern(pattern, Regex::CaseInsensitive);
+      CPPUNIT_ASSERT(filter.Size() == 20);
+   }
+
+   filter.SetPattern("banana\\.", Regex::CaseInsensitive);
+   CPPUNIT_ASSERT(filter.Size() == 0);
+}
+
+void FilterTester::updates()
+{
+   std::string const pattern("apple");
+
+   Mpc::Filter filter(source_);
+   filter.SetPattern(pattern, Regex::CaseInsensitive);
+   CPPUNIT_ASSERT(filter.Size() == 20);
+
+   std::vector<Mpc::Song *> const added(songs_.begin(), songs_.begin() + 5);
+   source_.Add(added, 3);
+   CPPUNIT_ASSERT(Same(filter, pattern) == true);
+
+   std::vector<std::pair<uint32_t, uint32_t> > ranges;
+   ranges.push_back(std::make_pair(1, 4));
+   ranges.push_back(std::make_pair(10, 11));
+   ranges.push_back(std::make_pair(30, 100));
+   source_.Remove(ranges);
+   CPPUNIT_ASSERT(Same(filter, pattern) == true);
+
+   std::vector<uint32_t> order;
+
+   for (uint32_t i = 0; i < source_.Size(); ++i)
+   {
+      order.push_back((i * 7) % source_.Size());
+   }
+
+   // Only a permutation when the size shares no factor with 7
+   if (source_.Size() % 7 != 0)
+   {
+      source_.Reorder(order);
+      CPPUNIT_ASSERT(Same(filter, pattern) == true);
+   }
+
+   source_.Sort([] (Mpc::Song * a, Mpc::Song * b) { return (a->Title() > b->Title()); });
+   CPPUNIT_ASSERT(Same(filter, pattern) == true);
+
+   source_.Remove(0, 2);
+   source_.Replace(0, songs_[0]);
+   CPPUNIT_ASSERT(Same(filter, pattern) == true);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FilterTester);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(FilterTester, "filter");
@@ -0,0 +1,93 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   log.cpp - tests for formatting log messages
+   */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "log.hpp"
+
+class LogTester : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(LogTester);
+   CPPUNIT_TEST(format);
+   CPPUNIT_TEST(types);
+   CPPUNIT_TEST(truncate);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+   void setUp();
+   void tearDown();
+
+protected:
+   void format();
+   void types();
+   void truncate();
+};
+
+using Main::Log;
+
+void LogTester::setUp()
+{
+}
+
+void LogTester::tearDown()
+{
+}
+
+void LogTester::format()
+{
+   CPPUNIT_ASSERT(Log::Format(Log::Prepare(LogLevel::Info, "plain")) == "plain");
+   CPPUNIT_ASSERT(Log::Format(Log::Prepare(LogLevel::Info, "100%% done\n")) == "100% done");
+   CPPUNIT_ASSERT(Log::Format(Log::Prepare(LogLevel::Info, "%d:%s", 12, "a")) == "12:a");
+   CPPUNIT_ASSERT(Log::Format(Log::Prepare(LogLevel::Info, "[%5d] [%-3s] [%.2f] [%x]", 7, "b", 1.5, 255u)) == "[    7] [b  ] [1.50] [ff]");
+
+   // Missing arguments leave the conversion as it was
+   CPPUNIT_ASSERT(Log::Format(Log::Prepare(LogLevel::Info, "%d %s", 1)) == "1 %s");
+}
+
+void LogTester::types()
+{
+   std::string const name("song");
+   size_t const      size = 4000000000u;
+   char              buffer[16] = "buffer";
+
+   // Whatever the format asks for, the argument is printed as the type it was passed as
+   CPPUNIT_ASSERT(Log::Format(Log::Prepare(LogLevel::Info, "%d %d", size, -1)) == "4000000000 -1");
+   CPPUNIT_ASSERT(Log::Format(Log::Prepare(LogLevel::Info, "%s %s %s", name, buffer, 3)) == "song buffer 3");
+   CPPUNIT_ASSERT(Log::Format(Log::Prepare(LogLevel::Info, "%u %c", true, 'x')) == "1 x");
+}
+
+void LogTester::truncate()
+{
+   std::string const longer(Log::TextSize * 2, 'a');
+
+   // Strings share the text of the record, later ones are cut short
+   std::string const result = Log::Format(Log::Prepare(LogLevel::Info, "%s|%s", longer, "b"));
+
+   CPPUNIT_ASSERT(result == std::string(Log::TextSize - 1, 'a') + "|");
+
+   // Extra arguments are dropped
+   CPPUNIT_ASSERT(Log::Format(Log::Prepare(LogLevel::Info, "%d%d%d%d%d%d%d%d%d", 1, 2, 3, 4, 5, 6, 7, 8, 9)) == "12345678%d");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LogTester);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(LogTester, "log");
+/* vim: set sw=3 ts=3: */
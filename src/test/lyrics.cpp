@@ -0,0 +1,655 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   lyrics.cpp - tests for lyrics fetching and parsing
+   */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <map>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "buffers.hpp"
+#include "compiler.hpp"
+#include "lyricsfetcher.hpp"
+#include "syncedlyrics.hpp"
+#include "window/console.hpp"
+
+//! Stands in for the lyrics sites, the fetchers are pointed at it as an
+//! http proxy so each request carries the full url of the page it wants
+class RecordedSite
+{
+public:
+   RecordedSite() :
+      listen_   (-1),
+      port_     (0),
+      running_  (false),
+      acceptor_ (NULL)
+   { }
+
+   ~RecordedSite()
+   {
+      Stop();
+   }
+
+public:
+   bool Start()
+   {
+      sockaddr_in address;
+      socklen_t   length = sizeof(address);
+
+      memset(&address, 0, sizeof(address));
+      address.sin_family      = AF_INET;
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      address.sin_port        = 0;
+
+      listen_ = socket(AF_INET, SOCK_STREAM, 0);
+
+      if ((listen_ < 0) ||
+          (bind(listen_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) ||
+          (listen(listen_, 16) != 0) ||
+          (getsockname(listen_, reinterpret_cast<sockaddr *>(&address), &length) != 0))
+      {
+         Stop();
+         return false;
+      }
+
+      port_     = ntohs(address.sin_port);
+      running_  = true;
+      acceptor_ = new Thread([this] () { Accept(); });
+      return true;
+   }
+
+   void Stop()
+   {
+      running_ = false;
+
+      if (acceptor_ != NULL)
+      {
+         acceptor_->join();
+         delete acceptor_;
+         acceptor_ = NULL;
+      }
+
+      {
+         UniqueLock<Mutex> Lock(mutex_);
+
+         for (auto it = clients_.begin(); (it != clients_.end()); ++it)
+         {
+            shutdown(*it, SHUT_RDWR);
+         }
+      }
+
+      for (auto it = connections_.begin(); (it != connections_.end()); ++it)
+      {
+         (*it)->join();
+         delete *it;
+      }
+
+      connections_.clear();
+
+      if (listen_ >= 0)
+      {
+         close(listen_);
+         listen_ = -1;
+      }
+   }
+
+   std::string Proxy() const
+   {
+      std::stringstream proxy;
+      proxy << "http://127.0.0.1:" << port_;
+      return proxy.str();
+   }
+
+   void Serve(std::string const & url, std::string const & page)
+   {
+      UniqueLock<Mutex> Lock(mutex_);
+      pages_[url] = page;
+   }
+
+private:
+   void Accept()
+   {
+      while (running_ == true)
+      {
+         pollfd request = { listen_, POLLIN, 0 };
+
+         if (poll(&request, 1, 50) > 0)
+         {
+            int const client = accept(listen_, NULL, NULL);
+
+            if (client >= 0)
+            {
+               {
+                  UniqueLock<Mutex> Lock(mutex_);
+                  clients_.push_back(client);
+               }
+
+               connections_.push_back(new Thread([this, client] () { Handle(client); }));
+            }
+         }
+      }
+   }
+
+   void Handle(int client)
+   {
+      std::string buffer;
+      char        chunk[4096];
+
+      // Connections are kept alive so that handle and connection reuse is exercised
+      for (;;)
+      {
+         size_t const end = buffer.find("\r\n\r\n");
+
+         if (end == std::string::npos)
+         {
+            ssize_t const received = recv(client, chunk, sizeof(chunk), 0);
+
+            if (received <= 0)
+            {
+               break;
+            }
+
+            buffer.append(chunk, received);
+            continue;
+         }
+
+         std::string const request = buffer.substr(0, end);
+         buffer.erase(0, end + 4);
+
+         size_t const first  = request.find(' ');
+         size_t const second = (first != std::string::npos) ? request.find(' ', first + 1) : std::string::npos;
+
+         if ((second == std::string::npos) || (Respond(client, request.substr(first + 1, second - first - 1)) == false))
+         {
+            break;
+         }
+      }
+
+      {
+         UniqueLock<Mutex> Lock(mutex_);
+
+         for (auto it = clients_.begin(); (it != clients_.end()); ++it)
+         {
+            if (*it == client)
+            {
+               clients_.erase(it);
+               break;
+            }
+         }
+      }
+
+      close(client);
+   }
+
+   bool Respond(int client, std::string const & url)
+   {
+      std::string status = "200 OK";
+      std::string page;
+
+      {
+         UniqueLock<Mutex> Lock(mutex_);
+         auto const it = pages_.find(url);
+
+         if (it != pages_.end())
+         {
+            page = it->second;
+         }
+         else
+         {
+            status = "404 Not Found";
+            page   = "<html><body>Not Found</body></html>";
+         }
+      }
+
+      std::stringstream response;
+      response << "HTTP/1.1 " << status << "\r\n"
+               << "Content-Type: text/html; charset=utf-8\r\n"
+               << "Content-Length: " << page.size() << "\r\n\r\n" << page;
+
+      std::string const data = response.str();
+
+      for (size_t sent = 0; (sent < data.size()); )
+      {
+         ssize_t const result = send(client, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+         if (result <= 0)
+         {
+            return false;
+         }
+
+         sent += result;
+      }
+
+      return true;
+   }
+
+private:
+   int                                listen_;
+   uint16_t                           port_;
+   Atomic(bool)                       running_;
+   Thread *                           acceptor_;
+   std::vector<Thread *>              connections_;
+   std::vector<int>                   clients_;
+   std::map<std::string, std::string> pages_;
+   Mutex                              mutex_;
+};
+
+
+class LyricsTester : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(LyricsTester);
+   CPPUNIT_TEST(stripTags);
+   CPPUNIT_TEST(unescape);
+   CPPUNIT_TEST(htmlText);
+   CPPUNIT_TEST(extract);
+   CPPUNIT_TEST(synced);
+   CPPUNIT_TEST(providers);
+   CPPUNIT_TEST(notFound);
+   CPPUNIT_TEST(concurrent);
+   CPPUNIT_TEST(fetchLatency);
+   CPPUNIT_TEST(parseThroughput);
+   CPPUNIT_TEST_SUITE_END();
+
+private:
+   typedef struct
+   {
+      LyricsFetcher * fetcher;
+      std::string     url;
+      std::string     page;
+      std::string     expected;
+   } Recording;
+
+public:
+   LyricsTester() : site_(NULL) { }
+
+public:
+   void setUp();
+   void tearDown();
+
+protected:
+   void stripTags();
+   void unescape();
+   void htmlText();
+   void extract();
+   void synced();
+   void providers();
+   void notFound();
+   void concurrent();
+   void fetchLatency();
+   void parseThroughput();
+
+private:
+   void Record(Recording const & recording);
+   std::vector<Recording> Recordings();
+   static std::string Filler(size_t bytes);
+
+private:
+   RecordedSite * site_;
+
+   LrclibFetcher         lrclib_;
+   LyricwikiFetcher      lyricwiki_;
+   AzLyricsFetcher       azlyrics_;
+   Sing365Fetcher        sing365_;
+   LyricsmaniaFetcher    lyricsmania_;
+   MetrolyricsFetcher    metrolyrics_;
+   JustSomeLyricsFetcher justsomelyrics_;
+};
+
+static char const * const Artist = "Artist";
+static char const * const Title  = "Title";
+static char const * const Lyrics = "First line\nSecond line & more\n[Chorus]";
+
+void LyricsTester::setUp()
+{
+   site_ = new RecordedSite();
+   CPPUNIT_ASSERT(site_->Start() == true);
+   Curl::setProxy(site_->Proxy());
+}
+
+void LyricsTester::tearDown()
+{
+   Curl::setProxy("");
+   delete site_;
+   site_ = NULL;
+}
+
+void LyricsTester::stripTags()
+{
+   std::string data = "<p class=\"verse\">One<br />\r\nTwo</p>\tthree";
+   stripHtmlTags(data);
+   CPPUNIT_ASSERT(data == "One\nTwo three");
+
+   data = "&quot;Rock &amp; Roll&quot; isn&#039;t&nbsp;dead";
+   stripHtmlTags(data);
+   CPPUNIT_ASSERT(data == "\"Rock & Roll\" isn't dead");
+}
+
+void LyricsTester::unescape()
+{
+   CPPUNIT_ASSERT(unescapeHtmlUtf8("a&#98;c") == "abc");
+   CPPUNIT_ASSERT(unescapeHtmlUtf8("caf&#233;") == "caf\xc3\xa9");
+   CPPUNIT_ASSERT(unescapeHtmlUtf8("it&#8217;s") == "it\xe2\x80\x99s");
+   CPPUNIT_ASSERT(unescapeHtmlUtf8("a & b &amp; c") == "a & b &amp; c");
+}
+
+void LyricsTester::htmlText()
+{
+   std::string const html = "\r\n <p>One<br />Two &amp; &lt;3</p>\r\nit&#8217;s&#x21;&#10;\t&bogus; &\r\n";
+
+   CPPUNIT_ASSERT(htmlToText(html.data(), html.size()) == "OneTwo & <3\nit\xe2\x80\x99s!\n &bogus; &");
+   CPPUNIT_ASSERT(htmlToText(html.data(), html.size(), HtmlBreakLines | HtmlSkipEncodedNewlines) == "One\nTwo & <3\nit\xe2\x80\x99s! &bogus; &");
+
+   std::string const ads = "<div class=\"ad\">Ringtones <div>nested</div> here</div>One<br>Two<DIV>more ads</DIV>";
+   CPPUNIT_ASSERT(htmlToText(ads.data(), ads.size(), HtmlBreakLines | HtmlSkipDivs) == "One\nTwo");
+}
+
+void LyricsTester::extract()
+{
+   std::string const page = "<html><div class=\"a\">no</div><div class=\"lyrics\"><b>x</b></b>One\nTwo</div>rest</html>";
+   std::vector<std::string> const start = { "<div class=\"lyrics\">", "</b>" };
+
+   // Every chunk size, so that each marker is split between writes at some point
+   for (size_t chunk = 1; chunk <= page.size(); ++chunk)
+   {
+      HtmlExtractor extractor(start, "</div>");
+      size_t offset = 0;
+
+      for (; (offset < page.size()) && (extractor.feed(page.data() + offset, std::min(chunk, page.size() - offset)) == false); offset += chunk) { }
+
+      CPPUNIT_ASSERT(extractor.complete() == true);
+      CPPUNIT_ASSERT(extractor.content() == "</b>One\nTwo");
+      CPPUNIT_ASSERT(offset < page.size() - 4);
+   }
+
+   HtmlExtractor missing(start, "</div>");
+   CPPUNIT_ASSERT(missing.feed(page.data(), page.find("</b>")) == false);
+   CPPUNIT_ASSERT(missing.complete() == false);
+}
+
+void LyricsTester::synced()
+{
+   Main::SyncedLyrics lyrics;
+
+   CPPUNIT_ASSERT(lyrics.Parse(Lyrics) == false);
+   CPPUNIT_ASSERT(lyrics.Empty() == true);
+
+   // Out of order, repeated lines, an offset and the times of each word
+   CPPUNIT_ASSERT(lyrics.Parse("[ar:Artist]\r\n[offset:+500]\r\n[00:10.00][01:00.5]Chorus\r\n"
+                               "[00:02.25] <00:02.25>First <00:03.100>line\r\n[00:05]Second\r\nNot timed\r\n") == true);
+
+   std::vector<std::string> const & lines = lyrics.Lines();
+   CPPUNIT_ASSERT(lines.size() == 4);
+   CPPUNIT_ASSERT(lines[0] == "First line");
+   CPPUNIT_ASSERT(lines[1] == "Second");
+   CPPUNIT_ASSERT(lines[2] == "Chorus");
+   CPPUNIT_ASSERT(lines[3] == "Chorus");
+
+   CPPUNIT_ASSERT(lyrics.Line(0) == -1);
+   CPPUNIT_ASSERT(lyrics.Line(1749) == -1);
+   CPPUNIT_ASSERT(lyrics.Line(1750) == 0);
+   CPPUNIT_ASSERT(lyrics.Line(4500) == 1);
+   CPPUNIT_ASSERT(lyrics.Line(59999) == 2);
+   CPPUNIT_ASSERT(lyrics.Line(60000) == 3);
+   CPPUNIT_ASSERT(lyrics.Line(600000) == 3);
+}
+
+void LyricsTester::providers()
+{
+   std::vector<Recording> const recordings = Recordings();
+
+   for (auto it = recordings.begin(); (it != recordings.end()); ++it)
+   {
+      Record(*it);
+
+      LyricsFetcher::Result const result = it->fetcher->fetch(Artist, Title);
+      CPPUNIT_ASSERT_MESSAGE(it->fetcher->name(), result.first == true);
+      CPPUNIT_ASSERT_MESSAGE(it->fetcher->name(), result.second == it->expected);
+   }
+
+   // The search only gives a link for the last fetcher
+   InternetLyricsFetcher internet;
+   site_->Serve(internet.begin(Artist, Title).url,
+                "<HTML><BODY>The document has moved <A HREF=\"http://www.songlyrics.example/artist/title\">here</A>.</BODY></HTML>");
+
+   LyricsFetcher::Result const result = internet.fetch(Artist, Title);
+   CPPUNIT_ASSERT(result.first == false);
+   CPPUNIT_ASSERT(result.second.find("http://www.songlyrics.example/artist/title") != std::string::npos);
+}
+
+void LyricsTester::notFound()
+{
+   // Nothing is served, so every site gives a 404 page
+   std::vector<Recording> const recordings = Recordings();
+
+   for (auto it = recordings.begin(); (it != recordings.end()); ++it)
+   {
+      LyricsFetcher::Result const result = it->fetcher->fetch(Artist, Title);
+      CPPUNIT_ASSERT_MESSAGE(it->fetcher->name(), result.first == false);
+      CPPUNIT_ASSERT_MESSAGE(it->fetcher->name(), result.second == LyricsFetcher::msgNotFound);
+   }
+
+   // Links to the sitemap are not followed
+   site_->Serve(metrolyrics_.begin(Artist, Title).url,
+                "<A HREF=\"http://www.metrolyrics.com/sitemap.xml\">here</A>");
+   site_->Serve("http://www.metrolyrics.com/sitemap.xml", "<div id=\"lyrics-body\">Not lyrics</div>");
+
+   CPPUNIT_ASSERT(metrolyrics_.fetch(Artist, Title).first == false);
+}
+
+void LyricsTester::concurrent()
+{
+   // Everything but the first site has the lyrics, so the second should win
+   std::vector<Recording> const recordings = Recordings();
+
+   for (auto it = recordings.begin() + 1; (it != recordings.end()); ++it)
+   {
+      Record(*it);
+   }
+
+   bool missing = false;
+   LyricsFetcher::Result const result = fetchLyricsConcurrently(Artist, Title, missing);
+
+   CPPUNIT_ASSERT(result.first == true);
+   CPPUNIT_ASSERT(result.second == Lyrics);
+}
+
+void LyricsTester::fetchLatency()
+{
+   uint32_t const fetches = 20;
+
+   std::vector<Recording> recordings = Recordings();
+   std::stringstream results;
+
+   results << "Fetch latency over " << fetches << " fetches:";
+
+   for (auto it = recordings.begin(); (it != recordings.end()); ++it)
+   {
+      // Real pages are mostly navigation and adverts around the lyrics
+      it->page = Filler(100 * 1024) + it->page + Filler(100 * 1024);
+      Record(*it);
+
+      Curl::Pool const & pool = Curl::Pool::instance();
+      unsigned const transfers = pool.transfers();
+      unsigned const reused    = pool.reused();
+
+      auto const start = std::chrono::steady_clock::now();
+
+      for (uint32_t i = 0; i < fetches; ++i)
+      {
+         CPPUNIT_ASSERT_MESSAGE(it->fetcher->name(), it->fetcher->fetch(Artist, Title).second == it->expected);
+      }
+
+      auto const us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+      results << " " << it->fetcher->name() << " " << (us / fetches) << "us ("
+              << (pool.reused() - reused) << "/" << (pool.transfers() - transfers) << " reused)";
+   }
+
+   Main::TestConsole().Add(results.str());
+}
+
+void LyricsTester::parseThroughput()
+{
+   uint32_t const iterations = 20;
+
+   std::string const page = Filler(256 * 1024) +
+      "<!-- start of lyrics -->\r\nFirst line<br>\r\nSecond line &amp; more<br>\r\n<i>[Chorus]</i>\r\n<!-- end of lyrics -->" +
+      Filler(256 * 1024);
+
+   auto start = std::chrono::steady_clock::now();
+
+   // The whole page searched with the expression
+   for (uint32_t i = 0; i < iterations; ++i)
+   {
+      LyricsFetcher::Request request;
+      LyricsFetcher::Result  result;
+
+      request.step = 1;
+      azlyrics_.next(request, page, result);
+
+      CPPUNIT_ASSERT(result.second == Lyrics);
+   }
+
+   auto const regexUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+   start = std::chrono::steady_clock::now();
+
+   // The page fed in as curl would write it, stopping at the end of the lyrics
+   for (uint32_t i = 0; i < iterations; ++i)
+   {
+      // The request for the lyrics page, rather than for the search
+      LyricsFetcher::Request request = azlyrics_.LyricsFetcher::begin(Artist, Title);
+      LyricsFetcher::Result  result;
+
+      for (size_t offset = 0; (offset < page.size()) && (request.extractor.feed(page.data() + offset, std::min<size_t>(16384, page.size() - offset)) == false); offset += 16384) { }
+
+      request.step = 1;
+      azlyrics_.next(request, "", result);
+
+      CPPUNIT_ASSERT(result.second == Lyrics);
+   }
+
+   auto const streamUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+   std::stringstream result;
+   result << "Parse " << iterations << " pages of " << (page.size() / 1024) << "KB: "
+          << (regexUs / iterations) << "us per page searched, "
+          << (streamUs / iterations) << "us per page streamed";
+   Main::TestConsole().Add(result.str());
+}
+
+
+void LyricsTester::Record(Recording const & recording)
+{
+   std::string const search = recording.fetcher->begin(Artist, Title).url;
+
+   if (dynamic_cast<LrclibFetcher *>(recording.fetcher) != NULL)
+   {
+      // The lyrics come straight from the search
+   }
+   else if (dynamic_cast<LyricwikiFetcher *>(recording.fetcher) != NULL)
+   {
+      site_->Serve(search,
+         "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<LyricsResult>\n<artist>Artist</artist>\n<song>Title</song>\n"
+         "<lyrics>First line...</lyrics>\n<url>" + recording.url + "</url>\n</LyricsResult>\n");
+   }
+   else
+   {
+      site_->Serve(search,
+         "<HTML><HEAD><meta http-equiv=\"content-type\" content=\"text/html;charset=utf-8\">\n"
+         "<TITLE>302 Moved</TITLE></HEAD><BODY>\n<H1>302 Moved</H1>\nThe document has moved\n"
+         "<A HREF=\"" + recording.url + "\">here</A>.\r\n</BODY></HTML>\r\n");
+   }
+
+   site_->Serve(recording.url, recording.page);
+}
+
+std::vector<LyricsTester::Recording> LyricsTester::Recordings()
+{
+   // Trimmed down copies of the pages each site served, in the order of lyricsPlugins
+   std::vector<Recording> recordings;
+
+   Recording const lrclib = { &lrclib_, "http://lrclib.net/api/get?artist_name=Artist&track_name=Title",
+      "{\"id\":1,\"trackName\":\"Title\",\"artistName\":\"Artist\",\"instrumental\":false,"
+      "\"plainLyrics\":\"First line\\nSecond line & more\",\"syncedLyrics\":\"[00:01.00] First line\\n"
+      "[00:05.50] Second line & \\\"more\\\"\\n[00:09.00] [Chorus] caf\\u00e9 \\ud83c\\udfb5\"}",
+      "[00:01.00] First line\n[00:05.50] Second line & \"more\"\n[00:09.00] [Chorus] caf\xc3\xa9 \xf0\x9f\x8e\xb5" };
+
+   Recording const lyricwiki = { &lyricwiki_, "http://lyrics.wikia.com/Artist:Title",
+      "<div class='lyricbox'><script>var ad = 1;</script>First line<br />Second line &#38; more<br />&#91;Chorus&#93;"
+      "<!--\nNewPP limit report\n--></div>",
+      Lyrics };
+
+   Recording const azlyrics = { &azlyrics_, "http://www.azlyrics.com/lyrics/artist/title.html",
+      "<div>\n<!-- start of lyrics -->\r\nFirst line<br>\r\nSecond line &amp; more<br>\r\n<i>[Chorus]</i>\r\n"
+      "<!-- end of lyrics -->\n</div>",
+      Lyrics };
+
+   Recording const sing365 = { &sing365_, "http://www.sing365.com/music/lyric.nsf/title-lyrics-artist/1",
+      "<script src=\"//srv.tonefuse.com/showads/showad.js\"></script>\n<div style=\"ad\">Ringtones</div>"
+      "First line<br>\nSecond line &amp; more<br>\n[Chorus]<br>\n<script>\n/* Sing365 - Below Lyrics */\n</script>",
+      Lyrics };
+
+   Recording const lyricsmania = { &lyricsmania_, "http://www.lyricsmania.com/title_lyrics_artist.html",
+      "<div class=\"lyrics-body\">\n<div class=\"fb-quotes\"></div>\n<strong>Artist - Title lyrics</strong>\n"
+      "First line<br />\nSecond line &amp; more<br />\n[Chorus]</div>\n",
+      Lyrics };
+
+   Recording const metrolyrics = { &metrolyrics_, "http://www.metrolyrics.com/title-lyrics-artist.html",
+      "<div id=\"lyrics-body\">\n<p class='verse'>First line<br />&#10;Second line &amp; more<br />&#10;"
+      "[Chorus] caf&#233;</p>\n</div>",
+      std::string(Lyrics) + " caf\xc3\xa9" };
+
+   Recording const justsomelyrics = { &justsomelyrics_, "http://www.justsomelyrics.com/1/artist-title-lyrics.html",
+      "<div class=\"core-left\">\nFirst line<br>\nSecond line &amp; more<br>\n[Chorus]\n</div>",
+      Lyrics };
+
+   recordings.push_back(lrclib);
+   recordings.push_back(lyricwiki);
+   recordings.push_back(azlyrics);
+   recordings.push_back(sing365);
+   recordings.push_back(lyricsmania);
+   recordings.push_back(metrolyrics);
+   recordings.push_back(justsomelyrics);
+   return recordings;
+}
+
+std::string LyricsTester::Filler(size_t bytes)
+{
+   std::string Result;
+   Result.reserve(bytes + 128);
+
+   while (Result.size() < bytes)
+   {
+      Result += "<div class=\"nav\"><a href=\"/lyrics/other/song.html\">Other Song Lyrics</a></div>\n";
+   }
+
+   return Result;
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LyricsTester);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(LyricsTester, "lyrics");
@@ -0,0 +1,1035 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   mpdstandin.cpp - answers the mpd protocol from an in memory library
+   */
+
+#include "mpdstandin.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Main;
+
+namespace
+{
+   // Large responses are sent as they are built rather than all at once
+   size_t const SendSize = 1024 * 1024;
+
+   uint32_t const SongsPerAlbum  = 10;
+   uint32_t const AlbumsPerArtist = 10;
+
+   std::string Number(char const * format, uint32_t value)
+   {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), format, value);
+      return buffer;
+   }
+
+   std::string Lower(std::string value)
+   {
+      std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+      return value;
+   }
+
+   bool Unsigned(std::string const & value, uint32_t & result)
+   {
+      char * end = NULL;
+      unsigned long const parsed = strtoul(value.c_str(), &end, 10);
+
+      result = static_cast<uint32_t>(parsed);
+      return ((value.empty() == false) && (*end == '\0'));
+   }
+}
+
+
+MpdStandIn::MpdStandIn(uint32_t songs) :
+   listen_       (-1),
+   port_         (0),
+   running_      (false),
+   acceptor_     (NULL),
+   version_      (1),
+   nextId_       (1),
+   current_      (-1),
+   state_        ("stop"),
+   outputEnabled_(true)
+{
+   options_["volume"]  = "100";
+   options_["repeat"]  = "0";
+   options_["random"]  = "0";
+   options_["single"]  = "0";
+   options_["consume"] = "0";
+   options_["xfade"]   = "0";
+
+   Generate(songs);
+}
+
+MpdStandIn::~MpdStandIn()
+{
+   Stop();
+}
+
+bool MpdStandIn::Start()
+{
+   sockaddr_in address;
+   socklen_t   length = sizeof(address);
+
+   memset(&address, 0, sizeof(address));
+   address.sin_family      = AF_INET;
+   address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   address.sin_port        = 0;
+
+   listen_ = socket(AF_INET, SOCK_STREAM, 0);
+
+   if ((listen_ < 0) ||
+       (bind(listen_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) ||
+       (listen(listen_, 16) != 0) ||
+       (getsockname(listen_, reinterpret_cast<sockaddr *>(&address), &length) != 0))
+   {
+      Stop();
+      return false;
+   }
+
+   port_     = ntohs(address.sin_port);
+   running_  = true;
+   acceptor_ = new Thread([this] () { Accept(); });
+   return true;
+}
+
+void MpdStandIn::Stop()
+{
+   running_ = false;
+
+   if (acceptor_ != NULL)
+   {
+      acceptor_->join();
+      delete acceptor_;
+      acceptor_ = NULL;
+   }
+
+   for (auto connection : connections_)
+   {
+      shutdown(connection->fd, SHUT_RDWR);
+      connection->thread->join();
+      close(connection->fd);
+
+      delete connection->thread;
+      delete connection;
+   }
+
+   connections_.clear();
+
+   if (listen_ >= 0)
+   {
+      close(listen_);
+      listen_ = -1;
+   }
+}
+
+
+void MpdStandIn::Generate(uint32_t songs)
+{
+   songs_.reserve(songs);
+   directories_[""];
+
+   // Zero padded so that the uris are generated in sorted order
+   for (uint32_t i = 0; i < songs; ++i)
+   {
+      uint32_t const track  = i % SongsPerAlbum;
+      uint32_t const album  = (i / SongsPerAlbum) % AlbumsPerArtist;
+      uint32_t const artist = i / (SongsPerAlbum * AlbumsPerArtist);
+
+      Song song;
+      song.artist   = Number("Artist %06u", artist + 1);
+      song.album    = Number("Album %02u", album + 1);
+      song.title    = Number("Track %02u", track + 1);
+      song.track    = track + 1;
+      song.duration = 120 + (i % 240);
+
+      std::string const albumPath = song.artist + "/" + song.album;
+      song.uri = albumPath + "/" + Number("%02u - ", track + 1) + song.title + ".mp3";
+
+      if (track == 0)
+      {
+         if (album == 0)
+         {
+            directories_[""].directories.push_back(song.artist);
+         }
+
+         directories_[song.artist].directories.push_back(albumPath);
+      }
+
+      directories_[albumPath].songs.push_back(i);
+      songs_.push_back(song);
+   }
+}
+
+
+void MpdStandIn::Accept()
+{
+   while (running_ == true)
+   {
+      pollfd request = { listen_, POLLIN, 0 };
+
+      if (poll(&request, 1, 50) > 0)
+      {
+         int const client = accept(listen_, NULL, NULL);
+
+         if (client >= 0)
+         {
+            Connection * connection = new Connection();
+            connection->fd = client;
+
+            {
+               UniqueLock<Mutex> Lock(mutex_);
+               connections_.push_back(connection);
+            }
+
+            connection->thread = new Thread([this, connection] () { Serve(connection); });
+         }
+      }
+   }
+}
+
+void MpdStandIn::Serve(Connection * connection)
+{
+   std::string              input;
+   std::string              output("OK MPD 0.21.0\n");
+   std::vector<std::string> list;
+   bool                     inList = false;
+   bool                     listOk = false;
+   char                     chunk[65536];
+
+   while ((running_ == true) && (Send(connection->fd, output) == true))
+   {
+      size_t const end = input.find('\n');
+
+      if (end == std::string::npos)
+      {
+         pollfd request = { connection->fd, POLLIN, 0 };
+
+         if (poll(&request, 1, 50) > 0)
+         {
+            ssize_t const received = recv(connection->fd, chunk, sizeof(chunk), 0);
+
+            if (received <= 0)
+            {
+               break;
+            }
+
+            input.append(chunk, received);
+         }
+
+         continue;
+      }
+
+      std::string const line = input.substr(0, end);
+      input.erase(0, end + 1);
+
+      if (inList == true)
+      {
+         if (line == "command_list_end")
+         {
+            UniqueLock<Mutex> Lock(mutex_);
+
+            uint32_t index = 0;
+
+            for (; (index < list.size()) && (Execute(connection, list[index], index, output) == true); ++index)
+            {
+               if (listOk == true)
+               {
+                  output += "list_OK\n";
+               }
+            }
+
+            if (index == list.size())
+            {
+               output += "OK\n";
+            }
+
+            inList = false;
+            list.clear();
+         }
+         else
+         {
+            list.push_back(line);
+         }
+      }
+      else if ((line == "command_list_begin") || (line == "command_list_ok_begin"))
+      {
+         inList = true;
+         listOk = (line == "command_list_ok_begin");
+      }
+      else if ((line == "idle") || (line.find("idle ") == 0))
+      {
+         if ((Send(connection->fd, output) == false) || (Idle(connection, input, output) == false))
+         {
+            break;
+         }
+      }
+      else if (line == "close")
+      {
+         break;
+      }
+      else if (line != "noidle")
+      {
+         UniqueLock<Mutex> Lock(mutex_);
+
+         if (Execute(connection, line, 0, output) == true)
+         {
+            output += "OK\n";
+         }
+      }
+   }
+}
+
+bool MpdStandIn::Idle(Connection * connection, std::string & input, std::string & output)
+{
+   char chunk[4096];
+
+   for (;;)
+   {
+      // Anything sent while idle, normally a noidle, ends it
+      size_t const end = input.find('\n');
+
+      {
+         UniqueLock<Mutex> Lock(mutex_);
+
+         if ((connection->changed.empty() == false) || (end != std::string::npos))
+         {
+            for (auto const & subsystem : connection->changed)
+            {
+               output += "changed: " + subsystem + "\n";
+            }
+
+            connection->changed.clear();
+            output += "OK\n";
+
+            if ((end != std::string::npos) && (input.compare(0, end, "noidle") == 0))
+            {
+               input.erase(0, end + 1);
+            }
+
+            return true;
+         }
+      }
+
+      pollfd request = { connection->fd, POLLIN, 0 };
+
+      if (running_ == false)
+      {
+         return false;
+      }
+
+      if (poll(&request, 1, 50) > 0)
+      {
+         ssize_t const received = recv(connection->fd, chunk, sizeof(chunk), 0);
+
+         if (received <= 0)
+         {
+            return false;
+         }
+
+         input.append(chunk, received);
+      }
+   }
+}
+
+bool MpdStandIn::Send(int fd, std::string & output)
+{
+   for (size_t sent = 0; (sent < output.size()); )
+   {
+      ssize_t const result = send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL);
+
+      if (result <= 0)
+      {
+         return false;
+      }
+
+      sent += result;
+   }
+
+   output.clear();
+   return true;
+}
+
+
+bool MpdStandIn::Execute(Connection * connection, std::string const & line, uint32_t index, std::string & output)
+{
+   Arguments const arguments = Split(line);
+   std::string     error;
+
+   int const result = (arguments.empty() == false) ? Command(connection, arguments, output, error) : 5;
+
+   if (result != 0)
+   {
+      output += "ACK [" + std::to_string(result) + "@" + std::to_string(index) + "] {" +
+                ((arguments.empty() == false) ? arguments[0] : "") + "} " + error + "\n";
+      return false;
+   }
+
+   return true;
+}
+
+int MpdStandIn::Command(Connection * connection, Arguments const & arguments, std::string & output, std::string & error)
+{
+   static int const Ok       = 0;
+   static int const Argument = 2;
+   static int const Unknown  = 5;
+   static int const NoExist  = 50;
+   static int const Exist    = 56;
+
+   std::string const & name  = arguments[0];
+   size_t const        count = arguments.size() - 1;
+   uint32_t            start = 0;
+   uint32_t            end   = 0;
+
+   if ((name == "ping") || (name == "password") || (name == "clearerror") || (name == "seek"))
+   {
+   }
+   else if (name == "status")
+   {
+      output += "volume: "  + options_["volume"] + "\n" +
+                "repeat: "  + options_["repeat"] + "\n" +
+                "random: "  + options_["random"] + "\n" +
+                "single: "  + options_["single"] + "\n" +
+                "consume: " + options_["consume"] + "\n" +
+                "playlist: " + std::to_string(version_) + "\n" +
+                "playlistlength: " + std::to_string(queue_.size()) + "\n" +
+                "xfade: "   + options_["xfade"] + "\n" +
+                "state: "   + state_ + "\n";
+
+      if ((current_ >= 0) && (static_cast<uint32_t>(current_) < queue_.size()))
+      {
+         Entry const & entry = queue_[current_];
+
+         output += "song: " + std::to_string(current_) + "\n" +
+                   "songid: " + std::to_string(entry.id) + "\n" +
+                   "time: 0:" + std::to_string(songs_[entry.song].duration) + "\n" +
+                   "elapsed: 0.000\n";
+
+         if (static_cast<uint32_t>(current_) + 1 < queue_.size())
+         {
+            output += "nextsong: " + std::to_string(current_ + 1) + "\n" +
+                      "nextsongid: " + std::to_string(queue_[current_ + 1].id) + "\n";
+         }
+      }
+   }
+   else if (name == "stats")
+   {
+      output += "artists: " + std::to_string(directories_[""].directories.size()) + "\n" +
+                "albums: " + std::to_string((songs_.size() + SongsPerAlbum - 1) / SongsPerAlbum) + "\n" +
+                "songs: " + std::to_string(songs_.size()) + "\n" +
+                "uptime: 0\nplaytime: 0\ndb_playtime: 0\ndb_update: 0\n";
+   }
+   else if (name == "currentsong")
+   {
+      if ((current_ >= 0) && (static_cast<uint32_t>(current_) < queue_.size()))
+      {
+         PrintEntry(current_, output);
+      }
+   }
+   else if (name == "listallinfo")
+   {
+      std::string const directory = (count > 0) ? arguments[1] : "";
+      std::string       artist;
+      std::string       album;
+
+      SongsUnder(directory, start, end);
+
+      for (uint32_t i = start; i < end; ++i)
+      {
+         Song const & song = songs_[i];
+
+         if (song.artist != artist)
+         {
+            artist = song.artist;
+            output += "directory: " + artist + "\n";
+         }
+
+         if (song.album != album)
+         {
+            album = song.album;
+            output += "directory: " + artist + "/" + album + "\n";
+         }
+
+         PrintSong(i, output);
+
+         if ((output.size() >= SendSize) && (Send(connection->fd, output) == false))
+         {
+            break;
+         }
+      }
+   }
+   else if (name == "lsinfo")
+   {
+      std::string const directory = ((count > 0) && (arguments[1] != "/")) ? arguments[1] : "";
+      auto const        it        = directories_.find(directory);
+
+      if (it == directories_.end())
+      {
+         if (FindSong(directory, start) == false)
+         {
+            error = "No such directory";
+            return NoExist;
+         }
+
+         PrintSong(start, output);
+      }
+      else
+      {
+         for (auto const & path : it->second.directories)
+         {
+            output += "directory: " + path + "\n";
+         }
+
+         for (auto song : it->second.songs)
+         {
+            PrintSong(song, output);
+         }
+
+         if (directory == "")
+         {
+            for (auto const & playlist : playlists_)
+            {
+               output += "playlist: " + playlist.first + "\n";
+            }
+         }
+      }
+   }
+   else if ((name == "playlistinfo") || (name == "plchanges"))
+   {
+      uint32_t since = 0;
+
+      start = 0;
+      end   = queue_.size();
+
+      if ((name == "plchanges") && ((count < 1) || (Unsigned(arguments[1], since) == false)))
+      {
+         error = "Need a version";
+         return Argument;
+      }
+
+      if ((name == "playlistinfo") && (count > 0) && (Range(arguments[1], start, end) == false))
+      {
+         error = "Bad song index";
+         return Argument;
+      }
+
+      for (uint32_t i = start; i < end; ++i)
+      {
+         if (queue_[i].version > since)
+         {
+            PrintEntry(i, output);
+         }
+      }
+   }
+   else if ((name == "find") || (name == "search"))
+   {
+      if ((count == 0) || ((count % 2) != 0))
+      {
+         error = "Incorrect arguments";
+         return Argument;
+      }
+
+      for (uint32_t i = 0; i < songs_.size(); ++i)
+      {
+         if (Matches(songs_[i], arguments, (name == "find")) == true)
+         {
+            PrintSong(i, output);
+         }
+      }
+   }
+   else if ((name == "add") || (name == "addid"))
+   {
+      uint32_t position = queue_.size();
+
+      if (count < 1)
+      {
+         error = "Need a uri";
+         return Argument;
+      }
+
+      if ((name == "addid") && (count > 1) && (Position(arguments[2], position, true) == false))
+      {
+         error = "Bad song index";
+         return Argument;
+      }
+
+      if (FindSong(arguments[1], start) == true)
+      {
+         AddSong(start, position);
+
+         if (name == "addid")
+         {
+            output += "Id: " + std::to_string(queue_[position].id) + "\n";
+         }
+      }
+      else if ((name == "add") && ((arguments[1] == "") || (arguments[1] == "/") || (directories_.find(arguments[1]) != directories_.end())))
+      {
+         SongsUnder((arguments[1] == "/") ? "" : arguments[1], start, end);
+
+         for (uint32_t i = start; i < end; ++i)
+         {
+            AddSong(i, queue_.size());
+         }
+      }
+      else
+      {
+         error = "No such song";
+         return NoExist;
+      }
+
+      QueueChanged(position);
+   }
+   else if ((name == "delete") || (name == "deleteid"))
+   {
+      if (name == "deleteid")
+      {
+         uint32_t id = 0;
+         start = queue_.size();
+
+         if ((count > 0) && (Unsigned(arguments[1], id) == true))
+         {
+            for (start = 0; (start < queue_.size()) && (queue_[start].id != id); ++start) { }
+         }
+
+         end = start + 1;
+      }
+
+      if (((name == "delete") && ((count < 1) || (Range(arguments[1], start, end) == false))) || (end > queue_.size()))
+      {
+         error = "Bad song index";
+         return Argument;
+      }
+
+      queue_.erase(queue_.begin() + start, queue_.begin() + end);
+
+      if ((current_ >= static_cast<int32_t>(start)) && (current_ < static_cast<int32_t>(end)))
+      {
+         current_ = -1;
+         state_   = "stop";
+         Changed("player");
+      }
+      else if (current_ >= static_cast<int32_t>(end))
+      {
+         current_ -= (end - start);
+      }
+
+      QueueChanged(start);
+   }
+   else if (name == "clear")
+   {
+      queue_.clear();
+      current_ = -1;
+      state_   = "stop";
+      QueueChanged(0);
+      Changed("player");
+   }
+   else if ((name == "move") || (name == "swap") || (name == "shuffle"))
+   {
+      uint32_t const currentId = ((current_ >= 0) && (static_cast<uint32_t>(current_) < queue_.size())) ? queue_[current_].id : 0;
+      uint32_t       to        = 0;
+
+      if (name == "shuffle")
+      {
+         std::mt19937 random(version_);
+         std::shuffle(queue_.begin(), queue_.end(), random);
+         start = 0;
+      }
+      else if (name == "swap")
+      {
+         if ((count < 2) || (Position(arguments[1], start) == false) || (Position(arguments[2], to) == false))
+         {
+            error = "Bad song index";
+            return Argument;
+         }
+
+         std::swap(queue_[start], queue_[to]);
+      }
+      else
+      {
+         if ((count < 2) || (Range(arguments[1], start, end) == false) ||
+             (Unsigned(arguments[2], to) == false) || (to + (end - start) > queue_.size()))
+         {
+            error = "Bad song index";
+            return Argument;
+         }
+
+         std::vector<Entry> moved(queue_.begin() + start, queue_.begin() + end);
+         queue_.erase(queue_.begin() + start, queue_.begin() + end);
+         queue_.insert(queue_.begin() + to, moved.begin(), moved.end());
+      }
+
+      for (uint32_t i = 0; (currentId != 0) && (i < queue_.size()); ++i)
+      {
+         if (queue_[i].id == currentId)
+         {
+            current_ = i;
+         }
+      }
+
+      QueueChanged(std::min(start, to));
+   }
+   else if ((name == "play") || (name == "pause") || (name == "stop") || (name == "next") || (name == "previous"))
+   {
+      int32_t next = (current_ >= 0) ? current_ : 0;
+
+      if ((name == "play") && (count > 0))
+      {
+         next = atoi(arguments[1].c_str());
+      }
+      else if (name == "next")
+      {
+         next = current_ + 1;
+      }
+      else if (name == "previous")
+      {
+         next = current_ - 1;
+      }
+
+      if (name == "stop")
+      {
+         state_ = "stop";
+      }
+      else if (name == "pause")
+      {
+         bool const pause = (count > 0) ? (arguments[1] == "1") : (state_ == "play");
+         state_ = (pause == true) ? "pause" : ((state_ == "stop") ? "stop" : "play");
+      }
+      else if ((next < 0) || (static_cast<uint32_t>(next) >= queue_.size()))
+      {
+         state_   = "stop";
+         current_ = -1;
+      }
+      else
+      {
+         state_   = "play";
+         current_ = next;
+      }
+
+      Changed("player");
+   }
+   else if ((name == "setvol") || (name == "repeat") || (name == "random") ||
+            (name == "single") || (name == "consume") || (name == "crossfade"))
+   {
+      if (count < 1)
+      {
+         error = "Missing argument";
+         return Argument;
+      }
+
+      std::string const option = (name == "setvol") ? "volume" : ((name == "crossfade") ? "xfade" : name);
+      options_[option] = arguments[1];
+      Changed((name == "setvol") ? "mixer" : "options");
+   }
+   else if ((name == "update") || (name == "rescan"))
+   {
+      output += "updating_db: 1\n";
+      Changed("update");
+   }
+   else if (name == "listplaylists")
+   {
+      for (auto const & playlist : playlists_)
+      {
+         output += "playlist: " + playlist.first + "\nLast-Modified: 2016-01-01T00:00:00Z\n";
+      }
+   }
+   else if ((name == "listplaylist") || (name == "listplaylistinfo") || (name == "load") ||
+            (name == "rm") || (name == "playlistclear") || (name == "playlistadd") || (name == "save"))
+   {
+      auto const it = (count > 0) ? playlists_.find(arguments[1]) : playlists_.end();
+
+      if (count < 1)
+      {
+         error = "Need a playlist name";
+         return Argument;
+      }
+      else if (name == "save")
+      {
+         if (it != playlists_.end())
+         {
+            error = "Playlist already exists";
+            return Exist;
+         }
+
+         std::vector<uint32_t> & playlist = playlists_[arguments[1]];
+
+         for (auto const & entry : queue_)
+         {
+            playlist.push_back(entry.song);
+         }
+      }
+      else if (name == "playlistadd")
+      {
+         if ((count < 2) || (FindSong(arguments[2], start) == false))
+         {
+            error = "No such song";
+            return NoExist;
+         }
+
+         playlists_[arguments[1]].push_back(start);
+      }
+      else if (it == playlists_.end())
+      {
+         error = "No such playlist";
+         return NoExist;
+      }
+      else if (name == "rm")
+      {
+         playlists_.erase(it);
+      }
+      else if (name == "playlistclear")
+      {
+         it->second.clear();
+      }
+      else if (name == "load")
+      {
+         uint32_t const position = queue_.size();
+
+         for (auto song : it->second)
+         {
+            AddSong(song, queue_.size());
+         }
+
+         QueueChanged(position);
+      }
+      else
+      {
+         for (auto song : it->second)
+         {
+            if (name == "listplaylist")
+            {
+               output += "file: " + songs_[song].uri + "\n";
+            }
+            else
+            {
+               PrintSong(song, output);
+            }
+         }
+      }
+
+      if ((name != "load") && (name != "listplaylist") && (name != "listplaylistinfo"))
+      {
+         Changed("stored_playlist");
+      }
+   }
+   else if (name == "outputs")
+   {
+      output += std::string("outputid: 0\noutputname: Stand-in\noutputenabled: ") + ((outputEnabled_ == true) ? "1" : "0") + "\n";
+   }
+   else if ((name == "enableoutput") || (name == "disableoutput"))
+   {
+      outputEnabled_ = (name == "enableoutput");
+      Changed("output");
+   }
+   else
+   {
+      error = "unknown command \"" + name + "\"";
+      return Unknown;
+   }
+
+   return Ok;
+}
+
+
+void MpdStandIn::Changed(std::string const & subsystem)
+{
+   for (auto connection : connections_)
+   {
+      connection->changed.insert(subsystem);
+   }
+}
+
+void MpdStandIn::QueueChanged(uint32_t from)
+{
+   ++version_;
+
+   for (uint32_t i = from; i < queue_.size(); ++i)
+   {
+      queue_[i].version = version_;
+   }
+
+   Changed("playlist");
+}
+
+void MpdStandIn::AddSong(uint32_t song, uint32_t position)
+{
+   Entry entry = { song, nextId_++, 0 };
+   queue_.insert(queue_.begin() + position, entry);
+
+   if ((current_ >= 0) && (static_cast<uint32_t>(current_) >= position))
+   {
+      ++current_;
+   }
+}
+
+bool MpdStandIn::FindSong(std::string const & uri, uint32_t & song) const
+{
+   auto const it = std::lower_bound(songs_.begin(), songs_.end(), uri,
+                                    [] (Song const & a, std::string const & b) { return (a.uri < b); });
+
+   song = static_cast<uint32_t>(it - songs_.begin());
+   return ((it != songs_.end()) && (it->uri == uri));
+}
+
+void MpdStandIn::SongsUnder(std::string const & directory, uint32_t & first, uint32_t & last) const
+{
+   if (directory == "")
+   {
+      first = 0;
+      last  = songs_.size();
+      return;
+   }
+
+   // The songs are sorted by uri so those in a directory are next to each other
+   std::string const prefix = directory + "/";
+
+   FindSong(prefix, first);
+   FindSong(directory + static_cast<char>('/' + 1), last);
+}
+
+bool MpdStandIn::Position(std::string const & value, uint32_t & position, bool allowEnd) const
+{
+   return ((Unsigned(value, position) == true) &&
+           ((position < queue_.size()) || ((allowEnd == true) && (position == queue_.size()))));
+}
+
+bool MpdStandIn::Range(std::string const & value, uint32_t & start, uint32_t & end) const
+{
+   size_t const colon = value.find(':');
+
+   if (colon == std::string::npos)
+   {
+      bool const valid = Position(value, start);
+      end = start + 1;
+      return valid;
+   }
+
+   std::string const last = value.substr(colon + 1);
+
+   end = queue_.size();
+
+   return ((Unsigned(value.substr(0, colon), start) == true) &&
+           ((last.empty() == true) || (Unsigned(last, end) == true)) &&
+           (start <= end) && (end <= queue_.size()));
+}
+
+
+void MpdStandIn::PrintSong(uint32_t song, std::string & output) const
+{
+   Song const & entry = songs_[song];
+
+   output += "file: " + entry.uri + "\n" +
+             "Last-Modified: 2016-01-01T00:00:00Z\n" +
+             "Artist: " + entry.artist + "\n" +
+             "Album: " + entry.album + "\n" +
+             "Title: " + entry.title + "\n" +
+             "Track: " + std::to_string(entry.track) + "\n" +
+             "Time: " + std::to_string(entry.duration) + "\n" +
+             "duration: " + std::to_string(entry.duration) + ".000\n";
+}
+
+void MpdStandIn::PrintEntry(uint32_t position, std::string & output) const
+{
+   PrintSong(queue_[position].song, output);
+
+   output += "Pos: " + std::to_string(position) + "\n" +
+             "Id: " + std::to_string(queue_[position].id) + "\n";
+}
+
+bool MpdStandIn::Matches(Song const & song, Arguments const & arguments, bool exact) const
+{
+   for (uint32_t i = 1; (i + 1 < arguments.size()); i += 2)
+   {
+      std::string const tag   = Lower(arguments[i]);
+      std::string const value = (exact == true) ? arguments[i + 1] : Lower(arguments[i + 1]);
+
+      std::vector<std::string const *> fields;
+
+      if ((tag == "artist") || (tag == "albumartist") || (tag == "any")) { fields.push_back(&song.artist); }
+      if ((tag == "album") || (tag == "any"))                          { fields.push_back(&song.album); }
+      if ((tag == "title") || (tag == "any"))                          { fields.push_back(&song.title); }
+      if ((tag == "file") || (tag == "filename") || (tag == "any"))    { fields.push_back(&song.uri); }
+
+      bool found = false;
+
+      for (auto field : fields)
+      {
+         found = found || ((exact == true) ? (*field == value) : (Lower(*field).find(value) != std::string::npos));
+      }
+
+      if (found == false)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+/* static */ MpdStandIn::Arguments MpdStandIn::Split(std::string const & line)
+{
+   Arguments arguments;
+
+   for (size_t i = 0; (i < line.size()); )
+   {
+      if (line[i] == ' ')
+      {
+         ++i;
+         continue;
+      }
+
+      std::string argument;
+
+      if (line[i] == '"')
+      {
+         for (++i; (i < line.size()) && (line[i] != '"'); ++i)
+         {
+            if ((line[i] == '\\') && (i + 1 < line.size()))
+            {
+               ++i;
+            }
+
+            argument += line[i];
+         }
+
+         ++i;
+      }
+      else
+      {
+         for (; (i < line.size()) && (line[i] != ' '); ++i)
+         {
+            argument += line[i];
+         }
+      }
+
+      arguments.push_back(argument);
+   }
+
+   return arguments;
+}
+
+/* vim: set sw=3 ts=3: */
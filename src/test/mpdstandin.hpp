@@ -0,0 +1,139 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   mpdstandin.hpp - answers the mpd protocol from an in memory library
+   */
+
+#ifndef __MAIN__MPDSTANDIN
+#define __MAIN__MPDSTANDIN
+
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "compiler.hpp"
+
+namespace Main
+{
+   //! Listens on a local port and speaks enough of the mpd protocol for vimpc,
+   //! the library is made up of artist/album/track directories so that it can
+   //! be made as large as needed without any music on disk
+   class MpdStandIn
+   {
+      public:
+         MpdStandIn(uint32_t songs);
+         ~MpdStandIn();
+
+      private:
+         MpdStandIn(MpdStandIn const &);
+         MpdStandIn & operator=(MpdStandIn const &);
+
+      public:
+         bool Start();
+         void Stop();
+
+         uint16_t Port() const { return port_; }
+
+      private:
+         struct Song
+         {
+            std::string uri;
+            std::string artist;
+            std::string album;
+            std::string title;
+            uint32_t    track;
+            uint32_t    duration;
+         };
+
+         struct Entry
+         {
+            uint32_t song;
+            uint32_t id;
+            uint32_t version;
+         };
+
+         //! The directories and songs directly inside a directory
+         struct Listing
+         {
+            std::vector<std::string> directories;
+            std::vector<uint32_t>    songs;
+         };
+
+         struct Connection
+         {
+            int                   fd;
+            Thread *              thread;
+            std::set<std::string> changed;
+         };
+
+         typedef std::vector<std::string> Arguments;
+
+      private:
+         void Generate(uint32_t songs);
+
+         void Accept();
+         void Serve(Connection * connection);
+         bool Idle(Connection * connection, std::string & input, std::string & output);
+         bool Send(int fd, std::string & output);
+
+         //! Appends the response to the output, returns false once an ACK has been written
+         bool Execute(Connection * connection, std::string const & line, uint32_t index, std::string & output);
+
+         //! Returns the ack error number, or zero if the command succeeded
+         int Command(Connection * connection, Arguments const & arguments, std::string & output, std::string & error);
+
+         void Changed(std::string const & subsystem);
+         void QueueChanged(uint32_t from);
+
+         void AddSong(uint32_t song, uint32_t position);
+         bool FindSong(std::string const & uri, uint32_t & song) const;
+         void SongsUnder(std::string const & directory, uint32_t & first, uint32_t & last) const;
+         bool Position(std::string const & value, uint32_t & position, bool allowEnd = false) const;
+         bool Range(std::string const & value, uint32_t & start, uint32_t & end) const;
+
+         void PrintSong(uint32_t song, std::string & output) const;
+         void PrintEntry(uint32_t position, std::string & output) const;
+         bool Matches(Song const & song, Arguments const & arguments, bool exact) const;
+
+         static Arguments Split(std::string const & line);
+
+      private:
+         int                                listen_;
+         uint16_t                           port_;
+         Atomic(bool)                       running_;
+         Thread *                           acceptor_;
+         std::vector<Connection *>          connections_;
+
+         // Everything below is only used with the mutex held
+         Mutex                              mutex_;
+         std::vector<Song>                  songs_;
+         std::map<std::string, Listing>     directories_;
+         std::vector<Entry>                 queue_;
+         uint32_t                           version_;
+         uint32_t                           nextId_;
+         int32_t                            current_;
+         std::string                        state_;
+         std::map<std::string, std::string> options_;
+         std::map<std::string, std::vector<uint32_t> > playlists_;
+         bool                               outputEnabled_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
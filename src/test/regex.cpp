@@ -20,13 +20,21 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+#include "buffers.hpp"
 #include "regex.hpp"
+#include "window/console.hpp"
 
 class RegexTester : public CppUnit::TestFixture
 {
    CPPUNIT_TEST_SUITE(RegexTester);
    CPPUNIT_TEST(trim);
    CPPUNIT_TEST(replaceAll);
+   CPPUNIT_TEST(matches);
+   CPPUNIT_TEST(searchLatency);
    CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -39,6 +47,8 @@ public:
 protected:
    void trim();
    void replaceAll();
+   void matches();
+   void searchLatency();
 
 private:
 };
@@ -76,5 +86,99 @@ void RegexTester::replaceAll()
    CPPUNIT_ASSERT((data == "jbjbj"));
 }
 
+void RegexTester::matches()
+{
+   Regex::RE const regex("b.?d");
+
+   CPPUNIT_ASSERT(regex.Matches("abcde") == true);
+   CPPUNIT_ASSERT(regex.Matches("abxxd") == false);
+   CPPUNIT_ASSERT(regex.CompleteMatch("abcde") == false);
+   CPPUNIT_ASSERT(regex.CompleteMatch("bcd") == true);
+
+   // Separate instances of the same pattern share a compiled expression
+   Regex::RE const again("b.?d");
+   CPPUNIT_ASSERT(again.Matches("abcde") == true);
+
+   Regex::RE const copy(regex);
+   CPPUNIT_ASSERT(copy.CompleteMatch("bcd") == true);
+
+   // Enough other patterns to push this one out of the cache and back
+   for (uint32_t i = 0; i < 256; ++i)
+   {
+      std::stringstream pattern;
+      pattern << "x" << i << "y";
+      Regex::RE const other(pattern.str());
+      CPPUNIT_ASSERT(other.Matches(pattern.str()) == true);
+   }
+
+   CPPUNIT_ASSERT(Regex::RE("b.?d").CompleteMatch("bxd") == true);
+
+   Regex::RE const caseless("ABC", Regex::CaseInsensitive);
+   CPPUNIT_ASSERT(caseless.Matches("xabcx") == true);
+
+   Regex::RE const invalid("(unclosed");
+   CPPUNIT_ASSERT(invalid.Matches("(unclosed") == false);
+}
+
+void RegexTester::searchLatency()
+{
+   uint32_t const lines = 200000;
+   std::string const search("Artist 1999.*Title");
+
+   std::vector<std::string> data;
+   data.reserve(lines);
+
+   for (uint32_t i = 0; i < lines; ++i)
+   {
+      std::stringstream line;
+      line << "Artist " << i << " - Album " << (i / 12) << " - Title " << i;
+      data.push_back(line.str());
+   }
+
+   // What a search used to do, compile the wrapped expression for every line
+   auto start = std::chrono::steady_clock::now();
+   uint32_t before = 0;
+
+   for (auto const & line : data)
+   {
+      char const * error;
+      int erroffset;
+      int ovector[12];
+
+      pcre * re = pcre_compile(("(?:.*" + search + ".*)\\z").c_str(), Regex::UTF8, &error, &erroffset, NULL);
+
+      if (pcre_exec(re, NULL, line.c_str(), line.length(), 0, 0, ovector, 12) >= 0)
+      {
+         ++before;
+      }
+
+      pcre_free(re);
+   }
+
+   auto const beforeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+   start = std::chrono::steady_clock::now();
+   uint32_t after = 0;
+
+   Regex::RE const expression(search, Regex::UTF8);
+
+   for (auto const & line : data)
+   {
+      if (expression.Matches(line) == true)
+      {
+         ++after;
+      }
+   }
+
+   auto const afterMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+   std::stringstream result;
+   result << "Search " << lines << " lines: " << beforeMs << "ms compiled per line, " << afterMs << "ms cached";
+   Main::TestConsole().Add(result.str());
+
+   CPPUNIT_ASSERT(before == after);
+   CPPUNIT_ASSERT(after == 111);
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(RegexTester);
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(RegexTester, "regex");
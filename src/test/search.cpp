@@ -0,0 +1,144 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   search.cpp - tests for search mode
+   */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <vector>
+
+#include "screen.hpp"
+#include "settings.hpp"
+#include "song.hpp"
+#include "test.hpp"
+
+#include "mode/search.hpp"
+#include "window/songwindow.hpp"
+
+class SearchTester : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(SearchTester);
+   CPPUNIT_TEST(countAcrossWrap);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+   SearchTester() :
+      settings_(Main::Settings::Instance()),
+      screen_(*Main::Tester::Instance().Screen),
+      search_(*Main::Tester::Instance().Search) { }
+
+public:
+   void setUp();
+   void tearDown();
+
+protected:
+   void countAcrossWrap();
+
+private:
+   int32_t Find(Ui::SongWindow * window, uint32_t lines, uint32_t count);
+
+private:
+   Main::Settings &         settings_;
+   Ui::Screen &             screen_;
+   Ui::Search &             search_;
+   int32_t                  window_;
+   bool                     wrap_;
+   std::vector<Mpc::Song *> songs_;
+};
+
+void SearchTester::setUp()
+{
+   window_ = screen_.GetActiveWindow();
+   wrap_   = settings_.Get(Setting::SearchWrap);
+   settings_.Set(Setting::SearchWrap, true);
+
+   Mpc::Song * const hay    = new Mpc::Song();
+   Mpc::Song * const needle = new Mpc::Song();
+
+   hay->SetTitle("hay");
+   needle->SetTitle("needle");
+
+   songs_.push_back(hay);
+   songs_.push_back(needle);
+}
+
+void SearchTester::tearDown()
+{
+   screen_.SetActiveAndVisible(window_);
+   settings_.Set(Setting::SearchWrap, wrap_);
+
+   for (auto song : songs_)
+   {
+      delete song;
+   }
+
+   songs_.clear();
+}
+
+int32_t SearchTester::Find(Ui::SongWindow * window, uint32_t lines, uint32_t count)
+{
+   // Needles at the same fractions of the window whatever its size,
+   // the search starts between the second and third of them
+   uint32_t const needles[] = { lines / 100, lines / 4, (3 * lines) / 4 };
+
+   for (uint32_t line = 0, next = 0; line < lines; ++line)
+   {
+      bool const needle = (next < 3) && (needles[next] == line);
+      window->Add(songs_[(needle == true) ? 1 : 0]);
+      next += (needle == true) ? 1 : 0;
+   }
+
+   int32_t const id = screen_.GetWindowFromName(window->Name());
+   screen_.SetActiveAndVisible(id);
+
+   search_.SearchWindow(Ui::Search::Forwards, "needle", lines / 2, count);
+
+   int32_t const Result = screen_.ActiveWindow().CurrentLine();
+
+   window->Clear();
+   screen_.SetVisible(id, false);
+
+   for (int32_t i = 0; i < 3; ++i)
+   {
+      if (Result == static_cast<int32_t>(needles[i]))
+      {
+         return i;
+      }
+   }
+
+   return -1;
+}
+
+void SearchTester::countAcrossWrap()
+{
+   Ui::SongWindow * const small = screen_.CreateSongWindow("searchsmall");
+   Ui::SongWindow * const large = screen_.CreateSongWindow("searchlarge");
+
+   // Large windows are searched in chunks, small ones line by line,
+   // they must land on the same needle for a count that wraps
+   for (uint32_t count = 1; count <= 4; ++count)
+   {
+      int32_t const linear  = Find(small, 200, count);
+      int32_t const chunked = Find(large, 40000, count);
+
+      CPPUNIT_ASSERT((linear != -1) && (linear == chunked));
+   }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SearchTester);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(SearchTester, "search");
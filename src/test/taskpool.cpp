@@ -0,0 +1,202 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   taskpool.cpp - tests for the shared worker threads
+   */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <vector>
+
+#include "compiler.hpp"
+#include "taskpool.hpp"
+
+class TaskPoolTester : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(TaskPoolTester);
+   CPPUNIT_TEST(runsAll);
+   CPPUNIT_TEST(cancel);
+   CPPUNIT_TEST(stealsInteractive);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+   TaskPoolTester() : pool_(Main::TaskPool::Instance()) { }
+
+public:
+   void setUp();
+   void tearDown();
+
+protected:
+   void runsAll();
+   void cancel();
+   void stealsInteractive();
+
+private:
+   Main::TaskPool & pool_;
+};
+
+void TaskPoolTester::setUp()
+{
+}
+
+void TaskPoolTester::tearDown()
+{
+}
+
+void TaskPoolTester::runsAll()
+{
+   Atomic(uint32_t) count(0);
+   std::vector<Main::TaskPool::TaskPtr> tasks;
+
+   for (uint32_t i = 0; i < 1000; ++i)
+   {
+      Main::TaskPool::Lane const lane = static_cast<Main::TaskPool::Lane>(i % Main::TaskPool::Lanes);
+      tasks.push_back(pool_.Submit(lane, [&count] (Main::TaskPool::Task const &) { ++count; }));
+   }
+
+   for (auto const & task : tasks)
+   {
+      while (task->Wait(1000) == false) { }
+   }
+
+   CPPUNIT_ASSERT(count == 1000);
+}
+
+void TaskPoolTester::cancel()
+{
+   Mutex             BlockMutex;
+   ConditionVariable Condition;
+   bool              Blocked = true;
+
+   std::vector<Main::TaskPool::TaskPtr> blockers;
+
+   // Keep every worker busy so that the next task cannot start
+   for (uint32_t i = 0; i < pool_.Workers(); ++i)
+   {
+      blockers.push_back(pool_.Submit(Main::TaskPool::Interactive, [&] (Main::TaskPool::Task const &)
+      {
+         UniqueLock<Mutex> Lock(BlockMutex);
+
+         while (Blocked == true)
+         {
+            Condition.wait(Lock);
+         }
+      }));
+   }
+
+   bool ran = false;
+   Main::TaskPool::TaskPtr const task = pool_.Submit(Main::TaskPool::Background, [&ran] (Main::TaskPool::Task const &) { ran = true; });
+
+   task->Cancel();
+   CPPUNIT_ASSERT(task->Finished() == false);
+
+   {
+      UniqueLock<Mutex> Lock(BlockMutex);
+      Blocked = false;
+      Condition.notify_all();
+   }
+
+   CPPUNIT_ASSERT(task->Wait(5000) == true);
+   CPPUNIT_ASSERT(task->Cancelled() == true);
+   CPPUNIT_ASSERT(ran == false);
+
+   for (auto const & blocker : blockers)
+   {
+      while (blocker->Wait(1000) == false) { }
+   }
+}
+
+void TaskPoolTester::stealsInteractive()
+{
+   Mutex             BlockMutex;
+   ConditionVariable Condition;
+   uint32_t          started  = 0;
+   uint32_t          released = 0;
+
+   std::vector<Main::TaskPool::TaskPtr> blockers;
+
+   // Every worker is kept busy, the blockers are released one at a time
+   for (uint32_t i = 0; i < pool_.Workers(); ++i)
+   {
+      blockers.push_back(pool_.Submit(Main::TaskPool::Interactive, [&, i] (Main::TaskPool::Task const &)
+      {
+         UniqueLock<Mutex> Lock(BlockMutex);
+         ++started;
+         Condition.notify_all();
+
+         while (released <= i)
+         {
+            Condition.wait(Lock);
+         }
+      }));
+   }
+
+   {
+      UniqueLock<Mutex> Lock(BlockMutex);
+
+      while (started < pool_.Workers())
+      {
+         Condition.wait(Lock);
+      }
+   }
+
+   // One submit per worker, so one queue has the interactive
+   // task and every other queue has a bulk task
+   std::vector<Main::TaskPool::Lane>    order;
+   std::vector<Main::TaskPool::TaskPtr> tasks;
+
+   for (uint32_t i = 0; i < pool_.Workers(); ++i)
+   {
+      Main::TaskPool::Lane const lane = (i == 0) ? Main::TaskPool::Interactive : Main::TaskPool::Bulk;
+
+      tasks.push_back(pool_.Submit(lane, [&, lane] (Main::TaskPool::Task const &)
+      {
+         UniqueLock<Mutex> Lock(BlockMutex);
+         order.push_back(lane);
+      }));
+   }
+
+   {
+      UniqueLock<Mutex> Lock(BlockMutex);
+      released = 1;
+      Condition.notify_all();
+   }
+
+   // Whichever worker was freed runs the interactive task first
+   CPPUNIT_ASSERT(tasks[0]->Wait(5000) == true);
+
+   {
+      UniqueLock<Mutex> Lock(BlockMutex);
+      CPPUNIT_ASSERT((order.empty() == false) && (order.front() == Main::TaskPool::Interactive));
+
+      released = pool_.Workers();
+      Condition.notify_all();
+   }
+
+   for (auto const & task : tasks)
+   {
+      while (task->Wait(1000) == false) { }
+   }
+
+   for (auto const & blocker : blockers)
+   {
+      while (blocker->Wait(1000) == false) { }
+   }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TaskPoolTester);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(TaskPoolTester, "taskpool");
@@ -0,0 +1,208 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   trace.cpp - spans of work on each thread, written out as a chrome trace
+   */
+
+#include "trace.hpp"
+
+#include <fstream>
+#include <string.h>
+
+#include "stats.hpp"
+
+using namespace Main;
+
+bool                                Trace::enabled_ = false;
+uint64_t                            Trace::started_ = 0;
+Mutex                               Trace::mutex_;
+std::list<Trace::ThreadBuffer *>    Trace::buffers_;
+thread_local Trace::ThreadBuffer *  Trace::local_ = NULL;
+
+namespace
+{
+   // Enough for a few seconds of heavy use on each thread
+   uint32_t const BufferSize = 16384;
+
+   void Escape(std::ostream & stream, char const * string)
+   {
+      for (; *string != '\0'; ++string)
+      {
+         if ((*string == '"') || (*string == '\\'))
+         {
+            stream << '\\' << *string;
+         }
+         else if (static_cast<unsigned char>(*string) >= 0x20)
+         {
+            stream << *string;
+         }
+      }
+   }
+}
+
+
+void Trace::Span::Begin(char const * category, char const * name)
+{
+   category_ = category;
+   strncpy(name_, name, NameLength - 1);
+   name_[NameLength - 1] = '\0';
+   start_ = Stats::Now();
+}
+
+void Trace::Span::End()
+{
+   uint64_t const end = Stats::Now();
+
+   // Spans that were still open when the trace was stopped are dropped
+   if (Trace::Enabled() == true)
+   {
+      ThreadBuffer & buffer = Trace::Buffer();
+
+      // Once tracing is turned off Stop waits for a record still being written
+      __atomic_store_n(&buffer.writing, true, __ATOMIC_SEQ_CST);
+
+      if (__atomic_load_n(&enabled_, __ATOMIC_SEQ_CST) == true)
+      {
+         if (buffer.records.empty() == true)
+         {
+            buffer.records.resize(BufferSize);
+         }
+
+         uint64_t const head   = __atomic_load_n(&buffer.head, __ATOMIC_RELAXED);
+         Record &       record = buffer.records[head % BufferSize];
+
+         record.category = category_;
+         record.start    = start_;
+         record.duration = end - start_;
+         memcpy(record.name, name_, NameLength);
+
+         __atomic_store_n(&buffer.head, head + 1, __ATOMIC_RELEASE);
+      }
+
+      __atomic_store_n(&buffer.writing, false, __ATOMIC_RELEASE);
+   }
+}
+
+
+void Trace::NameThread(char const * name)
+{
+   ThreadBuffer & buffer = Buffer();
+
+   UniqueLock<Mutex> Lock(mutex_);
+   buffer.name = name;
+}
+
+void Trace::Start()
+{
+   UniqueLock<Mutex> Lock(mutex_);
+   Disable();
+
+   for (auto buffer : buffers_)
+   {
+      __atomic_store_n(&buffer->head, 0, __ATOMIC_RELAXED);
+   }
+
+   started_ = Stats::Now();
+   __atomic_store_n(&enabled_, true, __ATOMIC_SEQ_CST);
+}
+
+bool Trace::Stop(std::string const & file)
+{
+   UniqueLock<Mutex> Lock(mutex_);
+   Disable();
+
+   std::ofstream stream(file.c_str());
+
+   if (stream.is_open() == false)
+   {
+      return false;
+   }
+
+   stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+   bool first = true;
+
+   for (auto buffer : buffers_)
+   {
+      stream << (first ? "" : ",") << "\n{\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+             << ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+      Escape(stream, buffer->name.c_str());
+      stream << "\"}}";
+      first = false;
+
+      uint64_t const head  = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+      uint64_t const begin = (head > BufferSize) ? (head - BufferSize) : 0;
+
+      for (uint64_t i = begin; i < head; ++i)
+      {
+         Record const & record = buffer->records[i % BufferSize];
+
+         // Spans that began before the trace was started
+         if (record.start < started_)
+         {
+            continue;
+         }
+
+         stream << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                << ",\"ts\":" << (record.start - started_) << ",\"dur\":" << record.duration
+                << ",\"cat\":\"" << record.category << "\",\"name\":\"";
+         Escape(stream, record.name);
+         stream << "\"}";
+      }
+   }
+
+   stream << "\n]}\n";
+   stream.close();
+
+   return (stream.fail() == false);
+}
+
+
+void Trace::Disable()
+{
+   __atomic_store_n(&enabled_, false, __ATOMIC_SEQ_CST);
+
+   // A span that saw tracing still on may be part way through its record
+   for (auto buffer : buffers_)
+   {
+      while (__atomic_load_n(&buffer->writing, __ATOMIC_SEQ_CST) == true)
+      {
+         ThisThread::yield();
+      }
+   }
+}
+
+Trace::ThreadBuffer & Trace::Buffer()
+{
+   // Buffers are kept after their thread exits so that its spans are still written
+   if (local_ == NULL)
+   {
+      ThreadBuffer * buffer = new ThreadBuffer();
+      buffer->head    = 0;
+      buffer->writing = false;
+
+      UniqueLock<Mutex> Lock(mutex_);
+      buffer->id   = static_cast<uint32_t>(buffers_.size()) + 1;
+      buffer->name = "thread " + std::to_string(buffer->id);
+      buffers_.push_back(buffer);
+      local_       = buffer;
+   }
+
+   return *local_;
+}
+
+/* vim: set sw=3 ts=3: */
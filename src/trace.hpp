@@ -0,0 +1,132 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   trace.hpp - spans of work on each thread, written out as a chrome trace
+   */
+
+#ifndef __MAIN__TRACE
+#define __MAIN__TRACE
+
+#include <list>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "compiler.hpp"
+
+namespace Main
+{
+   //! Each thread records into its own ring buffer without taking a lock,
+   //! the buffers are only collected when the trace is stopped. The file
+   //! can be loaded in chrome://tracing or ui.perfetto.dev
+   //!
+   //! When tracing is off a span is a single load and compare
+   class Trace
+   {
+      public:
+         static uint32_t const NameLength = 48;
+
+         class Span
+         {
+            public:
+               //! The category must be a string literal
+               Span(char const * category, char const * name) :
+                  active_(Trace::Enabled())
+               {
+                  if (active_ == true)
+                  {
+                     Begin(category, name);
+                  }
+               }
+
+               Span(char const * category, std::string const & name) :
+                  active_(Trace::Enabled())
+               {
+                  if (active_ == true)
+                  {
+                     Begin(category, name.c_str());
+                  }
+               }
+
+               ~Span()
+               {
+                  if (active_ == true)
+                  {
+                     End();
+                  }
+               }
+
+            private:
+               Span(Span const &);
+               Span & operator=(Span const &);
+
+               void Begin(char const * category, char const * name);
+               void End();
+
+            private:
+               bool const   active_;
+               char const * category_;
+               uint64_t     start_;
+               char         name_[NameLength];
+         };
+
+      public:
+         static bool Enabled() { return (__atomic_load_n(&enabled_, __ATOMIC_RELAXED) == true); }
+
+         //! Names the calling thread in the trace
+         static void NameThread(char const * name);
+
+         //! Discards anything already recorded
+         static void Start();
+
+         //! Returns false if the file could not be written
+         static bool Stop(std::string const & file);
+
+      private:
+         struct Record
+         {
+            char const * category;
+            uint64_t     start;
+            uint64_t     duration;
+            char         name[NameLength];
+         };
+
+         struct ThreadBuffer
+         {
+            uint32_t            id;
+            std::string         name;
+            std::vector<Record> records;
+            uint64_t            head;
+            bool                writing;
+         };
+
+         //! Turns tracing off once no thread is part way through a record,
+         //! the caller must hold the mutex
+         static void Disable();
+         static ThreadBuffer & Buffer();
+
+      private:
+         static bool                        enabled_;
+         static uint64_t                    started_;
+         static Mutex                       mutex_;
+         static std::list<ThreadBuffer *>   buffers_;
+         static thread_local ThreadBuffer * local_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
@@ -30,10 +30,14 @@
 #include "assert.hpp"
 #include "buffers.hpp"
 #include "config.hpp"
+#include "eventqueue.hpp"
 #include "events.hpp"
+#include "log.hpp"
 #include "settings.hpp"
 #include "song.hpp"
+#include "stats.hpp"
 #include "test.hpp"
+#include "trace.hpp"
 
 #include "buffer/directory.hpp"
 #include "buffer/outputs.hpp"
@@ -41,6 +45,11 @@
 #include "window/error.hpp"
 #include "window/songwindow.hpp"
 
+#ifdef LYRICS_SUPPORT
+#include "lyricsloader.hpp"
+#endif
+
+#include <deque>
 #include <list>
 #include <unistd.h>
 
@@ -48,14 +57,19 @@ using namespace Main;
 
 typedef std::pair<int32_t, EventData>  EventPair;
 
-static std::list<EventPair>            Queue;
-static std::map<int, std::vector<FUNCTION<void(EventData const &)> > > Handler;
+static uint32_t const                  QueueSize = 4096;
+
+static EventQueue<EventPair>           Queue(QueueSize);
+static std::deque<EventPair>           Overflow;
+static uint32_t                        OverflowBehind = 0;
+static Thread::id const                MainThread = ThisThread::get_id();
+static uint32_t                        PendingInput = 0;
+static std::vector<FUNCTION<void(EventData const &)> > Handler[Event::EventCount];
 
 static Mutex               EventMutex;
-static Mutex               QueueMutex;
-static ConditionVariable   Condition;
+static uint32_t            Waiting = 0;
 
-static std::map<int, std::list<ConditionVariable *> > WaitConditions;
+static std::list<ConditionVariable *> WaitConditions[Event::EventCount];
 
 bool Vimpc::Running = true;
 
@@ -99,10 +113,30 @@ Vimpc::Vimpc() :
       Mpc::Song::RepopulateSongFunctions();
    });
 
+   settings_.RegisterCallback(Setting::LoggingLevel, [] (std::string Value)
+   {
+      Main::Log::Instance().SetLevel(Value);
+   });
+
+   settings_.RegisterCallback(Setting::LogFile, [this] (std::string Value)
+   {
+      Main::Log::Instance().SetFile(Value, static_cast<uint64_t>(atoi(settings_.Get(Setting::LogFileSize).c_str())) * 1024 * 1024);
+   });
+
+   settings_.RegisterCallback(Setting::LogFileSize, [this] (std::string Value)
+   {
+      Main::Log::Instance().SetFile(settings_.Get(Setting::LogFile), static_cast<uint64_t>(atoi(Value.c_str())) * 1024 * 1024);
+   });
+
+#ifdef LYRICS_SUPPORT
+   Main::LyricsLoader::Instance().SetClientState(&clientState_);
+#endif
+
 #ifdef TEST_ENABLED
    Main::Tester::Instance().Vimpc   = this;
    Main::Tester::Instance().Screen  = &screen_;
    Main::Tester::Instance().Command = &commandMode_;
+   Main::Tester::Instance().Search  = &search_;
    Main::Tester::Instance().Client  = &client_;
    Main::Tester::Instance().ClientState = &clientState_;
 #endif
@@ -110,6 +144,9 @@ Vimpc::Vimpc() :
 
 Vimpc::~Vimpc()
 {
+   // The log thread sends its messages through the event queue
+   Main::Log::Instance().Stop();
+
    for (auto mode : modeTable_)
    {
       delete (mode.second);
@@ -119,6 +156,8 @@ Vimpc::~Vimpc()
 
 void Vimpc::Run(std::string hostname, uint16_t port)
 {
+   Trace::NameThread("main");
+
    int input = ERR;
 
    // Keyboard input event handler
@@ -169,42 +208,52 @@ void Vimpc::Run(std::string hostname, uint16_t port)
       {
          screen_.UpdateErrorDisplay();
 
-         {
-            UniqueLock<Mutex> Lock(QueueMutex);
+         EventPair Event;
+         bool      Received = PopEvent(Event);
 
-            if ((Queue.empty() == false) ||
-               (ConditionWait(Condition, Lock, 100) != false))
-            {
-               if (Queue.empty() == false)
-               {
-                  EventPair const Event = Queue.front();
-                  Queue.pop_front();
-                  Lock.unlock();
+         if (Received == false)
+         {
+            Queue.Wait(100);
+            Received = PopEvent(Event);
+         }
 
-                  if ((userEvents_ == false) &&
-                     (Event.second.user == true))
-                  {
-                     Debug("Discarding user event");
-                     continue;
-                  }
+         if (Received == true)
+         {
+            Stats & stats = Stats::Instance();
+            stats.QueueDepth(Queue.Size() + Overflow.size());
+            stats.EventWait(Event.first).Add(Stats::Now() - Event.second.time);
 
-                  for (auto func : Handler[Event.first])
-                  {
-                     func(Event.second);
-                  }
+            if ((userEvents_ == false) &&
+               (Event.second.user == true))
+            {
+               Debug("Discarding user event");
+               continue;
+            }
 
-                  EventMutex.lock();
+            {
+               Stats::Timer Timer(stats.EventHandle(Event.first));
+               Trace::Span  Span("event", EventStrings::Default[Event.first]);
 
-                  for (auto cond : WaitConditions[Event.first])
-                  {
-                     cond->notify_all();
-                  }
+               for (auto const & func : Handler[Event.first])
+               {
+                  func(Event.second);
+               }
+            }
 
-                  EventMutex.unlock();
+            // Only the tests wait for events, so avoid the lock otherwise
+            if (__atomic_load_n(&Waiting, __ATOMIC_ACQUIRE) != 0)
+            {
+               EventMutex.lock();
 
-                  Debug("Event triggered: " + EventStrings::Default[Event.first]);
+               for (auto cond : WaitConditions[Event.first])
+               {
+                  cond->notify_all();
                }
+
+               EventMutex.unlock();
             }
+
+            Debug("Event triggered: %s", EventStrings::Default[Event.first]);
          }
 
          if (input != ERR)
@@ -234,17 +283,10 @@ void Vimpc::Run(std::string hostname, uint16_t port)
 
          bool const Resize = screen_.Resize();
 
-         QueueMutex.lock();
-
          if (((input != ERR) || (Resize == true)) || (requireRepaint_ == true))
          {
-            QueueMutex.unlock();
             Repaint();
          }
-         else
-         {
-            QueueMutex.unlock();
-         }
 
          input = ERR;
       }
@@ -262,6 +304,9 @@ void Vimpc::Repaint()
 
    if (Running)
    {
+      Stats::Timer Timer(Stats::Instance().Repaint());
+      Trace::Span  Span("screen", "Repaint");
+
       screen_.Update();
       clientState_.DisplaySongInformation();
 
@@ -352,15 +397,85 @@ void Vimpc::HandleUserEvents(bool Enabled)
    Running = isRunning;
 }
 
-/* static */ void Vimpc::CreateEvent(int Event, EventData const & Data)
+/* static */ void Vimpc::CreateEvent(int Event)
+{
+   CreateEvent(Event, EventData());
+}
+
+/* static */ void Vimpc::CreateEvent(int Event, EventData && Data)
+{
+   REQUIRE((Event >= 0) && (Event < Event::EventCount));
+
+   EventPair Pair(Event, std::move(Data));
+   Pair.second.time = Stats::Now();
+
+   if (Event == Event::Input)
+   {
+      __atomic_add_fetch(&PendingInput, 1, __ATOMIC_RELAXED);
+   }
+
+   if (ThisThread::get_id() == MainThread)
+   {
+      // The main loop cannot wait for itself to make room, so once it has
+      // overflowed its events stay in order behind the earlier ones
+      if ((Overflow.empty() == false) || (Queue.TryPush(std::move(Pair)) == false))
+      {
+         if (Overflow.empty() == true)
+         {
+            // Only the events already in the queue may be handled before these
+            OverflowBehind = Queue.Size();
+         }
+
+         Overflow.push_back(std::move(Pair));
+      }
+   }
+   else
+   {
+      // Once the main loop has finished nothing will make room
+      while ((Queue.TryPush(std::move(Pair)) == false) && (Running == true))
+      {
+         ThisThread::yield();
+      }
+   }
+}
+
+/* static */ bool Vimpc::PopEvent(std::pair<int32_t, EventData> & Event)
 {
-   UniqueLock<Mutex> Lock(QueueMutex);
-   Queue.push_back(std::make_pair(Event, Data));
-   Condition.notify_all();
+   // Once the events that were queued ahead of the overflow have been
+   // handled it is drained first, otherwise other threads keeping the
+   // queue full would hold it back forever
+   if ((Overflow.empty() == false) && (OverflowBehind == 0))
+   {
+      Event = std::move(Overflow.front());
+      Overflow.pop_front();
+   }
+   else if (Queue.TryPop(Event) == true)
+   {
+      OverflowBehind -= (OverflowBehind > 0) ? 1 : 0;
+   }
+   else if (Overflow.empty() == false)
+   {
+      Event = std::move(Overflow.front());
+      Overflow.pop_front();
+      OverflowBehind = 0;
+   }
+   else
+   {
+      return false;
+   }
+
+   if (Event.first == Event::Input)
+   {
+      __atomic_sub_fetch(&PendingInput, 1, __ATOMIC_RELAXED);
+   }
+
+   return true;
 }
 
 /* static */ void Vimpc::EventHandler(int Event, FUNCTION<void(EventData const &)> func)
 {
+   REQUIRE((Event >= 0) && (Event < Event::EventCount));
+
    Handler[Event].push_back(func);
 }
 
@@ -370,14 +485,21 @@ void Vimpc::HandleUserEvents(bool Enabled)
    ConditionVariable * WaitCondition = new ConditionVariable();
 
    WaitConditions[Event].push_back(WaitCondition);
+   __atomic_add_fetch(&Waiting, 1, __ATOMIC_RELEASE);
 
    bool const Result = (ConditionWait(*WaitCondition, EventLock, TimeoutMs));
 
+   __atomic_sub_fetch(&Waiting, 1, __ATOMIC_RELEASE);
    WaitConditions[Event].remove(WaitCondition);
    delete WaitCondition;
    return Result;
 }
 
+/* static */ bool Vimpc::InputPending()
+{
+   return (__atomic_load_n(&PendingInput, __ATOMIC_RELAXED) != 0);
+}
+
 int Vimpc::Input() const
 {
    if (currentMode_ == Normal)
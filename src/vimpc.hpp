@@ -76,10 +76,18 @@ namespace Main
 
    public:
       static void SetRunning(bool isRunning);
-      static void CreateEvent(int Event, EventData const & Data);
+      static void CreateEvent(int Event);
+      static void CreateEvent(int Event, EventData && Data);
       static void EventHandler(int Event, FUNCTION<void(EventData const &)> func);
       static bool WaitForEvent(int Event, int TimeoutMs);
 
+      //! True if there is keyboard input waiting to be handled
+      static bool InputPending();
+
+   private:
+      //! Only the main loop may take events from the queue
+      static bool PopEvent(std::pair<int32_t, EventData> & Event);
+
    private:
       //! Read input from the screen
       int  Input() const;
@@ -15,16 +15,31 @@
    You should have received a copy of the GNU General Public License
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
-   debug.hpp - console used to display a debug print
+   debug.hpp - debug prints and logging
    */
 
 #ifndef __UI__DEBUG
 #define __UI__DEBUG
 
-#include <string>
+#include "log.hpp"
 
-//! Display an error window with the given error
-void Debug(std::string format, ...);
+//! Writes a message at the given level, the arguments are only evaluated
+//! if messages at that level are being kept
+#define LogAt(level, ...) \
+   do { if (Main::Log::Enabled(level) == true) { Main::Log::Instance().Write(level, __VA_ARGS__); } } while (false)
+
+#define LogError(...)   LogAt(LogLevel::Error,   __VA_ARGS__)
+#define LogWarning(...) LogAt(LogLevel::Warning, __VA_ARGS__)
+#define LogInfo(...)    LogAt(LogLevel::Info,    __VA_ARGS__)
+
+//! Debug prints are only built with --enable-debug, otherwise they are still
+//! compiled so that they stay correct but are never run
+#ifdef __DEBUG_PRINTS
+#define Debug(...)      LogAt(LogLevel::Debug,   __VA_ARGS__)
+#else
+#define Debug(...) \
+   do { if (false) { Main::Log::Instance().Write(LogLevel::Debug, __VA_ARGS__); } } while (false)
+#endif
 
 #endif
 /* vim: set sw=3 ts=3: */
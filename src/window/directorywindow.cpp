@@ -45,7 +45,7 @@ DirectoryWindow::DirectoryWindow(Main::Settings const & settings, Ui::Screen & s
    clientState_       (clientState),
    search_            (search),
    directory_         (directory),
-   selectedDirectory_ (0)
+   positions_         ()
 {
    SoftRedrawOnSetting(Setting::ShowPath);
    SoftRedrawOnSetting(Setting::ShowLists);
@@ -200,9 +200,20 @@ std::string DirectoryWindow::SearchPattern(uint32_t id) const
 
 void DirectoryWindow::Clear()
 {
+   positions_.clear();
    directory_.Clear(true);
 }
 
+void DirectoryWindow::ChangeDirectory(Mpc::DirectoryEntry & entry)
+{
+   positions_[directory_.CurrentDirectory()] = CurrentLine();
+
+   directory_.ChangeDirectory(entry);
+
+   auto const it = positions_.find(directory_.CurrentDirectory());
+   ScrollTo((it != positions_.end()) ? it->second : 0);
+}
+
 void DirectoryWindow::Print(uint32_t line) const
 {
    std::string const BlankLine(Columns(), ' ');
@@ -288,16 +299,7 @@ void DirectoryWindow::Left(Ui::Player & player, uint32_t count)
    {
       if (directory_.Get(0)->name_ == "..")
       {
-         directory_.ChangeDirectory(*directory_.Get(0));
-
-         if (directory_.Get(0)->name_ != "..")
-         {
-            ScrollTo(selectedDirectory_);
-         }
-         else
-         {
-            ScrollTo(0);
-         }
+         ChangeDirectory(*directory_.Get(0));
       }
    }
 }
@@ -306,13 +308,7 @@ void DirectoryWindow::Right(Ui::Player & player, uint32_t count)
 {
    if (CurrentLine() < directory_.Size())
    {
-      if (directory_.Get(0)->name_ != "..")
-      {
-         selectedDirectory_ = CurrentLine();
-      }
-
-      directory_.ChangeDirectory(*directory_.Get(CurrentLine()));
-      ScrollTo(0);
+      ChangeDirectory(*directory_.Get(CurrentLine()));
    }
 }
 
@@ -326,8 +322,7 @@ void DirectoryWindow::Confirm()
    {
       if (directory_.Get(CurrentLine())->type_ == Mpc::PathType)
       {
-         directory_.ChangeDirectory(*directory_.Get(CurrentLine()));
-         ScrollTo(0);
+         ChangeDirectory(*directory_.Get(CurrentLine()));
       }
       else
       {
@@ -371,14 +366,7 @@ void DirectoryWindow::AddLine(uint32_t line, uint32_t count, bool scroll)
          ScrollTo(line);
       }
 
-      if (settings_.Get(Setting::AddPosition) == Setting::AddEnd)
-      {
-         ForPositions(Positions.begin(), Positions.end(), &Mpc::Directory::AddToPlaylist);
-      }
-      else
-      {
-         ForPositions(Positions.rbegin(), Positions.rend(), &Mpc::Directory::AddToPlaylist);
-      }
+      directory_.AddToPlaylist(Positions, client_, clientState_);
    }
 
    SelectWindow::AddLine(line, count, scroll);
@@ -432,7 +420,7 @@ void DirectoryWindow::DeleteLine(uint32_t line, uint32_t count, bool scroll)
          ScrollTo(line);
       }
 
-      ForPositions(Positions.begin(), Positions.end(), &Mpc::Directory::RemoveFromPlaylist);
+      directory_.RemoveFromPlaylist(Positions, client_);
    }
 
    SelectWindow::DeleteLine(line, count, scroll);
@@ -527,17 +515,6 @@ std::vector<uint32_t> DirectoryWindow::PositionVector(uint32_t & line, uint32_t
 }
 
 
-
-template <typename T>
-void DirectoryWindow::ForPositions(T start, T end, DirectoryFunction function)
-{
-   for (T it = start; it != end; ++it)
-   {
-      (directory_.*function)(Mpc::Song::Single, client_, clientState_, *it);
-   }
-}
-
-
 uint32_t DirectoryWindow::BufferSize() const
 {
    uint32_t size = directory_.Size();
@@ -562,9 +539,9 @@ int32_t DirectoryWindow::DetermineSongColour(Mpc::DirectoryEntry const * const e
    else if ((search_.LastSearchString() != "") && (settings_.Get(Setting::HighlightSearch) == true) &&
             (search_.HighlightSearch() == true))
    {
-      Regex::RE expression(".*" + search_.LastSearchString() + ".*", search_.LastSearchOptions());
+      Regex::RE expression(search_.LastSearchString(), search_.LastSearchOptions());
 
-      if (expression.CompleteMatch(entry->name_) == true)
+      if (expression.Matches(entry->name_) == true)
       {
          colour = settings_.colours.SongMatch;
       }
@@ -584,7 +561,7 @@ int32_t DirectoryWindow::DetermineSongColour(Mpc::DirectoryEntry const * const e
          {
             colour = settings_.colours.PartialAdd;
 
-            if (TotalReferences == directory_.AllChildSongs(entry->path_).size())
+            if (TotalReferences == directory_.TotalSongs(entry->path_))
             {
                colour = settings_.colours.FullAdd;
             }
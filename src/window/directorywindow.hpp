@@ -36,9 +36,6 @@ namespace Ui
 
    class DirectoryWindow : public Ui::SelectWindow
    {
-   private:
-      typedef void (Mpc::Directory::*DirectoryFunction)(Mpc::Song::SongCollection Collection, Mpc::Client & client, Mpc::ClientState & clientState, uint32_t position);
-
    public:
       DirectoryWindow(Main::Settings const & settings, Ui::Screen & screen, Mpc::Directory & directory, Mpc::Client & client, Mpc::ClientState & clientState, Ui::Search const & search);
       ~DirectoryWindow();
@@ -86,11 +83,9 @@ namespace Ui
    private:
       std::vector<uint32_t> PositionVector(uint32_t & line, uint32_t count, bool visual);
 
-      template <typename T>
-      void ForPositions(T start, T end, DirectoryFunction function);
-
    private:
       void    Clear();
+      void    ChangeDirectory(Mpc::DirectoryEntry & entry);
       int32_t DetermineSongColour(Mpc::DirectoryEntry const * const entry) const;
 
    private:
@@ -99,7 +94,9 @@ namespace Ui
       Mpc::ClientState &     clientState_;
       Ui::Search     const & search_;
       Mpc::Directory &       directory_;
-      uint32_t               selectedDirectory_;
+
+      // The line that was selected when each directory was last left
+      std::map<std::string, uint32_t> positions_;
    };
 }
 #endif
@@ -48,7 +48,7 @@ void ErrorString(uint32_t errorNumber)
    if ((errorNumber != 0) && (errorNumber < (static_cast<uint32_t>(ErrorNumber::ErrorCount))))
    {
       Error(errorNumber, ErrorStrings::Default[errorNumber]);
-      Debug("ERROR E%d: %s", errorNumber, ErrorStrings::Default[errorNumber].c_str());
+      LogError("E%d: %s", errorNumber, ErrorStrings::Default[errorNumber]);
    }
 }
 
@@ -57,7 +57,7 @@ void ErrorString(uint32_t errorNumber, std::string additional)
    if ((errorNumber != 0) && (errorNumber < (static_cast<uint32_t>(ErrorNumber::ErrorCount))))
    {
       Error(errorNumber, ErrorStrings::Default[errorNumber] + ": " + additional);
-      Debug("ERROR E%d: %s", errorNumber, std::string(ErrorStrings::Default[errorNumber] + ": " + additional).c_str());
+      LogError("E%d: %s: %s", errorNumber, ErrorStrings::Default[errorNumber], additional);
    }
 }
 
@@ -0,0 +1,131 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   filterwindow.cpp - shows the songs of another window that match a pattern
+   */
+
+#include "filterwindow.hpp"
+
+#include "buffers.hpp"
+#include "mpdclient.hpp"
+
+#include "buffer/playlist.hpp"
+
+using namespace Ui;
+
+FilterWindow::FilterWindow(Ui::SongWindow & source, Main::Settings const & settings, Ui::Screen & screen, Mpc::Client & client, Mpc::ClientState & clientState, Ui::Search const & search) :
+   SongWindow       (settings, screen, client, clientState, search, source.Name()),
+   client_          (client),
+   sourceName_      (source.Name()),
+   filter_          (source.Buffer())
+{
+}
+
+FilterWindow::~FilterWindow()
+{
+}
+
+void FilterWindow::SetPattern(std::string const & pattern, Regex::Options options)
+{
+   filter_.Validate();
+   filter_.SetPattern(pattern, options);
+
+   SetName(sourceName_ + "/" + pattern);
+   ScrollTo(0);
+}
+
+void FilterWindow::Redraw()
+{
+   filter_.Validate();
+}
+
+void FilterWindow::Confirm()
+{
+   // Filtering the playlist should behave like the playlist
+   if (IsPlaylist() == true)
+   {
+      if (CurrentLine() < BufferSize())
+      {
+         client_.Play(filter_.Row(CurrentLine()));
+      }
+
+      SelectWindow::Confirm();
+   }
+   else
+   {
+      SongWindow::Confirm();
+   }
+}
+
+void FilterWindow::AddLine(uint32_t line, uint32_t count, bool scroll)
+{
+   if (IsPlaylist() == false)
+   {
+      SongWindow::AddLine(line, count, scroll);
+   }
+}
+
+void FilterWindow::AddAllLines()
+{
+   if (IsPlaylist() == false)
+   {
+      SongWindow::AddAllLines();
+   }
+}
+
+void FilterWindow::DeleteLine(uint32_t line, uint32_t count, bool scroll)
+{
+   if (IsPlaylist() == false)
+   {
+      SongWindow::DeleteLine(line, count, scroll);
+      return;
+   }
+
+   int64_t pos1 = CurrentSelection().first;
+   int64_t pos2 = CurrentSelection().second;
+
+   if (pos2 < pos1)
+   {
+      pos2 = pos1;
+      pos1 = CurrentSelection().second;
+   }
+
+   if (pos1 != pos2)
+   {
+      count  = pos2 - pos1 + 1;
+      line   = pos1;
+      scroll = false;
+   }
+
+   // Only the rows that are shown, not other copies of the same songs
+   std::vector<uint32_t> Positions;
+
+   for (uint32_t i = line; ((i < line + count) && (i < BufferSize())); ++i)
+   {
+      Positions.push_back(filter_.Row(i));
+   }
+
+   client_.Delete(Positions);
+   SelectWindow::DeleteLine(line, count, scroll);
+}
+
+bool FilterWindow::IsPlaylist() const
+{
+   return (filter_.Source() == &Main::Playlist());
+}
+
+/* vim: set sw=3 ts=3: */
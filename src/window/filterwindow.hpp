@@ -0,0 +1,69 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   filterwindow.hpp - shows the songs of another window that match a pattern
+   */
+
+#ifndef __UI__FILTERWINDOW
+#define __UI__FILTERWINDOW
+
+// Includes
+#include "buffer/filter.hpp"
+#include "window/songwindow.hpp"
+
+// Filter window class
+namespace Ui
+{
+   class FilterWindow : public Ui::SongWindow
+   {
+   public:
+      FilterWindow(Ui::SongWindow & source, Main::Settings const & settings, Ui::Screen & screen, Mpc::Client & client, Mpc::ClientState & clientState, Ui::Search const & search);
+      ~FilterWindow();
+
+   private:
+      FilterWindow(FilterWindow & filter);
+      FilterWindow & operator=(FilterWindow & filter);
+
+   public:
+      void SetPattern(std::string const & pattern, Regex::Options options);
+      void Redraw();
+      void Confirm();
+
+   public:
+      void AddLine(uint32_t line, uint32_t count = 1, bool scroll = true);
+      void AddAllLines();
+      void DeleteLine(uint32_t line, uint32_t count = 1, bool scroll = true);
+
+   public:
+      Mpc::Song * GetSong(uint32_t line) const { return filter_.Get(line); }
+      int32_t SongIndex(Mpc::Song * song) const { return filter_.Index(song); }
+
+   protected:
+      Main::WindowBuffer const & WindowBuffer() const { return filter_; }
+
+   private:
+      bool IsPlaylist() const;
+
+   private:
+      Mpc::Client          & client_;
+      std::string            sourceName_;
+      Mpc::Filter            filter_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
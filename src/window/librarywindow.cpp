@@ -42,7 +42,8 @@ LibraryWindow::LibraryWindow(Main::Settings const & settings, Ui::Screen & scree
    client_          (client),
    clientState_     (clientState),
    search_          (search),
-   library_         (library)
+   library_         (library),
+   matches_         ()
 {
    SoftRedrawOnSetting(Setting::IgnoreCaseSort);
    SoftRedrawOnSetting(Setting::IgnoreTheSort);
@@ -271,16 +272,7 @@ void LibraryWindow::AddLine(uint32_t line, uint32_t count, bool scroll)
          ScrollTo(line);
       }
 
-      if (settings_.Get(Setting::AddPosition) == Setting::AddEnd)
-      {
-         Mpc::CommandList list(client_, true);
-         ForPositions(Positions.begin(), Positions.end(), &Mpc::Library::AddToPlaylist);
-      }
-      else
-      {
-         Mpc::CommandList list(client_, true);
-         ForPositions(Positions.rbegin(), Positions.rend(), &Mpc::Library::AddToPlaylist);
-      }
+      library_.AddToPlaylist(Positions, client_, clientState_);
    }
 
    SelectWindow::AddLine(line, count, scroll);
@@ -334,8 +326,7 @@ void LibraryWindow::DeleteLine(uint32_t line, uint32_t count, bool scroll)
          ScrollTo(line);
       }
 
-      Mpc::CommandList list(client_, true);
-      ForPositions(Positions.begin(), Positions.end(), &Mpc::Library::RemoveFromPlaylist);
+      library_.RemoveFromPlaylist(Positions, client_);
    }
 
    SelectWindow::DeleteLine(line, count, scroll);
@@ -453,15 +444,6 @@ std::vector<uint32_t> LibraryWindow::PositionVector(uint32_t & line, uint32_t co
    return Positions;
 }
 
-template <typename T>
-void LibraryWindow::ForPositions(T start, T end, LibraryFunction function)
-{
-   for (T it = start; it != end; ++it)
-   {
-      (library_.*function)(Mpc::Song::Single, client_, clientState_, *it);
-   }
-}
-
 
 int32_t LibraryWindow::DetermineColour(uint32_t line) const
 {
@@ -478,11 +460,16 @@ int32_t LibraryWindow::DetermineColour(uint32_t line) const
       else if ((search_.LastSearchString() != "") && (settings_.Get(Setting::HighlightSearch) == true) &&
                (search_.HighlightSearch() == true))
       {
-         Regex::RE expression(".*" + search_.LastSearchString() + ".*", search_.LastSearchOptions());
+         std::string const format(settings_.Get(Setting::LibraryFormat));
+
+         matches_.Validate(search_.LastSearchString(), search_.LastSearchOptions(), format, library_.Generation(), library_.Size());
 
-         if (((entry->type_ == Mpc::ArtistType) && (expression.CompleteMatch(entry->artist_) == true)) ||
-             ((entry->type_ == Mpc::AlbumType)  && (expression.CompleteMatch(entry->album_) == true)) ||
-             ((entry->type_ == Mpc::SongType)   && (expression.CompleteMatch(entry->song_->FormatString(settings_.Get(Setting::LibraryFormat))) == true)))
+         if (matches_.Matches(line + FirstLine(), [entry, &format] ()
+               {
+                  return (entry->type_ == Mpc::ArtistType) ? entry->artist_ :
+                         (entry->type_ == Mpc::AlbumType)  ? entry->album_ :
+                         (entry->type_ == Mpc::SongType)   ? entry->song_->FormatString(format) : std::string("");
+               }) == true)
          {
             colour = settings_.colours.SongMatch;
          }
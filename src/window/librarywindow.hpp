@@ -23,6 +23,7 @@
 
 #include "song.hpp"
 #include "buffer/library.hpp"
+#include "window/matchcache.hpp"
 #include "window/selectwindow.hpp"
 
 #include <map>
@@ -36,9 +37,6 @@ namespace Ui
 
    class LibraryWindow : public Ui::SelectWindow
    {
-   private:
-      typedef void (Mpc::Library::*LibraryFunction)(Mpc::Song::SongCollection Collection, Mpc::Client & client, Mpc::ClientState & clientState, uint32_t position);
-
    public:
       LibraryWindow(Main::Settings const & settings, Ui::Screen & screen, Mpc::Library & library, Mpc::Client & client, Mpc::ClientState & clientState, Ui::Search const & search);
       ~LibraryWindow();
@@ -81,9 +79,6 @@ namespace Ui
    private:
       std::vector<uint32_t> PositionVector(uint32_t & line, uint32_t count, bool visual);
 
-      template <typename T>
-      void ForPositions(T start, T end, LibraryFunction function);
-
    private:
       void      SoftRedraw();
       void      Clear();
@@ -96,6 +91,7 @@ namespace Ui
       Mpc::ClientState     & clientState_;
       Ui::Search     const & search_;
       Mpc::Library         & library_;
+      mutable Ui::MatchCache matches_;
    };
 }
 #endif
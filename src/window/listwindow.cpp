@@ -157,9 +157,9 @@ int32_t ListWindow::DetermineColour(uint32_t line) const
       if ((search_.LastSearchString() != "") && (settings_.Get(Setting::HighlightSearch) == true) &&
           (search_.HighlightSearch() == true))
       {
-         Regex::RE expression (".*" + search_.LastSearchString() + ".*", search_.LastSearchOptions());
+         Regex::RE expression (search_.LastSearchString(), search_.LastSearchOptions());
 
-         if (expression.CompleteMatch(lists_->Get(line).name_) == true)
+         if (expression.Matches(lists_->Get(line).name_) == true)
          {
             colour = settings_.colours.SongMatch;
          }
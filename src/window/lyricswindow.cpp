@@ -33,19 +33,21 @@
 using namespace Ui;
 using namespace Main;
 
+static int32_t const LyricsHeader = 2;
+
 LyricsWindow::LyricsWindow(std::string const & URI, Main::Settings const & settings, Ui::Screen & screen, Mpc::Client & client, Mpc::ClientState & clientState, Ui::Search const & search, std::string name) :
    SelectWindow     (settings, screen, name),
    m_URI            (URI),
    settings_        (settings),
    search_          (search),
-   lyrics_          ()
+   lyrics_          (),
+   activeLine_      (-1)
 {
    Vimpc::EventHandler(Event::LyricsLoaded, [this] (EventData const & Data) { Redraw(); });
 
-   Vimpc::EventHandler(Event::LyricsPercent, [this] (EventData const & Data) 
-   { 
-       uint32_t end = lyrics_.Size();
-       this->ScrollTo((end*(Data.value+10))/100); 
+   Vimpc::EventHandler(Event::LyricsLine, [this] (EventData const & Data)
+   {
+      SetActiveLine(Data.value);
    });
 
    LoadLyrics();
@@ -64,7 +66,10 @@ void LyricsWindow::Print(uint32_t line) const
    mvwprintw(window, line, 0, BlankLine.c_str());
    wmove(window, line, 0);
 
-   if ((FirstLine() == 0) && (line == 0))
+   bool const active = (activeLine_ >= 0) && (FirstLine() + line == static_cast<uint32_t>(activeLine_)) &&
+                       (Main::LyricsLoader::Instance().Synced() == true);
+
+   if (((FirstLine() == 0) && (line == 0)) || (active == true))
    {
       wattron(window, A_BOLD);
    }
@@ -76,9 +81,9 @@ void LyricsWindow::Print(uint32_t line) const
       if ((search_.LastSearchString() != "") && (settings_.Get(Setting::HighlightSearch) == true) &&
           (search_.HighlightSearch() == true))
       {
-         Regex::RE const expression(".*" + search_.LastSearchString() + ".*", search_.LastSearchOptions());
+         Regex::RE const expression(search_.LastSearchString(), search_.LastSearchOptions());
 
-         if (expression.CompleteMatch(currentLine))
+         if (expression.Matches(currentLine))
          {
             wattron(window, COLOR_PAIR(settings_.colours.SongMatch));
          }
@@ -89,16 +94,16 @@ void LyricsWindow::Print(uint32_t line) const
       if ((search_.LastSearchString() != "") && (settings_.Get(Setting::HighlightSearch) == true) &&
           (search_.HighlightSearch() == true))
       {
-         Regex::RE const expression(".*" + search_.LastSearchString() + ".*", search_.LastSearchOptions());
+         Regex::RE const expression(search_.LastSearchString(), search_.LastSearchOptions());
 
-         if (expression.CompleteMatch(currentLine))
+         if (expression.Matches(currentLine))
          {
             wattroff(window, COLOR_PAIR(settings_.colours.SongMatch));
          }
       }
    }
 
-   if ((FirstLine() == 0) && (line == 0))
+   if (((FirstLine() == 0) && (line == 0)) || (active == true))
    {
       wattroff(window, A_BOLD);
    }
@@ -148,6 +153,18 @@ void LyricsWindow::Redraw()
 {
    ScrollTo(0);
    LyricsLoaded();
+   SetActiveLine(Main::LyricsLoader::Instance().CurrentLine());
+}
+
+void LyricsWindow::SetActiveLine(int32_t line)
+{
+   // The artist and title are shown above the lyrics
+   activeLine_ = (line >= 0) ? line + LyricsHeader : -1;
+
+   if (activeLine_ >= 0)
+   {
+      ScrollTo(activeLine_);
+   }
 }
 
 void LyricsWindow::Clear()
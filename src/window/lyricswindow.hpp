@@ -59,12 +59,14 @@ namespace Ui
       void Clear();
       void LoadLyrics();
       void LyricsLoaded();
+      void SetActiveLine(int32_t line);
 
    private:
       std::string 			  m_URI;
       Main::Settings const & settings_;
       Ui::Search     const & search_;
       Main::Lyrics 	        lyrics_;
+      int32_t                activeLine_;
    };
 }
 
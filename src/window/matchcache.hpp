@@ -0,0 +1,119 @@
+/*
+   Vimpc
+   Copyright (C) 2013 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   matchcache.hpp - remembers which lines of a window match the last search
+   */
+
+#ifndef __UI__MATCHCACHE
+#define __UI__MATCHCACHE
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "compiler.hpp"
+#include "regex.hpp"
+#include "song.hpp"
+
+namespace Ui
+{
+   //! Caches the result of matching each line of a buffer against the last
+   //! search, so that highlighting does not run the expression on every repaint
+   class MatchCache
+   {
+   private:
+      typedef enum
+      {
+         Unknown = 0,
+         NoMatch,
+         Match
+      } LineState;
+
+   public:
+      MatchCache() :
+         pattern_   (""),
+         format_    (""),
+         options_   (Regex::None),
+         generation_(0),
+         revision_  (0),
+         expression_(NULL)
+      { }
+
+      ~MatchCache()
+      {
+         delete expression_;
+      }
+
+   private:
+      MatchCache(MatchCache const &);
+      MatchCache & operator=(MatchCache const &);
+
+   public:
+      //! Discards all results if any part of the key has changed since the last call,
+      //! retagging any song counts as a change as the lines are formatted from tags
+      void Validate(std::string const & pattern, Regex::Options options, std::string const & format, uint32_t generation, uint32_t size)
+      {
+         uint32_t const revision = Mpc::Song::Revision();
+
+         if ((expression_ == NULL) || (options != options_) || (pattern != pattern_))
+         {
+            delete expression_;
+            expression_ = new Regex::RE(pattern, options);
+            pattern_    = pattern;
+            options_    = options;
+            lines_.clear();
+         }
+
+         if ((generation != generation_) || (revision != revision_) ||
+             (format != format_) || (size != lines_.size()))
+         {
+            format_     = format;
+            generation_ = generation;
+            revision_   = revision;
+            lines_.assign(size, Unknown);
+         }
+      }
+
+      //! Describe is only called the first time a line is checked after validation
+      bool Matches(uint32_t line, FUNCTION<std::string ()> const & describe)
+      {
+         if (line >= lines_.size())
+         {
+            return false;
+         }
+
+         if (lines_[line] == Unknown)
+         {
+            lines_[line] = (expression_->Matches(describe()) == true) ? Match : NoMatch;
+         }
+
+         return (lines_[line] == Match);
+      }
+
+   private:
+      std::string          pattern_;
+      std::string          format_;
+      Regex::Options       options_;
+      uint32_t             generation_;
+      uint32_t             revision_;
+      Regex::RE *          expression_;
+      std::vector<uint8_t> lines_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */
@@ -90,9 +90,9 @@ int32_t OutputWindow::DetermineColour(uint32_t line) const
       if ((search_.LastSearchString() != "") && (settings_.Get(Setting::HighlightSearch) == true) &&
           (search_.HighlightSearch() == true))
       {
-         Regex::RE expression (".*" + search_.LastSearchString() + ".*", search_.LastSearchOptions());
+         Regex::RE expression (search_.LastSearchString(), search_.LastSearchOptions());
 
-         if (expression.CompleteMatch(outputs_.Get(line)->Name()) == true)
+         if (expression.Matches(outputs_.Get(line)->Name()) == true)
          {
             colour = settings_.colours.SongMatch;
          }
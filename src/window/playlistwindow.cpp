@@ -94,15 +94,9 @@ int32_t PlaylistWindow::DetermineColour(uint32_t line) const
          {
             colour = settings_.colours.CurrentSong;
          }
-         else if ((search_.LastSearchString() != "") && (settings_.Get(Setting::HighlightSearch) == true) &&
-                  (search_.HighlightSearch() == true))
+         else if (IsSearchMatch(line + FirstLine()) == true)
          {
-            Regex::RE expression (".*" + search_.LastSearchString() + ".*", search_.LastSearchOptions());
-
-            if (expression.CompleteMatch(song->FormatString(settings_.Get(Setting::SongFormat))))
-            {
-               colour = settings_.colours.SongMatch;
-            }
+            colour = settings_.colours.SongMatch;
          }
       }
    }
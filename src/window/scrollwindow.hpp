@@ -89,6 +89,7 @@ namespace Ui
 
    public:
       virtual uint32_t BufferSize() const { return WindowBuffer().Size(); }
+      uint32_t BufferGeneration() const   { return WindowBuffer().Generation(); }
 
    public:
       std::string const & Name() const;
@@ -43,7 +43,8 @@ SongWindow::SongWindow(Main::Settings const & settings, Ui::Screen & screen, Mpc
    client_          (client),
    clientState_     (clientState),
    search_          (search),
-   browse_          ()
+   browse_          (),
+   matches_         ()
 {
 }
 
@@ -61,25 +62,25 @@ void SongWindow::Add(Mpc::Song * song)
 
 void SongWindow::AddToPlaylist(uint32_t position)
 {
-   if ((position < BufferSize()) && (Buffer().Get(position) != NULL))
+   if ((position < BufferSize()) && (GetSong(position) != NULL))
    {
       if ((settings_.Get(Setting::AddPosition) == Setting::AddEnd) ||
           (clientState_.GetCurrentSongPos() == -1))
       {
-         client_.Add(*(Buffer().Get(position)));
+         client_.Add(*(GetSong(position)));
       }
       else
       {
-         client_.Add(*(Buffer().Get(position)), clientState_.GetCurrentSongPos() + 1);
+         client_.Add(*(GetSong(position)), clientState_.GetCurrentSongPos() + 1);
       }
    }
 }
 
 std::string SongWindow::SearchPattern(uint32_t id) const
 {
-   if (id < Buffer().Size())
+   if (id < BufferSize())
    {
-      return Buffer().Get(id)->FormatString(settings_.Get(Setting::SongFormat));
+      return GetSong(id)->FormatString(settings_.Get(Setting::SongFormat));
    }
    return "";
 }
@@ -90,7 +91,7 @@ void SongWindow::Print(uint32_t line) const
 #if 0
    uint32_t printLine = line + FirstLine();
    WINDOW * window    = N_WINDOW();
-   Mpc::Song * song   = (printLine < BufferSize()) ? Buffer().Get(printLine) : NULL;
+   Mpc::Song * song   = (printLine < BufferSize()) ? GetSong(printLine) : NULL;
    int32_t  colour    = DetermineColour(printLine, song);
 
    // Reverse the colours to indicate the selected song
@@ -150,7 +151,7 @@ void SongWindow::Right(Ui::Player & player, uint32_t count)
 
 void SongWindow::Confirm()
 {
-   if (Buffer().Size() > CurrentLine())
+   if (BufferSize() > CurrentLine())
    {
       int64_t pos1, pos2;
       uint32_t count = GetPositions(pos1, pos2);
@@ -185,7 +186,7 @@ uint32_t SongWindow::Current() const
 
    if ((currentSongId >= 0) && (currentSongId < static_cast<int32_t>(Main::Playlist().Size())))
    {
-      current = Buffer().Index(Main::Playlist().Get(currentSongId));
+      current = SongIndex(Main::Playlist().Get(currentSongId));
    }
 
    if (current == -1)
@@ -201,13 +202,13 @@ uint32_t SongWindow::Playlist(int count) const
    //! \todo could use some tidying up
    int32_t line = CurrentLine();
 
-   if ((line >= 0) && (Buffer().Size() > 0))
+   if ((line >= 0) && (BufferSize() > 0))
    {
-      if ((count > 0) && (line >= 0) && (Buffer().Size() > 0))
+      if ((count > 0) && (line >= 0) && (BufferSize() > 0))
       {
          for (uint32_t i = CurrentLine() + 1; i < BufferSize(); ++i)
          {
-            if (Buffer().Get(i)->Reference() > 0)
+            if (GetSong(i)->Reference() > 0)
             {
                --count;
                line = i;
@@ -223,7 +224,7 @@ uint32_t SongWindow::Playlist(int count) const
       {
          for (int32_t i = CurrentLine() - 1; i >= 0; --i)
          {
-            if (Buffer().Get(i)->Reference() > 0)
+            if (GetSong(i)->Reference() > 0)
             {
                ++count;
                line = i;
@@ -254,34 +255,28 @@ void SongWindow::AddLine(uint32_t line, uint32_t count, bool scroll)
       }
 
       {
+         std::vector<Mpc::Song *> songs;
 
-         if (settings_.Get(Setting::AddPosition) == Setting::AddEnd)
+         for (uint32_t i = 0; i < count; ++i)
          {
-            std::vector<Mpc::Song *> songs;
+            uint32_t const position = line + i;
 
-            for (uint32_t i = 0; i < count; ++i)
+            if ((position < BufferSize()) && (GetSong(position) != NULL))
             {
-               //AddToPlaylist(line + i);
-               uint32_t const position = line + i;
-
-               if ((position < BufferSize()) && (Buffer().Get(position) != NULL))
-               {
-                  songs.push_back(Buffer().Get(position));
-               }
+               songs.push_back(GetSong(position));
             }
-
-            Debug("Queueing up a client add of %d songs", songs.size());
-            client_.Add(songs);
          }
-         else
-         {
-            Mpc::CommandList list(client_, (count > 1));
 
-            for (int32_t i = count - 1; i >= 0; --i)
-            {
-               AddToPlaylist(line + i);
-            }
+         int32_t position = -1;
+
+         if ((settings_.Get(Setting::AddPosition) == Setting::AddNext) &&
+             (clientState_.GetCurrentSongPos() != -1))
+         {
+            position = clientState_.GetCurrentSongPos() + 1;
          }
+
+         Debug("Queueing up a client add of %d songs", songs.size());
+         client_.Add(songs, position);
       }
 
       if ((scroll == true) && (posCount == 1))
@@ -330,23 +325,14 @@ void SongWindow::DeleteLine(uint32_t line, uint32_t count, bool scroll)
       }
 
       {
-         Mpc::CommandList list(client_, (count > 1));
+         std::vector<Mpc::Song *> songs;
 
-         for (uint32_t i = 0; i < count; ++i)
+         for (uint32_t i = 0; ((i < count) && (line + i < BufferSize())); ++i)
          {
-            int32_t index = line;
-
-            if (index + i < BufferSize())
-            {
-               index = Main::Playlist().Index(Buffer().Get(index + i));
-
-               if (index >= 0)
-               {
-                  Debug("Calling delete on %s", Main::Playlist().Get(index)->URI().c_str());
-                  client_.Delete(index);
-               }
-            }
+            songs.push_back(GetSong(line + i));
          }
+
+         client_.Delete(Main::Playlist().Positions(songs));
       }
 
       if ((scroll == true) && (posCount == 1))
@@ -367,7 +353,7 @@ void SongWindow::Edit()
 {
    if (CurrentLine() < BufferSize())
    {
-      Mpc::Song * song(Buffer().Get(CurrentLine()));
+      Mpc::Song * song(GetSong(CurrentLine()));
       screen_.CreateSongInfoWindow(song);
    }
 }
@@ -377,7 +363,7 @@ void SongWindow::Lyrics()
 {
    if (CurrentLine() < BufferSize())
    {
-      Mpc::Song * song(Buffer().Get(CurrentLine()));
+      Mpc::Song * song(GetSong(CurrentLine()));
       screen_.CreateSongLyricsWindow(song);
    }
 }
@@ -387,7 +373,7 @@ void SongWindow::ScrollToFirstMatch(std::string const & input)
 {
    for (uint32_t i = 0; i < BufferSize(); ++i)
    {
-      Mpc::Song * song = Buffer().Get(i);
+      Mpc::Song * song = GetSong(i);
       std::string line = song->FormatString(settings_.Get(Setting::SongFormat));
 
       if (Algorithm::imatch(line, input, settings_.Get(Setting::IgnoreTheSort), settings_.Get(Setting::IgnoreCaseSort)) == true)
@@ -410,7 +396,7 @@ void SongWindow::Save(std::string const & name)
 
          for (unsigned int i = 0; i < BufferSize(); ++i)
          {
-            client_.AddToNamedPlaylist(name, Buffer().Get(i));
+            client_.AddToNamedPlaylist(name, GetSong(i));
          }
       }
    }
@@ -452,7 +438,7 @@ void SongWindow::PrintId(uint32_t Id) const
 int32_t SongWindow::DetermineColour(uint32_t line) const
 {
    uint32_t printLine = line + FirstLine();
-   Mpc::Song * song   = (printLine < BufferSize()) ? Buffer().Get(printLine) : NULL;
+   Mpc::Song * song   = (printLine < BufferSize()) ? GetSong(printLine) : NULL;
 
    int32_t colour = settings_.colours.Song;
 
@@ -466,21 +452,29 @@ int32_t SongWindow::DetermineColour(uint32_t line) const
       {
          colour = settings_.colours.FullAdd;
       }
-      else if ((search_.LastSearchString() != "") && (settings_.Get(Setting::HighlightSearch) == true) &&
-               (search_.HighlightSearch() == true))
+      else if (IsSearchMatch(printLine) == true)
       {
-         Regex::RE const expression(".*" + search_.LastSearchString() + ".*", search_.LastSearchOptions());
-
-         if (expression.CompleteMatch(song->FormatString(settings_.Get(Setting::SongFormat))))
-         {
-            colour = settings_.colours.SongMatch;
-         }
+         colour = settings_.colours.SongMatch;
       }
    }
 
    return colour;
 }
 
+bool SongWindow::IsSearchMatch(uint32_t line) const
+{
+   if ((search_.LastSearchString() != "") && (settings_.Get(Setting::HighlightSearch) == true) &&
+       (search_.HighlightSearch() == true))
+   {
+      std::string const format(settings_.Get(Setting::SongFormat));
+
+      matches_.Validate(search_.LastSearchString(), search_.LastSearchOptions(), format, BufferGeneration(), BufferSize());
+      return matches_.Matches(line, [this, line, &format] () { return GetSong(line)->FormatString(format); });
+   }
+
+   return false;
+}
+
 uint32_t SongWindow::GetPositions(int64_t & pos1, int64_t & pos2) const
 {
    pos1 = CurrentSelection().first;
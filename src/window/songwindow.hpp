@@ -27,6 +27,7 @@
 #include "song.hpp"
 #include "buffer/browse.hpp"
 #include "buffer/library.hpp"
+#include "window/matchcache.hpp"
 #include "window/selectwindow.hpp"
 
 // Forward Declarations
@@ -82,6 +83,11 @@ namespace Ui
       virtual Main::Buffer<Mpc::Song *> & Buffer() { return browse_; }
       virtual Main::Buffer<Mpc::Song *> const & Buffer() const { return browse_; }
 
+      //! Songs are read through these so that windows which only
+      //! show part of a buffer can map lines to their songs
+      virtual Mpc::Song * GetSong(uint32_t line) const { return Buffer().Get(line); }
+      virtual int32_t SongIndex(Mpc::Song * song) const { return Buffer().Index(song); }
+
    protected:
       virtual void PrintBlankId() const;
       virtual void PrintId(uint32_t Id) const;
@@ -89,6 +95,7 @@ namespace Ui
       void Clear();
 
       int32_t DetermineColour(uint32_t line) const;
+      bool IsSearchMatch(uint32_t line) const;
 
    private:
       uint32_t GetPositions(int64_t & pos1, int64_t & pos2) const;
@@ -99,6 +106,7 @@ namespace Ui
       Mpc::ClientState     & clientState_;
       Ui::Search     const & search_;
       Mpc::Browse            browse_;
+      mutable Ui::MatchCache matches_;
    };
 }
 
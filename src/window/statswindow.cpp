@@ -1,6 +1,6 @@
 /*
    Vimpc
-   Copyright (C) 2010 Nathan Sweetman
+   Copyright (C) 2010 - 2016 Nathan Sweetman
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,33 +15,35 @@
    You should have received a copy of the GNU General Public License
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
-   debug.cpp - console used to display a debug print
+   statswindow.cpp - window to display timings and counters
    */
 
-#include "window/debug.hpp"
+#include "statswindow.hpp"
 
-#include "buffers.hpp"
-#include "compiler.hpp"
+#include "stats.hpp"
 
-#include <stdio.h>
-#include <stdarg.h>
+using namespace Ui;
 
-void Debug(std::string format, ...)
+StatsWindow::StatsWindow(Ui::Screen & screen) :
+   ScrollWindow(screen, "stats"),
+   stats_      ()
 {
-#ifdef __DEBUG_PRINTS
-
-   static Mutex DebugMutex;
-
-   DebugMutex.lock();
-   char buffer[1024];
-   va_list args;
-   va_start(args, format);
-   vsnprintf(buffer, 1023, format.c_str(), args);
-	buffer[1023] = '\0';
-   Main::DebugConsole().Add(buffer);
-   va_end(args);
-   DebugMutex.unlock();
-#endif
 }
 
+StatsWindow::~StatsWindow()
+{
+}
+
+
+void StatsWindow::Redraw()
+{
+   std::vector<std::string> const lines = Main::Stats::Instance().Lines();
+
+   stats_.Clear();
+
+   for (auto it = lines.begin(); (it != lines.end()); ++it)
+   {
+      stats_.Add(*it);
+   }
+}
 /* vim: set sw=3 ts=3: */
@@ -0,0 +1,50 @@
+/*
+   Vimpc
+   Copyright (C) 2010 - 2016 Nathan Sweetman
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   statswindow.hpp - window to display timings and counters
+   */
+
+#ifndef __UI__STATSWINDOW
+#define __UI__STATSWINDOW
+
+#include <string>
+
+#include "buffer/buffer.hpp"
+#include "window/scrollwindow.hpp"
+
+namespace Ui
+{
+   //! The stats are read again every time the window is redrawn
+   class StatsWindow : public Ui::ScrollWindow
+   {
+   public:
+      StatsWindow(Ui::Screen & screen);
+      ~StatsWindow();
+
+   public:
+      void Redraw();
+
+   protected:
+      Main::WindowBuffer const & WindowBuffer() const { return stats_; }
+
+   private:
+      Main::Buffer<std::string> stats_;
+   };
+}
+
+#endif
+/* vim: set sw=3 ts=3: */